@@ -0,0 +1,636 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "GameplayMessageBenchmark.h"
+
+#include "GameFramework/GameplayMessageSubsystem.h"
+#include "GameFramework/GameplayWorldMessageSubsystem.h"
+#include "GameplayMessageBenchmarkTypes.h"
+#include "HAL/MemoryBase.h"
+#include "HAL/PlatformTime.h"
+#include "Interfaces/IPluginManager.h"
+#include "Math/RandomStream.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/Package.h"
+
+#include <atomic>
+
+DEFINE_LOG_CATEGORY(LogGameplayMessageBenchmarks);
+
+namespace UE::GameplayMessageBenchmarks
+{
+	namespace Private
+	{
+		/**
+		 * Forwards to the real allocator and counts what goes through it. Installed as GMalloc while a measurement runs,
+		 * so counts include allocations made by other threads in the meantime; run on an idle editor or -nullrhi game.
+		 */
+		class FCountingMalloc final : public FMalloc
+		{
+		public:
+			explicit FCountingMalloc(FMalloc* InInner) : Inner(InInner) {}
+
+			FMalloc* GetInner() const { return Inner; }
+
+			void ResetCounters()
+			{
+				NumAllocations = 0;
+				NumBytes = 0;
+			}
+
+			int64 GetNumAllocations() const { return NumAllocations.load(std::memory_order_relaxed); }
+			int64 GetNumBytes() const { return NumBytes.load(std::memory_order_relaxed); }
+
+			virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+			{
+				void* Result = Inner->Malloc(Count, Alignment);
+				++NumAllocations;
+				NumBytes += GetSize(Result);
+				return Result;
+			}
+
+			virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override
+			{
+				void* Result = Inner->TryMalloc(Count, Alignment);
+				if (Result)
+				{
+					++NumAllocations;
+					NumBytes += GetSize(Result);
+				}
+				return Result;
+			}
+
+			virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+			{
+				const int64 OriginalSize = GetSize(Original);
+				void* Result = Inner->Realloc(Original, Count, Alignment);
+				if (Count > 0)
+				{
+					++NumAllocations;
+				}
+				NumBytes += GetSize(Result) - OriginalSize;
+				return Result;
+			}
+
+			virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override
+			{
+				const int64 OriginalSize = GetSize(Original);
+				void* Result = Inner->TryRealloc(Original, Count, Alignment);
+				if (Result || Count == 0)
+				{
+					if (Count > 0)
+					{
+						++NumAllocations;
+					}
+					NumBytes += GetSize(Result) - OriginalSize;
+				}
+				return Result;
+			}
+
+			virtual void Free(void* Original) override
+			{
+				NumBytes -= GetSize(Original);
+				Inner->Free(Original);
+			}
+
+			virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+			virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+			virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+			virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+			virtual void ClearAndDisableTLSCachesOnCurrentThread() override { Inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+			virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+			virtual bool ValidateHeap() override { return Inner->ValidateHeap(); }
+			virtual void UpdateStats() override { Inner->UpdateStats(); }
+			virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override { Inner->GetAllocatorStats(OutStats); }
+			virtual void DumpAllocatorStats(FOutputDevice& Ar) override { Inner->DumpAllocatorStats(Ar); }
+			virtual const TCHAR* GetDescriptiveName() override { return TEXT("GameplayMessageBenchmarkCountingMalloc"); }
+
+		private:
+			int64 GetSize(void* Original)
+			{
+				SIZE_T Size = 0;
+				return Original && Inner->GetAllocationSize(Original, Size) ? static_cast<int64>(Size) : 0;
+			}
+
+			FMalloc* Inner;
+			std::atomic<int64> NumAllocations = 0;
+			std::atomic<int64> NumBytes = 0;
+		};
+
+		/** Counts allocations made during its lifetime */
+		class FAllocationScope
+		{
+		public:
+			FAllocationScope()
+			{
+				check(IsInGameThread());
+
+				// Never destroyed, a thread may still be inside one of its functions after it has been uninstalled
+				static FCountingMalloc* CountingMalloc = new FCountingMalloc(GMalloc);
+				check(GMalloc == CountingMalloc->GetInner());
+
+				Counter = CountingMalloc;
+				Counter->ResetCounters();
+				GMalloc = Counter;
+			}
+
+			~FAllocationScope()
+			{
+				Stop();
+			}
+
+			void Stop()
+			{
+				if (GMalloc == Counter)
+				{
+					GMalloc = Counter->GetInner();
+					NumAllocations = Counter->GetNumAllocations();
+					NumBytes = Counter->GetNumBytes();
+				}
+			}
+
+			int64 GetNumAllocations() const { return NumAllocations; }
+			int64 GetNumBytes() const { return NumBytes; }
+
+		private:
+			FCountingMalloc* Counter = nullptr;
+			int64 NumAllocations = 0;
+			int64 NumBytes = 0;
+		};
+
+		/** Times its lifetime and counts the allocations made meanwhile */
+		class FMeasurement
+		{
+		public:
+			FMeasurement()
+				: StartCycles(FPlatformTime::Cycles64())
+			{
+			}
+
+			void Stop()
+			{
+				if (EndCycles == 0)
+				{
+					EndCycles = FPlatformTime::Cycles64();
+					Allocations.Stop();
+				}
+			}
+
+			double GetSeconds() const { return FPlatformTime::ToSeconds64(EndCycles - StartCycles); }
+			int64 GetNumAllocations() const { return Allocations.GetNumAllocations(); }
+
+		private:
+			// Installed first so the timer does not measure the allocator swap
+			FAllocationScope Allocations;
+			uint64 StartCycles = 0;
+			uint64 EndCycles = 0;
+		};
+
+		/** Routers are created outside of any game instance or world, nothing but the benchmark talks to them */
+		template <typename FRouterType>
+		FRouterType* CreateRouter()
+		{
+			FRouterType* Router = NewObject<FRouterType>(GetTransientPackage());
+			Router->AddToRoot();
+			return Router;
+		}
+
+		void DestroyRouter(UObject* Router)
+		{
+			Router->RemoveFromRoot();
+			Router->MarkAsGarbage();
+		}
+
+		void FinishResult(FBenchmarkResult& Result, const FMeasurement& Measurement, int64 NumCallbacks)
+		{
+			const double NumOps = FMath::Max(Result.Config.NumIterations, 1);
+			Result.NanosecondsPerOp = Measurement.GetSeconds() * 1e9 / NumOps;
+			Result.AllocationsPerOp = Measurement.GetNumAllocations() / NumOps;
+			Result.CallbacksPerOp = NumCallbacks / NumOps;
+		}
+
+		FGameplayMessageListenerHandle RegisterChannelListener(UGameplayMessageSubsystem& Router, FRandomStream& Random, const FBenchmarkConfig& Config, int64& NumCallbacks)
+		{
+			auto Callback = [&NumCallbacks](FGameplayTag Channel, const FGameplayMessageBenchmarkPayload& Payload) { ++NumCallbacks; };
+
+			if (Random.FRand() < Config.PartialMatchRatio)
+			{
+				return Router.RegisterListener<FGameplayMessageBenchmarkPayload>(TAG_Benchmark_Channel, Callback, EGameplayMessageMatch::PartialMatch);
+			}
+
+			const int32 NumUsedChannels = FMath::Clamp(Config.NumChannels, 1, NumChannels);
+			return Router.RegisterListener<FGameplayMessageBenchmarkPayload>(GetChannel(Random.RandHelper(NumUsedChannels)), Callback, EGameplayMessageMatch::ExactMatch);
+		}
+
+		// N listeners across M channels, partial matches on the channel root, broadcasts on random channels
+		FBenchmarkResult RunChannelFanout(const FBenchmarkConfig& Config)
+		{
+			FBenchmarkResult Result;
+			Result.Scenario = TEXT("ChannelFanout");
+			Result.Config = Config;
+
+			UGameplayMessageSubsystem* Router = CreateRouter<UGameplayMessageSubsystem>();
+			FRandomStream Random(Config.Seed);
+			int64 NumCallbacks = 0;
+
+			TArray<FGameplayMessageListenerHandle> Handles;
+			Handles.Reserve(Config.NumListeners);
+			{
+				FAllocationScope RegisterAllocations;
+				for (int32 Index = 0; Index < Config.NumListeners; ++Index)
+				{
+					Handles.Add(RegisterChannelListener(*Router, Random, Config, NumCallbacks));
+				}
+				RegisterAllocations.Stop();
+				Result.BytesPerListener = double(RegisterAllocations.GetNumBytes()) / FMath::Max(Config.NumListeners, 1);
+			}
+
+			const int32 NumUsedChannels = FMath::Clamp(Config.NumChannels, 1, NumChannels);
+			TArray<FGameplayTag> Channels;
+			Channels.SetNum(Config.NumIterations);
+			for (FGameplayTag& Channel : Channels)
+			{
+				Channel = GetChannel(Random.RandHelper(NumUsedChannels));
+			}
+
+			FGameplayMessageBenchmarkPayload Payload;
+			NumCallbacks = 0;
+			{
+				FMeasurement Measurement;
+				for (int32 Iteration = 0; Iteration < Config.NumIterations; ++Iteration)
+				{
+					Payload.Sequence = Iteration;
+					Router->BroadcastMessage(Payload, Channels[Iteration]);
+				}
+				Measurement.Stop();
+				FinishResult(Result, Measurement, NumCallbacks);
+			}
+
+			for (FGameplayMessageListenerHandle& Handle : Handles)
+			{
+				Router->UnregisterListener(Handle);
+			}
+			DestroyRouter(Router);
+			return Result;
+		}
+
+		// One object-scoped listener per target plus a few untargeted ones, broadcasts to random targets
+		FBenchmarkResult RunTargetFiltering(const FBenchmarkConfig& Config)
+		{
+			FBenchmarkResult Result;
+			Result.Scenario = TEXT("TargetFiltering");
+			Result.Config = Config;
+
+			UGameplayMessageSubsystem* Router = CreateRouter<UGameplayMessageSubsystem>();
+			FRandomStream Random(Config.Seed);
+			int64 NumCallbacks = 0;
+
+			TArray<UGameplayMessageBenchmarkTarget*> Targets;
+			Targets.Reserve(Config.NumListeners);
+			for (int32 Index = 0; Index < Config.NumListeners; ++Index)
+			{
+				UGameplayMessageBenchmarkTarget* Target = NewObject<UGameplayMessageBenchmarkTarget>(GetTransientPackage());
+				Target->AddToRoot();
+				Targets.Add(Target);
+			}
+
+			const FGameplayTag Channel = GetChannel(0);
+			auto Callback = [&NumCallbacks](FGameplayTag ActualChannel, const FGameplayMessageBenchmarkPayload& Payload) { ++NumCallbacks; };
+
+			constexpr int32 NumUntargetedListeners = 8;
+			TArray<FGameplayMessageListenerHandle> Handles;
+			Handles.Reserve(Config.NumListeners + NumUntargetedListeners);
+			{
+				FAllocationScope RegisterAllocations;
+				for (UGameplayMessageBenchmarkTarget* Target : Targets)
+				{
+					Handles.Add(Router->RegisterListener<FGameplayMessageBenchmarkPayload>(Channel, Callback, EGameplayMessageMatch::ExactMatch, EGameplayMessagePriority::DEFAULT, Target));
+				}
+				RegisterAllocations.Stop();
+				Result.BytesPerListener = double(RegisterAllocations.GetNumBytes()) / FMath::Max(Config.NumListeners, 1);
+			}
+
+			for (int32 Index = 0; Index < NumUntargetedListeners; ++Index)
+			{
+				Handles.Add(Router->RegisterListener<FGameplayMessageBenchmarkPayload>(Channel, Callback));
+			}
+
+			TArray<TWeakObjectPtr<UObject>> BroadcastTargets;
+			BroadcastTargets.SetNum(Config.NumIterations);
+			for (TWeakObjectPtr<UObject>& BroadcastTarget : BroadcastTargets)
+			{
+				BroadcastTarget = Targets.Num() > 0 ? Targets[Random.RandHelper(Targets.Num())] : nullptr;
+			}
+
+			FGameplayMessageBenchmarkPayload Payload;
+			NumCallbacks = 0;
+			{
+				FMeasurement Measurement;
+				for (int32 Iteration = 0; Iteration < Config.NumIterations; ++Iteration)
+				{
+					Payload.Sequence = Iteration;
+					Router->BroadcastMessage(Payload, Channel, BroadcastTargets[Iteration]);
+				}
+				Measurement.Stop();
+				FinishResult(Result, Measurement, NumCallbacks);
+			}
+
+			for (FGameplayMessageListenerHandle& Handle : Handles)
+			{
+				Router->UnregisterListener(Handle);
+			}
+			for (UGameplayMessageBenchmarkTarget* Target : Targets)
+			{
+				Target->RemoveFromRoot();
+			}
+			DestroyRouter(Router);
+			return Result;
+		}
+
+		// Steady population of N listeners, each op unregisters a random listener and registers a replacement
+		FBenchmarkResult RunRegistrationChurn(const FBenchmarkConfig& Config)
+		{
+			FBenchmarkResult Result;
+			Result.Scenario = TEXT("RegistrationChurn");
+			Result.Config = Config;
+
+			UGameplayMessageSubsystem* Router = CreateRouter<UGameplayMessageSubsystem>();
+			FRandomStream Random(Config.Seed);
+			int64 NumCallbacks = 0;
+
+			TArray<FGameplayMessageListenerHandle> Handles;
+			Handles.Reserve(FMath::Max(Config.NumListeners, 1));
+			{
+				FAllocationScope RegisterAllocations;
+				for (int32 Index = 0; Index < Config.NumListeners; ++Index)
+				{
+					Handles.Add(RegisterChannelListener(*Router, Random, Config, NumCallbacks));
+				}
+				RegisterAllocations.Stop();
+				Result.BytesPerListener = double(RegisterAllocations.GetNumBytes()) / FMath::Max(Config.NumListeners, 1);
+			}
+
+			if (Handles.Num() == 0)
+			{
+				Handles.Add(RegisterChannelListener(*Router, Random, Config, NumCallbacks));
+			}
+
+			TArray<int32> Victims;
+			Victims.SetNum(Config.NumIterations);
+			for (int32& Victim : Victims)
+			{
+				Victim = Random.RandHelper(Handles.Num());
+			}
+
+			{
+				FMeasurement Measurement;
+				for (int32 Iteration = 0; Iteration < Config.NumIterations; ++Iteration)
+				{
+					FGameplayMessageListenerHandle& Handle = Handles[Victims[Iteration]];
+					Router->UnregisterListener(Handle);
+					Handle = RegisterChannelListener(*Router, Random, Config, NumCallbacks);
+				}
+				Measurement.Stop();
+				FinishResult(Result, Measurement, NumCallbacks);
+			}
+
+			for (FGameplayMessageListenerHandle& Handle : Handles)
+			{
+				Router->UnregisterListener(Handle);
+			}
+			DestroyRouter(Router);
+			return Result;
+		}
+
+		// Side of the square the world listeners are spread over, keeps around one listener center per grid cell
+		double GetWorldExtent(const FBenchmarkConfig& Config)
+		{
+			return FMath::Sqrt(double(FMath::Max(Config.NumListeners, 1))) * UE::GameplayWorldMessageSubsystem::GRID_SIZE;
+		}
+
+		FVector RandomWorldPosition(FRandomStream& Random, double Extent)
+		{
+			return FVector(Random.FRandRange(-0.5 * Extent, 0.5 * Extent), Random.FRandRange(-0.5 * Extent, 0.5 * Extent), 0.0);
+		}
+
+		void RegisterWorldListeners(UGameplayWorldMessageSubsystem& Router, FRandomStream& Random, const FBenchmarkConfig& Config, int64& NumCallbacks, TArray<FGameplayWorldMessageListenerHandle>& OutHandles, TArray<FVector>& OutPositions, FBenchmarkResult& Result)
+		{
+			const double Extent = GetWorldExtent(Config);
+			const float Radius = Config.RadiusScale * UE::GameplayWorldMessageSubsystem::GRID_SIZE;
+			auto Callback = [&NumCallbacks](FGameplayTag Channel, const FGameplayMessageBenchmarkPayload& Payload) { ++NumCallbacks; };
+
+			OutPositions.SetNum(Config.NumListeners);
+			for (FVector& Position : OutPositions)
+			{
+				Position = RandomWorldPosition(Random, Extent);
+			}
+
+			OutHandles.Reserve(Config.NumListeners);
+			FAllocationScope RegisterAllocations;
+			for (const FVector& Position : OutPositions)
+			{
+				OutHandles.Add(Router.RegisterListener<FGameplayMessageBenchmarkPayload>(TAG_Benchmark_Channel, Callback, Position, Radius, EGameplayMessageMatch::PartialMatch));
+			}
+			RegisterAllocations.Stop();
+			Result.BytesPerListener = double(RegisterAllocations.GetNumBytes()) / FMath::Max(Config.NumListeners, 1);
+		}
+
+		// World listeners with a radius of RadiusScale * GRID_SIZE, broadcasts at random positions
+		FBenchmarkResult RunWorldRadius(const FBenchmarkConfig& Config)
+		{
+			FBenchmarkResult Result;
+			Result.Scenario = TEXT("WorldRadius");
+			Result.Config = Config;
+
+			UGameplayWorldMessageSubsystem* Router = CreateRouter<UGameplayWorldMessageSubsystem>();
+			FRandomStream Random(Config.Seed);
+			int64 NumCallbacks = 0;
+
+			TArray<FGameplayWorldMessageListenerHandle> Handles;
+			TArray<FVector> Positions;
+			RegisterWorldListeners(*Router, Random, Config, NumCallbacks, Handles, Positions, Result);
+
+			const double Extent = GetWorldExtent(Config);
+			TArray<FVector> BroadcastPositions;
+			BroadcastPositions.SetNum(Config.NumIterations);
+			for (FVector& Position : BroadcastPositions)
+			{
+				Position = RandomWorldPosition(Random, Extent);
+			}
+
+			FGameplayMessageBenchmarkPayload Payload;
+			const FGameplayTag Channel = GetChannel(0);
+			NumCallbacks = 0;
+			{
+				FMeasurement Measurement;
+				for (int32 Iteration = 0; Iteration < Config.NumIterations; ++Iteration)
+				{
+					Payload.Sequence = Iteration;
+					Payload.Location = BroadcastPositions[Iteration];
+					Router->BroadcastMessage(Payload, Channel, BroadcastPositions[Iteration]);
+				}
+				Measurement.Stop();
+				FinishResult(Result, Measurement, NumCallbacks);
+			}
+
+			for (FGameplayWorldMessageListenerHandle& Handle : Handles)
+			{
+				Router->UnregisterListener(Handle);
+			}
+			DestroyRouter(Router);
+			return Result;
+		}
+
+		// World listeners wandering around, each op moves one listener by up to half a cell
+		FBenchmarkResult RunWorldRelocation(const FBenchmarkConfig& Config)
+		{
+			FBenchmarkResult Result;
+			Result.Scenario = TEXT("WorldRelocation");
+			Result.Config = Config;
+
+			UGameplayWorldMessageSubsystem* Router = CreateRouter<UGameplayWorldMessageSubsystem>();
+			FRandomStream Random(Config.Seed);
+			int64 NumCallbacks = 0;
+
+			TArray<FGameplayWorldMessageListenerHandle> Handles;
+			TArray<FVector> Positions;
+			RegisterWorldListeners(*Router, Random, Config, NumCallbacks, Handles, Positions, Result);
+
+			if (Handles.Num() > 0)
+			{
+				const float MaxStep = 0.5f * UE::GameplayWorldMessageSubsystem::GRID_SIZE;
+				TArray<FVector> Steps;
+				Steps.SetNum(Config.NumIterations);
+				for (FVector& Step : Steps)
+				{
+					Step = FVector(Random.FRandRange(-MaxStep, MaxStep), Random.FRandRange(-MaxStep, MaxStep), 0.0);
+				}
+
+				FMeasurement Measurement;
+				for (int32 Iteration = 0; Iteration < Config.NumIterations; ++Iteration)
+				{
+					const int32 ListenerIndex = Iteration % Handles.Num();
+					Positions[ListenerIndex] += Steps[Iteration];
+					Router->UpdateRegisterListenerLocation(Handles[ListenerIndex], Positions[ListenerIndex]);
+				}
+				Measurement.Stop();
+				FinishResult(Result, Measurement, NumCallbacks);
+			}
+
+			for (FGameplayWorldMessageListenerHandle& Handle : Handles)
+			{
+				Router->UnregisterListener(Handle);
+			}
+			DestroyRouter(Router);
+			return Result;
+		}
+
+		// The same population moved all at once every frame through the batched API, each op moves one listener
+		FBenchmarkResult RunWorldBatchRelocation(const FBenchmarkConfig& Config)
+		{
+			FBenchmarkResult Result;
+			Result.Scenario = TEXT("WorldBatchRelocation");
+			Result.Config = Config;
+
+			UGameplayWorldMessageSubsystem* Router = CreateRouter<UGameplayWorldMessageSubsystem>();
+			FRandomStream Random(Config.Seed);
+			int64 NumCallbacks = 0;
+
+			TArray<FGameplayWorldMessageListenerHandle> Handles;
+			TArray<FVector> Positions;
+			RegisterWorldListeners(*Router, Random, Config, NumCallbacks, Handles, Positions, Result);
+
+			if (Handles.Num() > 0)
+			{
+				const float MaxStep = 0.5f * UE::GameplayWorldMessageSubsystem::GRID_SIZE;
+				const int32 NumBatches = FMath::Max(Config.NumIterations / Handles.Num(), 1);
+				TArray<FVector> Steps;
+				Steps.SetNum(Handles.Num());
+				for (FVector& Step : Steps)
+				{
+					Step = FVector(Random.FRandRange(-MaxStep, MaxStep), Random.FRandRange(-MaxStep, MaxStep), 0.0);
+				}
+
+				FMeasurement Measurement;
+				for (int32 Batch = 0; Batch < NumBatches; ++Batch)
+				{
+					// Walk back and forth so listeners stay inside the populated area
+					const double Direction = (Batch & 1) ? -1.0 : 1.0;
+					for (int32 ListenerIndex = 0; ListenerIndex < Handles.Num(); ++ListenerIndex)
+					{
+						Positions[ListenerIndex] += Direction * Steps[ListenerIndex];
+					}
+					Router->UpdateRegisterListenerLocations(Handles, Positions);
+				}
+				Measurement.Stop();
+
+				// Costs are reported per moved listener like the single-listener scenario
+				Result.Config.NumIterations = NumBatches * Handles.Num();
+				FinishResult(Result, Measurement, NumCallbacks);
+			}
+
+			for (FGameplayWorldMessageListenerHandle& Handle : Handles)
+			{
+				Router->UnregisterListener(Handle);
+			}
+			DestroyRouter(Router);
+			return Result;
+		}
+	}
+
+	TConstArrayView<FBenchmarkScenario> GetScenarios()
+	{
+		static const FBenchmarkScenario Scenarios[] =
+		{
+			{ TEXT("ChannelFanout"), TEXT("N listeners across M channels with a partial/exact mix, broadcast on random channels"), &Private::RunChannelFanout },
+			{ TEXT("TargetFiltering"), TEXT("One object-scoped listener per target, broadcast to random targets"), &Private::RunTargetFiltering },
+			{ TEXT("RegistrationChurn"), TEXT("Unregister and replace random listeners of a steady population"), &Private::RunRegistrationChurn },
+			{ TEXT("WorldRadius"), TEXT("World listeners with a radius of RadiusScale * GRID_SIZE, broadcast at random positions"), &Private::RunWorldRadius, /*bSweepsRadius=*/ true },
+			{ TEXT("WorldRelocation"), TEXT("UpdateRegisterListenerLocation on every listener in turn"), &Private::RunWorldRelocation },
+			{ TEXT("WorldBatchRelocation"), TEXT("UpdateRegisterListenerLocations on the whole population at once"), &Private::RunWorldBatchRelocation },
+		};
+
+		return Scenarios;
+	}
+
+	const FBenchmarkScenario* FindScenario(const FString& Name)
+	{
+		for (const FBenchmarkScenario& Scenario : GetScenarios())
+		{
+			if (Name.Equals(Scenario.Name, ESearchCase::IgnoreCase))
+			{
+				return &Scenario;
+			}
+		}
+
+		return nullptr;
+	}
+
+	FString WriteResultsToCsv(TConstArrayView<FBenchmarkResult> Results, const FString& Prefix)
+	{
+		FString PluginVersion = TEXT("Unknown");
+		if (TSharedPtr<IPlugin> Plugin = IPluginManager::Get().FindPlugin(TEXT("GameplayMessageRouter")))
+		{
+			PluginVersion = Plugin->GetDescriptor().VersionName;
+		}
+
+		FString Csv = TEXT("PluginVersion,Scenario,Listeners,Channels,PartialMatchRatio,RadiusScale,Iterations,Seed,NsPerOp,AllocationsPerOp,BytesPerListener,CallbacksPerOp\n");
+		for (const FBenchmarkResult& Result : Results)
+		{
+			Csv += FString::Printf(TEXT("%s,%s,%d,%d,%.3f,%.3f,%d,%d,%.2f,%.4f,%.1f,%.3f\n"),
+				*PluginVersion, *Result.Scenario,
+				Result.Config.NumListeners, Result.Config.NumChannels, Result.Config.PartialMatchRatio, Result.Config.RadiusScale,
+				Result.Config.NumIterations, Result.Config.Seed,
+				Result.NanosecondsPerOp, Result.AllocationsPerOp, Result.BytesPerListener, Result.CallbacksPerOp);
+		}
+
+		const FString Filename = FPaths::ProfilingDir() / TEXT("GameplayMessages") / FString::Printf(TEXT("%s-%s.csv"), *Prefix, *FDateTime::Now().ToString());
+		if (!FFileHelper::SaveStringToFile(Csv, *Filename))
+		{
+			UE_LOG(LogGameplayMessageBenchmarks, Error, TEXT("Failed to write benchmark results to %s"), *Filename);
+			return FString();
+		}
+
+		return Filename;
+	}
+}
@@ -0,0 +1,75 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogGameplayMessageBenchmarks, Log, All);
+
+namespace UE::GameplayMessageBenchmarks
+{
+	/** Size and shape of a scenario run */
+	struct FBenchmarkConfig
+	{
+		// Listeners registered for the scenario
+		int32 NumListeners = 1000;
+
+		// Channels the listeners are spread over, at most NumChannels
+		int32 NumChannels = 8;
+
+		// Share of the listeners registered as partial matches on the channel root, in [0, 1]
+		float PartialMatchRatio = 0.25f;
+
+		// World scenarios: listen radius as a multiple of GRID_SIZE
+		float RadiusScale = 1.0f;
+
+		// Measured operations (broadcasts, register/unregister pairs or relocations)
+		int32 NumIterations = 10000;
+
+		// Seed of the random placement, runs with the same seed are comparable
+		int32 Seed = 0x5EED;
+	};
+
+	/** Measurements of one scenario run */
+	struct FBenchmarkResult
+	{
+		FString Scenario;
+		FBenchmarkConfig Config;
+
+		// Wall time per measured operation
+		double NanosecondsPerOp = 0.0;
+
+		// Allocations made per measured operation, counted on every thread
+		double AllocationsPerOp = 0.0;
+
+		// Net heap growth of the router per registered listener
+		double BytesPerListener = 0.0;
+
+		// Listener callbacks invoked per measured operation, sanity check for the scenario setup
+		double CallbacksPerOp = 0.0;
+	};
+
+	/** A benchmark scenario. Run builds a fresh router, fills it per Config and measures NumIterations operations. */
+	struct FBenchmarkScenario
+	{
+		const TCHAR* Name;
+		const TCHAR* Description;
+		FBenchmarkResult (*Run)(const FBenchmarkConfig& Config);
+
+		// Whether the results depend on RadiusScale, the default run then sweeps it as well
+		bool bSweepsRadius = false;
+	};
+
+	/** Every registered scenario */
+	TConstArrayView<FBenchmarkScenario> GetScenarios();
+
+	/** @return the scenario called Name (case insensitive), or nullptr */
+	const FBenchmarkScenario* FindScenario(const FString& Name);
+
+	/**
+	 * Write results to Saved/Profiling/GameplayMessages/<Prefix>-<timestamp>.csv, tagged with the plugin version
+	 *
+	 * @return the path of the written file, empty on failure
+	 */
+	FString WriteResultsToCsv(TConstArrayView<FBenchmarkResult> Results, const FString& Prefix = TEXT("Benchmark"));
+}
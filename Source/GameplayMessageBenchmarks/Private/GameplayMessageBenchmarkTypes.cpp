@@ -0,0 +1,55 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "GameplayMessageBenchmarkTypes.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(GameplayMessageBenchmarkTypes)
+
+namespace UE::GameplayMessageBenchmarks
+{
+	UE_DEFINE_GAMEPLAY_TAG(TAG_Benchmark, "GameplayMessages.Benchmark");
+	UE_DEFINE_GAMEPLAY_TAG(TAG_Benchmark_Channel, "GameplayMessages.Benchmark.Channel");
+
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_Channel_00, "GameplayMessages.Benchmark.Channel.00");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_Channel_01, "GameplayMessages.Benchmark.Channel.01");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_Channel_02, "GameplayMessages.Benchmark.Channel.02");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_Channel_03, "GameplayMessages.Benchmark.Channel.03");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_Channel_04, "GameplayMessages.Benchmark.Channel.04");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_Channel_05, "GameplayMessages.Benchmark.Channel.05");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_Channel_06, "GameplayMessages.Benchmark.Channel.06");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_Channel_07, "GameplayMessages.Benchmark.Channel.07");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_Channel_08, "GameplayMessages.Benchmark.Channel.08");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_Channel_09, "GameplayMessages.Benchmark.Channel.09");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_Channel_10, "GameplayMessages.Benchmark.Channel.10");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_Channel_11, "GameplayMessages.Benchmark.Channel.11");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_Channel_12, "GameplayMessages.Benchmark.Channel.12");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_Channel_13, "GameplayMessages.Benchmark.Channel.13");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_Channel_14, "GameplayMessages.Benchmark.Channel.14");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_Channel_15, "GameplayMessages.Benchmark.Channel.15");
+
+	FGameplayTag GetChannel(int32 Index)
+	{
+		static const FNativeGameplayTag* Channels[NumChannels] =
+		{
+			&TAG_Benchmark_Channel_00, &TAG_Benchmark_Channel_01, &TAG_Benchmark_Channel_02, &TAG_Benchmark_Channel_03,
+			&TAG_Benchmark_Channel_04, &TAG_Benchmark_Channel_05, &TAG_Benchmark_Channel_06, &TAG_Benchmark_Channel_07,
+			&TAG_Benchmark_Channel_08, &TAG_Benchmark_Channel_09, &TAG_Benchmark_Channel_10, &TAG_Benchmark_Channel_11,
+			&TAG_Benchmark_Channel_12, &TAG_Benchmark_Channel_13, &TAG_Benchmark_Channel_14, &TAG_Benchmark_Channel_15,
+		};
+
+		return Channels[((Index % NumChannels) + NumChannels) % NumChannels]->GetTag();
+	}
+}
+
+//////////////////////////////////////////////////////////////////////
+// UGameplayMessageBenchmarkPackageMap
+
+bool UGameplayMessageBenchmarkPackageMap::SerializeObject(FArchive& Ar, UClass* InClass, UObject*& Obj, FNetworkGUID* OutNetGUID)
+{
+	FString PathName = Obj ? Obj->GetPathName() : FString();
+	Ar << PathName;
+	if (Ar.IsLoading())
+	{
+		Obj = PathName.IsEmpty() ? nullptr : StaticFindObject(InClass, nullptr, *PathName);
+	}
+	return Obj != nullptr;
+}
@@ -0,0 +1,69 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "NativeGameplayTags.h"
+#include "UObject/CoreNet.h"
+#include "UObject/Object.h"
+
+#include "GameplayMessageBenchmarkTypes.generated.h"
+
+namespace UE::GameplayMessageBenchmarks
+{
+	// Number of leaf channels the scenarios spread their listeners over
+	constexpr int32 NumChannels = 16;
+
+	UE_DECLARE_GAMEPLAY_TAG_EXTERN(TAG_Benchmark);
+	UE_DECLARE_GAMEPLAY_TAG_EXTERN(TAG_Benchmark_Channel);
+
+	// Leaf channel Index of GameplayMessages.Benchmark.Channel, Index is wrapped into [0, NumChannels)
+	FGameplayTag GetChannel(int32 Index);
+}
+
+/** Payload broadcast by the benchmarks, roughly the size of a typical gameplay event */
+USTRUCT()
+struct FGameplayMessageBenchmarkPayload
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FVector Location = FVector::ZeroVector;
+
+	UPROPERTY()
+	TObjectPtr<UObject> Instigator = nullptr;
+
+	UPROPERTY()
+	float Magnitude = 0.0f;
+
+	UPROPERTY()
+	int32 Sequence = 0;
+};
+
+/** Payload deriving from the benchmark payload, received by listeners of either type */
+USTRUCT()
+struct FGameplayMessageBenchmarkDerivedPayload : public FGameplayMessageBenchmarkPayload
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	int32 Extra = 0;
+};
+
+/** Target object for object-scoped listeners */
+UCLASS(Transient)
+class UGameplayMessageBenchmarkTarget : public UObject
+{
+	GENERATED_BODY()
+};
+
+/** Package map sending objects by path, lets the relay batch codec run without a net connection */
+UCLASS(Transient)
+class UGameplayMessageBenchmarkPackageMap : public UPackageMap
+{
+	GENERATED_BODY()
+
+public:
+	//~UPackageMap interface
+	virtual bool SerializeObject(FArchive& Ar, UClass* InClass, UObject*& Obj, FNetworkGUID* OutNetGUID = nullptr) override;
+	//~End of UPackageMap interface
+};
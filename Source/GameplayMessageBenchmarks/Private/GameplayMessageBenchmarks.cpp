@@ -0,0 +1,114 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "GameplayMessageBenchmark.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Parse.h"
+#include "Modules/ModuleManager.h"
+
+IMPLEMENT_MODULE(FDefaultModuleImpl, GameplayMessageBenchmarks)
+
+namespace UE::GameplayMessageBenchmarks
+{
+	namespace Private
+	{
+		// Listener counts swept by a run that does not set Listeners=
+		static const int32 DefaultListenerCounts[] = { 100, 1000, 10000 };
+
+		// Radius scales swept by scenarios that depend on it, in a run that does not set Radius=
+		static const float DefaultRadiusScales[] = { 0.25f, 1.0f, 4.0f };
+
+		void RunBenchmarkCommand(const TArray<FString>& Args)
+		{
+			const FString ScenarioName = Args.Num() > 0 && !Args[0].Contains(TEXT("=")) ? Args[0] : TEXT("All");
+			const FString Options = FString::Join(Args, TEXT(" "));
+
+			TArray<const FBenchmarkScenario*> Scenarios;
+			if (ScenarioName.Equals(TEXT("All"), ESearchCase::IgnoreCase))
+			{
+				for (const FBenchmarkScenario& Scenario : GetScenarios())
+				{
+					Scenarios.Add(&Scenario);
+				}
+			}
+			else if (const FBenchmarkScenario* Scenario = FindScenario(ScenarioName))
+			{
+				Scenarios.Add(Scenario);
+			}
+			else
+			{
+				UE_LOG(LogGameplayMessageBenchmarks, Error, TEXT("Unknown benchmark scenario '%s', available scenarios:"), *ScenarioName);
+				for (const FBenchmarkScenario& Available : GetScenarios())
+				{
+					UE_LOG(LogGameplayMessageBenchmarks, Error, TEXT("  %s: %s"), Available.Name, Available.Description);
+				}
+				return;
+			}
+
+			FBenchmarkConfig Config;
+			FParse::Value(*Options, TEXT("Channels="), Config.NumChannels);
+			FParse::Value(*Options, TEXT("Partial="), Config.PartialMatchRatio);
+			FParse::Value(*Options, TEXT("Iterations="), Config.NumIterations);
+			FParse::Value(*Options, TEXT("Seed="), Config.Seed);
+			Config.NumChannels = FMath::Clamp(Config.NumChannels, 1, NumChannels);
+			Config.PartialMatchRatio = FMath::Clamp(Config.PartialMatchRatio, 0.0f, 1.0f);
+			Config.NumIterations = FMath::Max(Config.NumIterations, 1);
+
+			TArray<int32> ListenerCounts;
+			int32 NumListeners = 0;
+			if (FParse::Value(*Options, TEXT("Listeners="), NumListeners))
+			{
+				ListenerCounts.Add(FMath::Max(NumListeners, 0));
+			}
+			else
+			{
+				ListenerCounts.Append(DefaultListenerCounts, UE_ARRAY_COUNT(DefaultListenerCounts));
+			}
+
+			// Scenarios that do not depend on the radius only run at this one
+			float FixedRadiusScale = Config.RadiusScale;
+			TArray<float> RadiusScales;
+			if (FParse::Value(*Options, TEXT("Radius="), FixedRadiusScale))
+			{
+				RadiusScales.Add(FixedRadiusScale);
+			}
+			else
+			{
+				RadiusScales.Append(DefaultRadiusScales, UE_ARRAY_COUNT(DefaultRadiusScales));
+			}
+
+			TArray<FBenchmarkResult> Results;
+			for (const FBenchmarkScenario* Scenario : Scenarios)
+			{
+				const TConstArrayView<float> ScenarioRadiusScales = Scenario->bSweepsRadius ? TConstArrayView<float>(RadiusScales) : TConstArrayView<float>(&FixedRadiusScale, 1);
+				for (float RadiusScale : ScenarioRadiusScales)
+				{
+					Config.RadiusScale = RadiusScale;
+					for (int32 ListenerCount : ListenerCounts)
+					{
+						Config.NumListeners = ListenerCount;
+						const FBenchmarkResult& Result = Results.Add_GetRef(Scenario->Run(Config));
+
+						UE_LOG(LogGameplayMessageBenchmarks, Display, TEXT("%-18s listeners=%-6d radius=%-5.2f %10.1f ns/op %8.3f allocs/op %8.1f bytes/listener %8.2f callbacks/op"),
+							*Result.Scenario, Result.Config.NumListeners, Result.Config.RadiusScale, Result.NanosecondsPerOp, Result.AllocationsPerOp, Result.BytesPerListener, Result.CallbacksPerOp);
+					}
+				}
+			}
+
+			FString Prefix = TEXT("Benchmark");
+			FParse::Value(*Options, TEXT("Prefix="), Prefix);
+
+			const FString Filename = WriteResultsToCsv(Results, Prefix);
+			if (!Filename.IsEmpty())
+			{
+				UE_LOG(LogGameplayMessageBenchmarks, Display, TEXT("Wrote %d benchmark results to %s"), Results.Num(), *Filename);
+			}
+		}
+
+		static FAutoConsoleCommand CmdRunBenchmark(TEXT("GameplayMessages.Benchmark"),
+			TEXT("Benchmark the message routers and write the results to Saved/Profiling/GameplayMessages.\n")
+			TEXT("Usage: GameplayMessages.Benchmark [Scenario|All] [Listeners=N] [Channels=M] [Partial=0.25] [Radius=1.0] [Iterations=N] [Seed=N] [Prefix=Name]\n")
+			TEXT("Without Listeners= every scenario is swept over 100, 1000 and 10000 listeners, and without Radius= WorldRadius is swept\n")
+			TEXT("over radius scales of 0.25, 1 and 4. Runs from -ExecCmds as well."),
+			FConsoleCommandWithArgsDelegate::CreateStatic(&RunBenchmarkCommand));
+	}
+}
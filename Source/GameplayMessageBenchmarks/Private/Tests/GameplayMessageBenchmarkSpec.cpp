@@ -0,0 +1,56 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "GameplayMessageBenchmark.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+BEGIN_DEFINE_SPEC(FGameplayMessageBenchmarkSpec, "GameplayMessages.Benchmark", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+END_DEFINE_SPEC(FGameplayMessageBenchmarkSpec)
+
+void FGameplayMessageBenchmarkSpec::Define()
+{
+	using namespace UE::GameplayMessageBenchmarks;
+
+	// Smoke runs with small populations, keeps the scenarios compiling and sane without measuring anything
+	for (const FBenchmarkScenario& Scenario : GetScenarios())
+	{
+		It(FString::Printf(TEXT("runs %s"), Scenario.Name), [this, &Scenario]()
+		{
+			FBenchmarkConfig Config;
+			Config.NumListeners = 64;
+			Config.NumIterations = 64;
+
+			const FBenchmarkResult Result = Scenario.Run(Config);
+
+			TestEqual(TEXT("Scenario"), Result.Scenario, FString(Scenario.Name));
+			TestTrue(TEXT("Time per op"), FMath::IsFinite(Result.NanosecondsPerOp) && Result.NanosecondsPerOp >= 0.0);
+			TestTrue(TEXT("Allocations per op"), Result.AllocationsPerOp >= 0.0);
+		});
+	}
+
+	It("calls every partial listener on each fanout broadcast", [this]()
+	{
+		FBenchmarkConfig Config;
+		Config.NumListeners = 64;
+		Config.NumIterations = 16;
+		Config.PartialMatchRatio = 1.0f;
+
+		const FBenchmarkResult Result = FindScenario(TEXT("ChannelFanout"))->Run(Config);
+
+		TestEqual(TEXT("Callbacks per broadcast"), Result.CallbacksPerOp, 64.0);
+	});
+
+	It("calls the target's listener and the untargeted ones on each filtered broadcast", [this]()
+	{
+		FBenchmarkConfig Config;
+		Config.NumListeners = 64;
+		Config.NumIterations = 16;
+
+		const FBenchmarkResult Result = FindScenario(TEXT("TargetFiltering"))->Run(Config);
+
+		TestEqual(TEXT("Callbacks per broadcast"), Result.CallbacksPerOp, 9.0);
+	});
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,1018 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Components/SceneComponent.h"
+#include "GameFramework/AsyncAction_ListenForGameplayMessage.h"
+#include "GameFramework/GameplayMessageAsyncActionPool.h"
+#include "GameFramework/GameplayMessageCapture.h"
+#include "GameFramework/GameplayMessageChannel.h"
+#include "GameFramework/GameplayMessageRelayComponent.h"
+#include "GameFramework/GameplayMessageSettings.h"
+#include "GameFramework/GameplayMessageSubsystem.h"
+#include "GameFramework/GameplayWorldMessageSubsystem.h"
+#include "GameplayMessageBenchmarkTypes.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/OutputDevice.h"
+#include "Misc/Paths.h"
+#include "UObject/CoreNet.h"
+#include "UObject/Package.h"
+
+#include <atomic>
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+BEGIN_DEFINE_SPEC(FGameplayMessageRouterSpec, "GameplayMessages.Router", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+	UGameplayMessageSubsystem* Router = nullptr;
+	UGameplayWorldMessageSubsystem* WorldRouter = nullptr;
+	TArray<UObject*> Targets;
+
+	// Id of every listener called, in call order
+	TArray<int32> Calls;
+
+	FGameplayMessageListenerHandle Listen(FGameplayTag Channel, int32 Id, EGameplayMessageMatch MatchType = EGameplayMessageMatch::ExactMatch, EGameplayMessagePriority Priority = EGameplayMessagePriority::DEFAULT, UObject* TargetObject = nullptr)
+	{
+		return Router->RegisterListener<FGameplayMessageBenchmarkPayload>(Channel, [this, Id](FGameplayTag, const FGameplayMessageBenchmarkPayload&) { Calls.Add(Id); }, MatchType, Priority, TargetObject);
+	}
+
+	FGameplayWorldMessageListenerHandle ListenAt(const FVector& Position, float Radius, int32 Id)
+	{
+		return WorldRouter->RegisterListener<FGameplayMessageBenchmarkPayload>(UE::GameplayMessageBenchmarks::GetChannel(0), [this, Id](FGameplayTag, const FGameplayMessageBenchmarkPayload&) { Calls.Add(Id); }, Position, Radius);
+	}
+
+	FGameplayMessageBroadcastResult Broadcast(FGameplayTag Channel, UObject* TargetObject = nullptr)
+	{
+		FGameplayMessageBenchmarkPayload Payload;
+		return Router->BroadcastMessage(Payload, Channel, TargetObject);
+	}
+
+	UObject* CreateTarget()
+	{
+		UObject* Target = NewObject<UGameplayMessageBenchmarkTarget>(GetTransientPackage());
+		Target->AddToRoot();
+		return Targets.Add_GetRef(Target);
+	}
+
+	// Capture cvars as they were before the capture cases changed them
+	bool bWasCaptureEnabled = false;
+	int32 PreviousCaptureBufferSizeKB = 0;
+
+	FString GetCaptureFilename() const
+	{
+		return FPaths::AutomationTransientDir() / TEXT("GameplayMessageRouterSpec.gmcap");
+	}
+
+	// Dump the capture and read it back, false if either failed
+	bool DumpAndLoad(TArray<FGameplayMessageCaptureRecord>& OutRecords)
+	{
+		return FGameplayMessageCapture::Get().Dump(GetCaptureFilename()) == GetCaptureFilename() && FGameplayMessageCapture::Load(GetCaptureFilename(), OutRecords);
+	}
+
+	// Listen on the global router and record the Sequence of every payload received
+	void ListenForSequence(FGameplayTag Channel, UObject* TargetObject = nullptr)
+	{
+		Router->RegisterListener<FGameplayMessageBenchmarkPayload>(Channel, [this](FGameplayTag, const FGameplayMessageBenchmarkPayload& Payload) { Calls.Add(Payload.Sequence); },
+			EGameplayMessageMatch::ExactMatch, EGameplayMessagePriority::DEFAULT, TargetObject);
+	}
+
+	FGameplayMessageRelayEntry& AddRelayEntry(FGameplayMessageRelayBatch& Batch, const UScriptStruct* StructType, const TArray<uint8>& Payload)
+	{
+		FGameplayMessageRelayEntry& Entry = Batch.Entries.AddDefaulted_GetRef();
+		Entry.StructType = StructType;
+		Entry.Channel = UE::GameplayMessageBenchmarks::GetChannel(Batch.Entries.Num());
+		Entry.Payload = Payload;
+		Entry.PayloadBits = Payload.Num() * 8;
+		return Entry;
+	}
+
+	// Loads what Batch saved into OutBatch, PreLoad runs in between, false if either side failed
+	bool RoundTrip(FGameplayMessageRelayBatch& Batch, FGameplayMessageRelayBatch& OutBatch, TFunctionRef<void()> PreLoad = [](){})
+	{
+		UGameplayMessageBenchmarkPackageMap* PackageMap = NewObject<UGameplayMessageBenchmarkPackageMap>(GetTransientPackage());
+
+		FNetBitWriter Writer(PackageMap, 1024 * 8);
+		bool bSaved = true;
+		Batch.NetSerialize(Writer, PackageMap, bSaved);
+
+		PreLoad();
+
+		FNetBitReader Reader(PackageMap, Writer.GetData(), Writer.GetNumBits());
+		bool bLoaded = true;
+		OutBatch.NetSerialize(Reader, PackageMap, bLoaded);
+
+		PackageMap->MarkAsGarbage();
+		return bSaved && bLoaded;
+	}
+
+END_DEFINE_SPEC(FGameplayMessageRouterSpec)
+
+void FGameplayMessageRouterSpec::Define()
+{
+	using namespace UE::GameplayMessageBenchmarks;
+
+	BeforeEach([this]()
+	{
+		// Standalone routers, not owned by any game instance or world
+		Router = NewObject<UGameplayMessageSubsystem>(GetTransientPackage());
+		Router->AddToRoot();
+		WorldRouter = NewObject<UGameplayWorldMessageSubsystem>(GetTransientPackage());
+		WorldRouter->AddToRoot();
+		Calls.Reset();
+	});
+
+	AfterEach([this]()
+	{
+		for (UObject* Target : Targets)
+		{
+			Target->RemoveFromRoot();
+		}
+		Targets.Reset();
+
+		Router->RemoveFromRoot();
+		Router->MarkAsGarbage();
+		Router = nullptr;
+		WorldRouter->RemoveFromRoot();
+		WorldRouter->MarkAsGarbage();
+		WorldRouter = nullptr;
+	});
+
+	Describe("Broadcast order", [this]()
+	{
+		It("calls listeners by priority, then in registration order", [this]()
+		{
+			const FGameplayTag Channel = GetChannel(0);
+			Listen(Channel, 3, EGameplayMessageMatch::ExactMatch, EGameplayMessagePriority::LOWEST);
+			Listen(Channel, 0, EGameplayMessageMatch::ExactMatch, EGameplayMessagePriority::HIGHEST);
+			Listen(Channel, 1);
+			Listen(Channel, 2);
+
+			Broadcast(Channel);
+
+			TestEqual(TEXT("Call order"), Calls, TArray<int32>({ 0, 1, 2, 3 }));
+		});
+
+		It("merges partial and exact listeners by priority", [this]()
+		{
+			const FGameplayTag Channel = GetChannel(0);
+			Listen(TAG_Benchmark_Channel, 1, EGameplayMessageMatch::PartialMatch, EGameplayMessagePriority::LOWER);
+			Listen(Channel, 0, EGameplayMessageMatch::ExactMatch, EGameplayMessagePriority::HIGHER);
+			Listen(TAG_Benchmark, 2, EGameplayMessageMatch::PartialMatch, EGameplayMessagePriority::LOWEST);
+
+			Broadcast(Channel);
+
+			TestEqual(TEXT("Call order"), Calls, TArray<int32>({ 0, 1, 2 }));
+		});
+
+		It("stops at a listener interrupting the message", [this]()
+		{
+			const FGameplayTag Channel = GetChannel(0);
+			Router->RegisterListener<FGameplayMessageBenchmarkPayload>(Channel, [this](FGameplayTag, const FGameplayMessageBenchmarkPayload&)
+			{
+				Calls.Add(0);
+				Router->CancelMessage(true, true);
+			}, EGameplayMessageMatch::ExactMatch, EGameplayMessagePriority::HIGHEST);
+			Listen(Channel, 1);
+
+			const FGameplayMessageBroadcastResult Result = Broadcast(Channel);
+
+			TestEqual(TEXT("Call order"), Calls, TArray<int32>({ 0 }));
+			TestTrue(TEXT("Cancelled"), Result.bCancelled);
+			TestTrue(TEXT("Interrupted"), Result.bInterrupted);
+		});
+	});
+
+	Describe("Channel matching", [this]()
+	{
+		It("only calls exact listeners for their own channel", [this]()
+		{
+			Listen(TAG_Benchmark_Channel, 0);
+			Listen(GetChannel(0), 1);
+
+			Broadcast(GetChannel(0));
+			Broadcast(GetChannel(1));
+
+			TestEqual(TEXT("Calls"), Calls, TArray<int32>({ 1 }));
+		});
+
+		It("calls partial listeners for child channels", [this]()
+		{
+			Listen(TAG_Benchmark_Channel, 0, EGameplayMessageMatch::PartialMatch);
+
+			Broadcast(GetChannel(0));
+			Broadcast(GetChannel(1));
+			Broadcast(TAG_Benchmark);
+
+			TestEqual(TEXT("Calls"), Calls, TArray<int32>({ 0, 0 }));
+		});
+	});
+
+	Describe("Target objects", [this]()
+	{
+		It("only calls object-scoped listeners for their target", [this]()
+		{
+			UObject* TargetA = CreateTarget();
+			UObject* TargetB = CreateTarget();
+			const FGameplayTag Channel = GetChannel(0);
+			Listen(Channel, 0, EGameplayMessageMatch::ExactMatch, EGameplayMessagePriority::DEFAULT, TargetA);
+			Listen(Channel, 1, EGameplayMessageMatch::ExactMatch, EGameplayMessagePriority::DEFAULT, TargetB);
+			Listen(Channel, 2);
+
+			Broadcast(Channel, TargetA);
+			Broadcast(Channel);
+
+			TestEqual(TEXT("Calls"), Calls, TArray<int32>({ 0, 2, 2 }));
+		});
+	});
+
+	Describe("Registration during a broadcast", [this]()
+	{
+		It("skips listeners unregistered by an earlier listener", [this]()
+		{
+			const FGameplayTag Channel = GetChannel(0);
+			FGameplayMessageListenerHandle Victim;
+			Router->RegisterListener<FGameplayMessageBenchmarkPayload>(Channel, [this, &Victim](FGameplayTag, const FGameplayMessageBenchmarkPayload&)
+			{
+				Calls.Add(0);
+				Router->UnregisterListener(Victim);
+			}, EGameplayMessageMatch::ExactMatch, EGameplayMessagePriority::HIGHEST);
+			Victim = Listen(Channel, 1);
+			Listen(Channel, 2, EGameplayMessageMatch::ExactMatch, EGameplayMessagePriority::LOWEST);
+
+			Broadcast(Channel);
+			Broadcast(Channel);
+
+			TestEqual(TEXT("Calls"), Calls, TArray<int32>({ 0, 2, 0, 2 }));
+		});
+
+		It("calls listeners registered during a broadcast from the next one", [this]()
+		{
+			const FGameplayTag Channel = GetChannel(0);
+			bool bRegistered = false;
+			Router->RegisterListener<FGameplayMessageBenchmarkPayload>(Channel, [this, &bRegistered, Channel](FGameplayTag, const FGameplayMessageBenchmarkPayload&)
+			{
+				Calls.Add(0);
+				if (!bRegistered)
+				{
+					bRegistered = true;
+					Listen(Channel, 1);
+				}
+			});
+
+			Broadcast(Channel);
+			Broadcast(Channel);
+
+			TestEqual(TEXT("Calls"), Calls, TArray<int32>({ 0, 0, 1 }));
+		});
+	});
+
+	Describe("Struct inheritance", [this]()
+	{
+		It("delivers derived payloads to listeners of the parent struct by priority", [this]()
+		{
+			Listen(GetChannel(0), 0, EGameplayMessageMatch::ExactMatch, EGameplayMessagePriority::LOWER);
+			Router->RegisterListener<FGameplayMessageBenchmarkDerivedPayload>(GetChannel(0), [this](FGameplayTag, const FGameplayMessageBenchmarkDerivedPayload&) { Calls.Add(1); });
+
+			FGameplayMessageBenchmarkDerivedPayload Derived;
+			Router->BroadcastMessage(Derived, GetChannel(0));
+			Broadcast(GetChannel(0));
+
+			TestEqual(TEXT("Calls"), Calls, TArray<int32>({ 1, 0, 0 }));
+		});
+
+		It("resolves a parent registered after the first broadcast of a child", [this]()
+		{
+			FGameplayMessageBenchmarkDerivedPayload Derived;
+			Router->BroadcastMessage(Derived, GetChannel(0));
+			Listen(GetChannel(0), 0);
+			Router->BroadcastMessage(Derived, GetChannel(0));
+
+			ListenAt(FVector::ZeroVector, 100.0f, 1);
+			WorldRouter->BroadcastMessage(Derived, GetChannel(0), FVector(50.0, 0.0, 0.0));
+
+			TestEqual(TEXT("Calls"), Calls, TArray<int32>({ 0, 1 }));
+		});
+	});
+
+	Describe("Scope routers", [this]()
+	{
+		It("only dispatches to the scope's listeners and forwards to the parent", [this]()
+		{
+			UObject* Target = CreateTarget();
+			FGameplayMessageRouter& Scope = Router->GetScopeRouter(Target, /*bInForwardToParent=*/ true);
+			TestTrue(TEXT("Same scope router"), Router->FindScopeRouter(Target) == &Scope);
+
+			Listen(GetChannel(0), 0);
+			Scope.RegisterListener<FGameplayMessageBenchmarkPayload>(GetChannel(0), [this](FGameplayTag, const FGameplayMessageBenchmarkPayload&) { Calls.Add(1); });
+
+			Broadcast(GetChannel(0));
+			FGameplayMessageBenchmarkPayload Payload;
+			Scope.BroadcastMessage(Payload, GetChannel(0));
+
+			TestEqual(TEXT("Calls"), Calls, TArray<int32>({ 0, 1, 0 }));
+		});
+
+		It("drops every listener of a destroyed scope", [this]()
+		{
+			const FGameplayMessageRouterScope ScopeKey(GetChannel(1));
+			FGameplayMessageRouter& Scope = Router->GetScopeRouter(ScopeKey);
+			FGameplayMessageListenerHandle Handle = Scope.RegisterListener<FGameplayMessageBenchmarkPayload>(GetChannel(0), [this](FGameplayTag, const FGameplayMessageBenchmarkPayload&) { Calls.Add(1); });
+
+			Router->DestroyScopeRouter(ScopeKey);
+			Handle.Unregister();
+
+			FGameplayMessageBenchmarkPayload Payload;
+			Router->GetScopeRouter(ScopeKey).BroadcastMessage(Payload, GetChannel(0));
+
+			TestEqual(TEXT("Calls"), Calls.Num(), 0);
+		});
+
+		It("lets scope listeners interrupt the scope broadcast through the subsystem", [this]()
+		{
+			FGameplayMessageRouter& Scope = Router->GetScopeRouter(FGameplayMessageRouterScope(GetChannel(1)), /*bInForwardToParent=*/ true);
+			Listen(GetChannel(0), 0);
+			Scope.RegisterListener<FGameplayMessageBenchmarkPayload>(GetChannel(0), [this](FGameplayTag, const FGameplayMessageBenchmarkPayload&)
+			{
+				Calls.Add(1);
+				Router->CancelMessage();
+			});
+
+			FGameplayMessageBenchmarkPayload Payload;
+			const FGameplayMessageBroadcastResult Result = Scope.BroadcastMessage(Payload, GetChannel(0));
+
+			TestTrue(TEXT("Interrupted"), Result.bInterrupted);
+			TestEqual(TEXT("Calls"), Calls, TArray<int32>({ 1 }));
+		});
+	});
+
+	Describe("Listener storage", [this]()
+	{
+		It("keeps routing typed channels after compaction", [this]()
+		{
+			const TGameplayMessageChannel<FGameplayMessageBenchmarkPayload> Channel(GetChannel(0));
+			TArray<FGameplayMessageListenerHandle> Handles;
+			for (int32 Index = 1; Index < NumChannels; ++Index)
+			{
+				Handles.Add(Listen(GetChannel(Index), Index));
+			}
+			Channel.RegisterListener(*Router, [this](FGameplayTag, const FGameplayMessageBenchmarkPayload&) { Calls.Add(0); });
+
+			FGameplayMessageBenchmarkPayload Payload;
+			Channel.Broadcast(*Router, Payload);
+			for (FGameplayMessageListenerHandle& Handle : Handles)
+			{
+				Handle.Unregister();
+			}
+			Router->CompactListenerStorage();
+			Channel.Broadcast(*Router, Payload);
+			Broadcast(GetChannel(1));
+
+			TestEqual(TEXT("Calls"), Calls, TArray<int32>({ 0, 0 }));
+		});
+
+		It("reports the memory of every struct type and grid level", [this]()
+		{
+			Listen(GetChannel(0), 0);
+			ListenAt(FVector::ZeroVector, 100.0f, 1);
+
+			struct FReportOutputDevice : public FOutputDevice
+			{
+				FString Report;
+
+				virtual void Serialize(const TCHAR* Text, ELogVerbosity::Type Verbosity, const FName& Category) override
+				{
+					Report += Text;
+					Report += TEXT("\n");
+				}
+			};
+
+			FReportOutputDevice Output;
+			Router->DumpMemory(Output);
+			WorldRouter->DumpMemory(Output);
+
+			TestTrue(TEXT("Struct type reported"), Output.Report.Contains(FGameplayMessageBenchmarkPayload::StaticStruct()->GetName()));
+			TestTrue(TEXT("Grid level reported"), Output.Report.Contains(TEXT("By grid level")));
+		});
+	});
+
+	Describe("Rate limits", [this]()
+	{
+		AfterEach([this]()
+		{
+			GetMutableDefault<UGameplayMessageSettings>()->RateLimits.Reset();
+		});
+
+		It("resolves the limits again once the settings changed", [this]()
+		{
+			FGameplayMessageRateLimit& Limit = GetMutableDefault<UGameplayMessageSettings>()->RateLimits.AddDefaulted_GetRef();
+			Limit.Channel = GetChannel(0);
+			Limit.MaxBroadcasts = 1;
+			Listen(GetChannel(0), 0);
+
+			Broadcast(GetChannel(0));
+			TestTrue(TEXT("Throttled before the edit"), Broadcast(GetChannel(0)).bThrottled);
+
+			// Same number of limits, only the channel changed
+			Limit.Channel = GetChannel(1);
+			GetMutableDefault<UGameplayMessageSettings>()->NotifyRateLimitsChanged();
+
+			TestFalse(TEXT("Throttled after the edit"), Broadcast(GetChannel(0)).bThrottled);
+			TestEqual(TEXT("Calls"), Calls, TArray<int32>({ 0, 0 }));
+		});
+
+		It("drops the broadcasts over the channel's budget", [this]()
+		{
+			FGameplayMessageRateLimit& Limit = GetMutableDefault<UGameplayMessageSettings>()->RateLimits.AddDefaulted_GetRef();
+			Limit.Channel = TAG_Benchmark_Channel;
+			Limit.MaxBroadcasts = 2;
+			Listen(GetChannel(0), 0);
+
+			Broadcast(GetChannel(0));
+			Broadcast(GetChannel(0));
+			const FGameplayMessageBroadcastResult Result = Broadcast(GetChannel(0));
+
+			TestTrue(TEXT("Throttled"), Result.bThrottled);
+			TestEqual(TEXT("Calls"), Calls, TArray<int32>({ 0, 0 }));
+			TestEqual(TEXT("Drops"), Router->GetRateLimiter().GetNumThrottled().FindRef(GetChannel(0)), int64(1));
+		});
+
+		It("keeps a budget per target object", [this]()
+		{
+			FGameplayMessageRateLimit& Limit = GetMutableDefault<UGameplayMessageSettings>()->RateLimits.AddDefaulted_GetRef();
+			Limit.Channel = GetChannel(0);
+			Limit.Scope = EGameplayMessageRateLimitScope::TargetObject;
+			UObject* TargetA = CreateTarget();
+			UObject* TargetB = CreateTarget();
+			Listen(GetChannel(0), 0, EGameplayMessageMatch::ExactMatch, EGameplayMessagePriority::DEFAULT, TargetA);
+			Listen(GetChannel(0), 1, EGameplayMessageMatch::ExactMatch, EGameplayMessagePriority::DEFAULT, TargetB);
+
+			Broadcast(GetChannel(0), TargetA);
+			Broadcast(GetChannel(0), TargetA);
+			Broadcast(GetChannel(0), TargetB);
+
+			TestEqual(TEXT("Calls"), Calls, TArray<int32>({ 0, 1 }));
+		});
+
+		It("still dispatches thread-safe listeners after the last queued message was throttled", [this]()
+		{
+			FGameplayMessageRateLimit& Limit = GetMutableDefault<UGameplayMessageSettings>()->RateLimits.AddDefaulted_GetRef();
+			Limit.Channel = GetChannel(0);
+
+			std::atomic<int32> NumThreadSafeCalls = 0;
+			Router->RegisterListener<FGameplayMessageBenchmarkPayload>(GetChannel(1), [&NumThreadSafeCalls](FGameplayTag, const FGameplayMessageBenchmarkPayload&) { ++NumThreadSafeCalls; },
+				EGameplayMessageMatch::ExactMatch, EGameplayMessagePriority::DEFAULT, nullptr, EGameplayMessageListenerFlags::ThreadSafe);
+
+			FGameplayMessageBenchmarkPayload Payload;
+			Router->QueueMessage(Payload, GetChannel(0));
+			Router->QueueMessage(Payload, GetChannel(0));
+			Router->FlushQueuedMessages();
+			TestEqual(TEXT("Drops"), Router->GetRateLimiter().GetNumThrottled().FindRef(GetChannel(0)), int64(1));
+
+			Broadcast(GetChannel(1));
+			TestEqual(TEXT("Thread-safe calls"), NumThreadSafeCalls.load(), 1);
+		});
+	});
+
+	Describe("Async broadcasts", [this]()
+	{
+		It("completes once the listener continuations are done and merges their flags", [this]()
+		{
+			const FGameplayTag Channel = GetChannel(0);
+			Router->RegisterListener<FGameplayMessageBenchmarkPayload>(Channel, [this](FGameplayTag, const FGameplayMessageBenchmarkPayload&)
+			{
+				Calls.Add(0);
+				const bool bAdded = Router->AddBroadcastContinuation(UE::Tasks::Launch(UE_SOURCE_LOCATION, []()
+				{
+					FGameplayMessageBroadcastResult Result;
+					Result.bCancelled = true;
+					return Result;
+				}));
+				TestTrue(TEXT("Continuation added"), bAdded);
+			});
+			Listen(Channel, 1);
+
+			FGameplayMessageBenchmarkPayload Payload;
+			UE::Tasks::TTask<FGameplayMessageBroadcastResult> Task = Router->BroadcastMessageAsync(Payload, Channel);
+			TestEqual(TEXT("Listeners called synchronously"), Calls, TArray<int32>({ 0, 1 }));
+			TestTrue(TEXT("Cancelled by the continuation"), Task.GetResult().bCancelled);
+			TestFalse(TEXT("Not interrupted"), Task.GetResult().bInterrupted);
+
+			TestFalse(TEXT("No continuation outside an async broadcast"), Router->AddBroadcastContinuation(UE::Tasks::FTask()));
+		});
+
+		It("rejects async broadcasts from thread-safe listeners", [this]()
+		{
+			AddExpectedError(TEXT("Thread-safe listeners cannot broadcast messages"), EAutomationExpectedErrorFlags::Contains, 0);
+
+			std::atomic<bool> bCompleted = false;
+			std::atomic<bool> bCancelled = true;
+			Router->RegisterListener<FGameplayMessageBenchmarkPayload>(GetChannel(1), [this, &bCompleted, &bCancelled](FGameplayTag, const FGameplayMessageBenchmarkPayload&)
+			{
+				FGameplayMessageBenchmarkPayload Nested;
+				UE::Tasks::TTask<FGameplayMessageBroadcastResult> Task = Router->BroadcastMessageAsync(Nested, GetChannel(0));
+				bCompleted = Task.IsCompleted();
+				bCancelled = Task.GetResult().bCancelled;
+			}, EGameplayMessageMatch::ExactMatch, EGameplayMessagePriority::DEFAULT, nullptr, EGameplayMessageListenerFlags::ThreadSafe);
+			Listen(GetChannel(0), 0);
+
+			Broadcast(GetChannel(1));
+			TestTrue(TEXT("Completed right away"), bCompleted.load());
+			TestFalse(TEXT("Default result"), bCancelled.load());
+			TestEqual(TEXT("Calls"), Calls.Num(), 0);
+
+			// The game thread still owns a clean continuation state
+			FGameplayMessageBenchmarkPayload Payload;
+			TestTrue(TEXT("Later async broadcast completes"), Router->BroadcastMessageAsync(Payload, GetChannel(0)).IsCompleted());
+			TestEqual(TEXT("Calls"), Calls, TArray<int32>({ 0 }));
+		});
+
+		It("keeps the result of a broadcast apart from the nested broadcasts of its listeners", [this]()
+		{
+			Router->RegisterListener<FGameplayMessageBenchmarkPayload>(GetChannel(1), [this](FGameplayTag, const FGameplayMessageBenchmarkPayload&)
+			{
+				Router->CancelMessage(true, true);
+			});
+			Router->RegisterListener<FGameplayMessageBenchmarkPayload>(GetChannel(0), [this](FGameplayTag, const FGameplayMessageBenchmarkPayload&)
+			{
+				TestTrue(TEXT("Nested broadcast interrupted"), Broadcast(GetChannel(1)).bInterrupted);
+				Calls.Add(0);
+			}, EGameplayMessageMatch::ExactMatch, EGameplayMessagePriority::HIGHEST);
+			Listen(GetChannel(0), 1);
+
+			const FGameplayMessageBroadcastResult Result = Broadcast(GetChannel(0));
+
+			TestEqual(TEXT("Call order"), Calls, TArray<int32>({ 0, 1 }));
+			TestFalse(TEXT("Outer broadcast interrupted"), Result.bInterrupted);
+		});
+	});
+
+	Describe("Bulk registration", [this]()
+	{
+		It("keeps priority order and removes the batch in one call", [this]()
+		{
+			const FGameplayTag Channel = GetChannel(0);
+			Listen(Channel, 1);
+
+			const EGameplayMessagePriority Priorities[] = { EGameplayMessagePriority::LOWEST, EGameplayMessagePriority::HIGHEST, EGameplayMessagePriority::DEFAULT };
+			const int32 Ids[] = { 3, 0, 2 };
+			TArray<FGameplayMessageListenerParams<FGameplayMessageBenchmarkPayload>> Params;
+			for (int32 Index = 0; Index < UE_ARRAY_COUNT(Ids); ++Index)
+			{
+				FGameplayMessageListenerParams<FGameplayMessageBenchmarkPayload>& ListenerParams = Params.AddDefaulted_GetRef();
+				ListenerParams.Priority = Priorities[Index];
+				ListenerParams.OnMessageReceivedCallback = [this, Id = Ids[Index]](FGameplayTag, const FGameplayMessageBenchmarkPayload&) { Calls.Add(Id); };
+			}
+
+			const TArray<FGameplayMessageListenerHandle> Handles = Router->RegisterListeners<FGameplayMessageBenchmarkPayload>(Channel, Params);
+			Broadcast(Channel);
+			TestEqual(TEXT("Call order"), Calls, TArray<int32>({ 0, 1, 2, 3 }));
+
+			Calls.Reset();
+			Router->UnregisterListeners(Handles);
+			Broadcast(Channel);
+			TestEqual(TEXT("Calls after unregistering"), Calls, TArray<int32>({ 1 }));
+		});
+
+		It("sorts the cells a batch of world listeners was appended to", [this]()
+		{
+			ListenAt(FVector::ZeroVector, 300.0f, 1);
+
+			TArray<FGameplayWorldMessageListenerParams<FGameplayMessageBenchmarkPayload>> Params;
+			for (int32 Id : { 2, 0 })
+			{
+				FGameplayWorldMessageListenerParams<FGameplayMessageBenchmarkPayload>& ListenerParams = Params.AddDefaulted_GetRef();
+				ListenerParams.ListenPosition = FVector(50.0 * Id, 0.0, 0.0);
+				ListenerParams.ListenRadius = 300.0f;
+				ListenerParams.Priority = Id == 0 ? EGameplayMessagePriority::HIGHEST : EGameplayMessagePriority::LOWEST;
+				ListenerParams.SetMessageReceivedCallback([this, Id](FGameplayTag, const FGameplayMessageBenchmarkPayload&) { Calls.Add(Id); });
+			}
+
+			const TArray<FGameplayWorldMessageListenerHandle> Handles = WorldRouter->RegisterListeners<FGameplayMessageBenchmarkPayload>(GetChannel(0), Params);
+
+			FGameplayMessageBenchmarkPayload Payload;
+			WorldRouter->BroadcastMessage(Payload, GetChannel(0), FVector::ZeroVector);
+			TestEqual(TEXT("Call order"), Calls, TArray<int32>({ 0, 1, 2 }));
+
+			Calls.Reset();
+			WorldRouter->UnregisterListeners(Handles);
+			WorldRouter->BroadcastMessage(Payload, GetChannel(0), FVector::ZeroVector);
+			TestEqual(TEXT("Calls after unregistering"), Calls, TArray<int32>({ 1 }));
+		});
+	});
+
+	Describe("Queued messages", [this]()
+	{
+		It("dispatches queued messages in order on flush", [this]()
+		{
+			const FGameplayTag Channel = GetChannel(0);
+			Router->RegisterListener<FGameplayMessageBenchmarkPayload>(Channel, [this](FGameplayTag, const FGameplayMessageBenchmarkPayload& Payload) { Calls.Add(Payload.Sequence); });
+
+			FGameplayMessageBenchmarkPayload Payload;
+			Payload.Sequence = 1;
+			Router->QueueMessage(Payload, Channel);
+			Payload.Sequence = 2;
+			Router->QueueMessage(Payload, Channel);
+
+			TestEqual(TEXT("Calls before flush"), Calls.Num(), 0);
+			Router->FlushQueuedMessages();
+			TestEqual(TEXT("Calls after flush"), Calls, TArray<int32>({ 1, 2 }));
+		});
+	});
+
+	Describe("World listeners", [this]()
+	{
+		It("only receives broadcasts within the listen radius", [this]()
+		{
+			ListenAt(FVector::ZeroVector, 500.0f, 0);
+
+			FGameplayMessageBenchmarkPayload Payload;
+			WorldRouter->BroadcastMessage(Payload, GetChannel(0), FVector(300.0, 0.0, 0.0));
+			WorldRouter->BroadcastMessage(Payload, GetChannel(0), FVector(800.0, 0.0, 0.0));
+
+			TestEqual(TEXT("Calls"), Calls, TArray<int32>({ 0 }));
+		});
+
+		It("receives broadcasts around its new location after a relocation", [this]()
+		{
+			const FGameplayWorldMessageListenerHandle Handle = ListenAt(FVector::ZeroVector, 500.0f, 0);
+			TestTrue(TEXT("Relocated"), WorldRouter->UpdateRegisterListenerLocation(Handle, FVector(5000.0, 0.0, 0.0)));
+
+			FGameplayMessageBenchmarkPayload Payload;
+			WorldRouter->BroadcastMessage(Payload, GetChannel(0), FVector::ZeroVector);
+			WorldRouter->BroadcastMessage(Payload, GetChannel(0), FVector(5200.0, 0.0, 0.0));
+
+			TestEqual(TEXT("Calls"), Calls, TArray<int32>({ 0 }));
+		});
+
+		It("culls a crowded cell by distance across full and partial lanes", [this]()
+		{
+			TArray<FGameplayWorldMessageListenerHandle> Handles;
+			for (int32 Id = 0; Id < 10; ++Id)
+			{
+				Handles.Add(ListenAt(FVector(100.0 * Id, 0.0, 0.0), 120.0f, Id));
+			}
+
+			FGameplayMessageBenchmarkPayload Payload;
+			WorldRouter->BroadcastMessage(Payload, GetChannel(0), FVector(450.0, 0.0, 0.0));
+			WorldRouter->BroadcastMessage(Payload, GetChannel(0), FVector(900.0, 0.0, 50.0));
+			TestEqual(TEXT("Calls"), Calls, TArray<int32>({ 4, 5, 8, 9 }));
+
+			// A move within the same cells still has to update the cells' copy of the position
+			Calls.Reset();
+			WorldRouter->UpdateRegisterListenerLocation(Handles[4], FVector(500.0, 0.0, 0.0));
+			WorldRouter->BroadcastMessage(Payload, GetChannel(0), FVector(560.0, 0.0, 0.0));
+			TestEqual(TEXT("Calls after moving"), Calls, TArray<int32>({ 4, 5, 6 }));
+		});
+
+		It("moves a batch of listeners and keeps the ones sharing a cell in priority order", [this]()
+		{
+			TArray<FGameplayWorldMessageListenerHandle> Handles;
+			Handles.Add(WorldRouter->RegisterListener<FGameplayMessageBenchmarkPayload>(GetChannel(0), [this](FGameplayTag, const FGameplayMessageBenchmarkPayload&) { Calls.Add(1); },
+				FVector::ZeroVector, 300.0f, EGameplayMessageMatch::ExactMatch, EGameplayMessagePriority::LOWER));
+			Handles.Add(WorldRouter->RegisterListener<FGameplayMessageBenchmarkPayload>(GetChannel(0), [this](FGameplayTag, const FGameplayMessageBenchmarkPayload&) { Calls.Add(0); },
+				FVector(10000.0, 0.0, 0.0), 300.0f, EGameplayMessageMatch::ExactMatch, EGameplayMessagePriority::HIGHER));
+
+			const TArray<FVector> Positions = { FVector(5000.0, 0.0, 0.0), FVector(5100.0, 0.0, 0.0) };
+			TestEqual(TEXT("Updated"), WorldRouter->UpdateRegisterListenerLocations(Handles, Positions), 2);
+
+			FGameplayMessageBenchmarkPayload Payload;
+			WorldRouter->BroadcastMessage(Payload, GetChannel(0), FVector::ZeroVector);
+			WorldRouter->BroadcastMessage(Payload, GetChannel(0), FVector(10000.0, 0.0, 0.0));
+			WorldRouter->BroadcastMessage(Payload, GetChannel(0), FVector(5050.0, 0.0, 0.0));
+
+			TestEqual(TEXT("Calls"), Calls, TArray<int32>({ 0, 1 }));
+		});
+
+		It("follows its component once it moves past the threshold", [this]()
+		{
+			USceneComponent* Component = NewObject<USceneComponent>(GetTransientPackage());
+			Component->AddToRoot();
+			Targets.Add(Component);
+
+			const FGameplayWorldMessageListenerHandle Handle = ListenAt(FVector::ZeroVector, 200.0f, 0);
+			TestTrue(TEXT("Following"), WorldRouter->SetListenerFollowComponent(Handle, Component, 100.0f));
+
+			FGameplayMessageBenchmarkPayload Payload;
+			Component->SetWorldLocation(FVector(60.0, 0.0, 0.0));
+			WorldRouter->UpdateFollowedListeners();
+			WorldRouter->BroadcastMessage(Payload, GetChannel(0), FVector(-180.0, 0.0, 0.0));
+
+			Component->SetWorldLocation(FVector(3000.0, 0.0, 0.0));
+			WorldRouter->UpdateFollowedListeners();
+			WorldRouter->BroadcastMessage(Payload, GetChannel(0), FVector::ZeroVector);
+			WorldRouter->BroadcastMessage(Payload, GetChannel(0), FVector(3100.0, 0.0, 0.0));
+
+			TestEqual(TEXT("Calls"), Calls, TArray<int32>({ 0, 0 }));
+		});
+
+		It("delivers area broadcasts once per overlapping listener in priority order", [this]()
+		{
+			ListenAt(FVector::ZeroVector, 2000.0f, 0);
+			WorldRouter->RegisterListener<FGameplayMessageBenchmarkPayload>(GetChannel(0), [this](FGameplayTag, const FGameplayMessageBenchmarkPayload&) { Calls.Add(1); },
+				FVector(1700.0, 0.0, 0.0), 100.0f, EGameplayMessageMatch::ExactMatch, EGameplayMessagePriority::HIGHER);
+			ListenAt(FVector(5000.0, 0.0, 0.0), 100.0f, 2);
+
+			FGameplayMessageBenchmarkPayload Payload;
+			WorldRouter->BroadcastMessageInArea(Payload, GetChannel(0), FSphere(FVector(1000.0, 0.0, 0.0), 650.0));
+			WorldRouter->BroadcastMessageInArea(Payload, GetChannel(0), FBox::BuildAABB(FVector(5000.0, 0.0, 0.0), FVector(50.0)));
+
+			TestEqual(TEXT("Calls"), Calls, TArray<int32>({ 1, 0, 2 }));
+		});
+
+		It("delivers one in every few far tier messages and passes the squared distance", [this]()
+		{
+			FGameplayWorldMessageListenerParams<FGameplayMessageBenchmarkPayload> Params;
+			Params.ListenRadius = 1000.0f;
+			Params.InnerRadius = 100.0f;
+			Params.FarDeliveryInterval = 3;
+			Params.OnMessageReceivedCallback = [this](FGameplayTag, const FGameplayMessageBenchmarkPayload&) { Calls.Add(0); };
+			WorldRouter->RegisterListener(GetChannel(0), Params);
+
+			TArray<float> Distances;
+			WorldRouter->RegisterListener<FGameplayMessageBenchmarkPayload>(GetChannel(0), [&Distances](FGameplayTag, const FGameplayMessageBenchmarkPayload&, float DistanceSquared) { Distances.Add(DistanceSquared); },
+				FVector::ZeroVector, 1000.0f);
+
+			FGameplayMessageBenchmarkPayload Payload;
+			for (int32 Index = 0; Index < 4; ++Index)
+			{
+				WorldRouter->BroadcastMessage(Payload, GetChannel(0), FVector(500.0, 0.0, 0.0));
+			}
+			WorldRouter->BroadcastMessage(Payload, GetChannel(0), FVector(50.0, 0.0, 0.0));
+
+			TestEqual(TEXT("Calls"), Calls, TArray<int32>({ 0, 0, 0 }));
+			TestEqual(TEXT("Deliveries with distance"), Distances.Num(), 5);
+			TestEqual(TEXT("Far distance"), Distances[0], 250000.0f, 1.0f);
+			TestEqual(TEXT("Near distance"), Distances.Last(), 2500.0f, 1.0f);
+		});
+
+		It("merges listeners stored in different levels of a hierarchical grid by priority", [this]()
+		{
+			FGameplayWorldMessageGridSettings GridSettings;
+			GridSettings.CellSize = 400.0f;
+			GridSettings.Mode = EGameplayWorldMessageGridMode::Hierarchical;
+			WorldRouter->SetGridSettings(GridSettings);
+
+			WorldRouter->RegisterListener<FGameplayMessageBenchmarkPayload>(GetChannel(0), [this](FGameplayTag, const FGameplayMessageBenchmarkPayload&) { Calls.Add(1); },
+				FVector::ZeroVector, 30000.0f, EGameplayMessageMatch::ExactMatch, EGameplayMessagePriority::LOWER);
+			WorldRouter->RegisterListener<FGameplayMessageBenchmarkPayload>(GetChannel(0), [this](FGameplayTag, const FGameplayMessageBenchmarkPayload&) { Calls.Add(0); },
+				FVector(100.0, 0.0, 0.0), 200.0f, EGameplayMessageMatch::ExactMatch, EGameplayMessagePriority::HIGHER);
+
+			FGameplayMessageBenchmarkPayload Payload;
+			WorldRouter->BroadcastMessage(Payload, GetChannel(0), FVector(150.0, 0.0, 0.0));
+			WorldRouter->BroadcastMessage(Payload, GetChannel(0), FVector(20000.0, 0.0, 0.0));
+
+			TestEqual(TEXT("Calls"), Calls, TArray<int32>({ 0, 1, 1 }));
+		});
+
+		It("packs negative coordinates into 3D cell ids", [this]()
+		{
+			const FVector Position(-2500.0, 700.0, -4100.0);
+			const int64 GridID = UE::GameplayWorldMessageSubsystem::GetGridID3D(Position, 1000.0f, 500.0f);
+
+			TestEqual(TEXT("Cell center"), UE::GameplayWorldMessageSubsystem::GetGridCenter3D(GridID, 1000.0f, 500.0f), FVector(-2500.0, 500.0, -4250.0));
+			TestTrue(TEXT("Sphere cells contain its center cell"), UE::GameplayWorldMessageSubsystem::GetGridsInSphere(Position, 100.0f, 1000.0f, 500.0f).Contains(GridID));
+		});
+
+		It("only reaches listeners on the broadcast floor when partitioning along Z", [this]()
+		{
+			FGameplayWorldMessageGridSettings GridSettings;
+			GridSettings.bPartitionZ = true;
+			GridSettings.CellHeight = 400.0f;
+			WorldRouter->SetGridSettings(GridSettings);
+
+			ListenAt(FVector(0.0, 0.0, 100.0), 300.0f, 0);
+			ListenAt(FVector(0.0, 0.0, 1300.0), 300.0f, 1);
+
+			FGameplayMessageBenchmarkPayload Payload;
+			WorldRouter->BroadcastMessage(Payload, GetChannel(0), FVector(0.0, 0.0, 150.0));
+			WorldRouter->BroadcastMessage(Payload, GetChannel(0), FVector(0.0, 0.0, 1250.0));
+
+			TestEqual(TEXT("Calls"), Calls, TArray<int32>({ 0, 1 }));
+		});
+
+		It("bounds the listen spheres of every listener around any center", [this]()
+		{
+			TestEqual(TEXT("No listeners"), WorldRouter->GetListenBoundRadius(FVector::ZeroVector), 0.0f);
+
+			ListenAt(FVector::ZeroVector, 100.0f, 0);
+			ListenAt(FVector(5000.0, 0.0, 0.0), 200.0f, 1);
+
+			TestEqual(TEXT("Around the first listener"), WorldRouter->GetListenBoundRadius(FVector::ZeroVector), 5200.0f);
+			TestEqual(TEXT("Between the listeners"), WorldRouter->GetListenBoundRadius(FVector(2500.0, 0.0, 0.0)), 2700.0f);
+		});
+	});
+
+	Describe("Message capture", [this]()
+	{
+		BeforeEach([this]()
+		{
+			IConsoleManager& ConsoleManager = IConsoleManager::Get();
+			bWasCaptureEnabled = ConsoleManager.FindConsoleVariable(TEXT("GameplayMessages.Capture.Enabled"))->GetBool();
+			PreviousCaptureBufferSizeKB = ConsoleManager.FindConsoleVariable(TEXT("GameplayMessages.Capture.BufferSizeKB"))->GetInt();
+			ConsoleManager.FindConsoleVariable(TEXT("GameplayMessages.Capture.Enabled"))->Set(true);
+			FGameplayMessageCapture::Get().Reset();
+		});
+
+		AfterEach([this]()
+		{
+			IConsoleManager& ConsoleManager = IConsoleManager::Get();
+			ConsoleManager.FindConsoleVariable(TEXT("GameplayMessages.Capture.Enabled"))->Set(bWasCaptureEnabled);
+			ConsoleManager.FindConsoleVariable(TEXT("GameplayMessages.Capture.BufferSizeKB"))->Set(PreviousCaptureBufferSizeKB);
+			FGameplayMessageCapture::Get().Reset();
+			IFileManager::Get().Delete(*GetCaptureFilename());
+		});
+
+		It("writes the broadcasts of both routers to a file that loads and replays them", [this]()
+		{
+			UObject* Target = CreateTarget();
+			FGameplayMessageBenchmarkPayload Payload;
+			Payload.Sequence = 1;
+			Router->BroadcastMessage(Payload, GetChannel(0), Target);
+			Payload.Sequence = 2;
+			WorldRouter->BroadcastMessage(Payload, GetChannel(1), FVector(100.0, 0.0, 0.0));
+
+			TArray<FGameplayMessageCaptureRecord> Records;
+			TestTrue(TEXT("Dumped and loaded"), DumpAndLoad(Records));
+			if (!TestEqual(TEXT("Records"), Records.Num(), 2))
+			{
+				return;
+			}
+
+			TestTrue(TEXT("Global router"), Records[0].Router == EGameplayMessageCaptureRouter::Global);
+			TestEqual(TEXT("Global channel"), Records[0].Channel, GetChannel(0));
+			TestEqual(TEXT("Struct"), Records[0].StructPath, FGameplayMessageBenchmarkPayload::StaticStruct()->GetPathName());
+			TestEqual(TEXT("Target"), Records[0].TargetPath, Target->GetPathName());
+			TestTrue(TEXT("World router"), Records[1].Router == EGameplayMessageCaptureRouter::World);
+			TestEqual(TEXT("World channel"), Records[1].Channel, GetChannel(1));
+			TestEqual(TEXT("World position"), Records[1].WorldPosition, FVector(100.0, 0.0, 0.0));
+
+			ListenForSequence(GetChannel(0), Target);
+			WorldRouter->RegisterListener<FGameplayMessageBenchmarkPayload>(GetChannel(1), [this](FGameplayTag, const FGameplayMessageBenchmarkPayload& Message) { Calls.Add(Message.Sequence); }, FVector(100.0, 0.0, 50.0), 100.0f);
+			for (const FGameplayMessageCaptureRecord& Record : Records)
+			{
+				TestTrue(TEXT("Replayed"), FGameplayMessageReplay::Broadcast(Router, WorldRouter, Record));
+			}
+
+			TestEqual(TEXT("Calls"), Calls, TArray<int32>({ 1, 2 }));
+			TestEqual(TEXT("Replay not recorded"), FGameplayMessageCapture::Get().Num(), 2);
+		});
+
+		It("records the shape of area broadcasts and replays them in the same area", [this]()
+		{
+			FGameplayMessageBenchmarkPayload Payload;
+			Payload.Sequence = 1;
+			WorldRouter->BroadcastMessageInArea(Payload, GetChannel(0), FSphere(FVector::ZeroVector, 600.0));
+			Payload.Sequence = 2;
+			WorldRouter->BroadcastMessageInArea(Payload, GetChannel(0), FBox::BuildAABB(FVector::ZeroVector, FVector(600.0, 10.0, 10.0)));
+
+			TArray<FGameplayMessageCaptureRecord> Records;
+			TestTrue(TEXT("Dumped and loaded"), DumpAndLoad(Records));
+			if (!TestEqual(TEXT("Records"), Records.Num(), 2))
+			{
+				return;
+			}
+
+			TestTrue(TEXT("Sphere"), Records[0].Shape == EGameplayMessageCaptureShape::Sphere);
+			TestEqual(TEXT("Sphere radius"), Records[0].AreaExtent.X, 600.0);
+			TestTrue(TEXT("Box"), Records[1].Shape == EGameplayMessageCaptureShape::Box);
+			TestEqual(TEXT("Box extent"), Records[1].AreaExtent, FVector(600.0, 10.0, 10.0));
+
+			// Out of reach of a point broadcast at the center of either area
+			WorldRouter->RegisterListener<FGameplayMessageBenchmarkPayload>(GetChannel(0), [this](FGameplayTag, const FGameplayMessageBenchmarkPayload& Message) { Calls.Add(Message.Sequence); }, FVector(500.0, 0.0, 0.0), 10.0f);
+			for (const FGameplayMessageCaptureRecord& Record : Records)
+			{
+				FGameplayMessageReplay::Broadcast(Router, WorldRouter, Record);
+			}
+			TestEqual(TEXT("Calls"), Calls, TArray<int32>({ 1, 2 }));
+		});
+
+		It("drops the oldest records once the ring wraps around", [this]()
+		{
+			// Resizing clears the ring, a few records fill it so the later ones are split across its end
+			IConsoleManager::Get().FindConsoleVariable(TEXT("GameplayMessages.Capture.BufferSizeKB"))->Set(2);
+
+			constexpr int32 NumBroadcasts = 64;
+			FGameplayMessageBenchmarkPayload Payload;
+			for (int32 Sequence = 0; Sequence < NumBroadcasts; ++Sequence)
+			{
+				Payload.Sequence = Sequence;
+				Router->BroadcastMessage(Payload, GetChannel(0));
+			}
+
+			const int32 NumKept = FGameplayMessageCapture::Get().Num();
+			TestTrue(TEXT("Oldest dropped"), NumKept > 0 && NumKept < NumBroadcasts);
+
+			TArray<FGameplayMessageCaptureRecord> Records;
+			TestTrue(TEXT("Dumped and loaded"), DumpAndLoad(Records));
+			TestEqual(TEXT("Records"), Records.Num(), NumKept);
+
+			ListenForSequence(GetChannel(0));
+			TArray<int32> Expected;
+			for (const FGameplayMessageCaptureRecord& Record : Records)
+			{
+				Expected.Add(NumBroadcasts - NumKept + Expected.Num());
+				FGameplayMessageReplay::Broadcast(Router, WorldRouter, Record);
+			}
+			TestEqual(TEXT("Newest records replayed in order"), Calls, Expected);
+		});
+	});
+
+	Describe("Relay batches", [this]()
+	{
+		It("round-trips type runs, payload deltas, size changes and targets", [this]()
+		{
+			UObject* Target = CreateTarget();
+			UObject* LostTarget = CreateTarget();
+			const UScriptStruct* PayloadType = FGameplayMessageBenchmarkPayload::StaticStruct();
+			const UScriptStruct* DerivedType = FGameplayMessageBenchmarkDerivedPayload::StaticStruct();
+
+			FGameplayMessageRelayBatch Batch;
+			FGameplayMessageRelayEntry& Targeted = AddRelayEntry(Batch, PayloadType, { 1, 2, 3, 4 });
+			Targeted.TargetObject = Target;
+			Targeted.bHasTarget = true;
+			AddRelayEntry(Batch, PayloadType, { 1, 9, 3, 4 });
+			AddRelayEntry(Batch, PayloadType, { 5, 6, 7, 8, 9 });
+			FGameplayMessageRelayEntry& World = AddRelayEntry(Batch, DerivedType, { 7 });
+			World.Router = EGameplayMessageCaptureRouter::World;
+			World.WorldPosition = FVector(100.0, -200.0, 300.0);
+			FGameplayMessageRelayEntry& Lost = AddRelayEntry(Batch, DerivedType, { 7 });
+			Lost.TargetObject = LostTarget;
+			Lost.bHasTarget = true;
+
+			// A new name stands for an object the client never heard of
+			FGameplayMessageRelayBatch Loaded;
+			TestTrue(TEXT("Serialized"), RoundTrip(Batch, Loaded, [LostTarget]() { LostTarget->Rename(nullptr, nullptr, REN_DontCreateRedirectors | REN_NonTransactional); }));
+			if (!TestEqual(TEXT("Entries"), Loaded.Entries.Num(), Batch.Entries.Num()))
+			{
+				return;
+			}
+
+			for (int32 Index = 0; Index < Batch.Entries.Num(); ++Index)
+			{
+				const FGameplayMessageRelayEntry& Expected = Batch.Entries[Index];
+				const FGameplayMessageRelayEntry& Actual = Loaded.Entries[Index];
+				TestTrue(FString::Printf(TEXT("Struct type %d"), Index), Actual.StructType == Expected.StructType);
+				TestEqual(FString::Printf(TEXT("Channel %d"), Index), Actual.Channel, Expected.Channel);
+				TestEqual(FString::Printf(TEXT("Payload %d"), Index), Actual.Payload, Expected.Payload);
+				TestEqual(FString::Printf(TEXT("Payload bits %d"), Index), Actual.PayloadBits, Expected.PayloadBits);
+				TestEqual(FString::Printf(TEXT("Targeted %d"), Index), Actual.bHasTarget, Expected.bHasTarget);
+			}
+
+			TestTrue(TEXT("Target"), Loaded.Entries[0].TargetObject.Get() == Target);
+			TestTrue(TEXT("World router"), Loaded.Entries[3].Router == EGameplayMessageCaptureRouter::World);
+			TestEqual(TEXT("World position"), Loaded.Entries[3].WorldPosition, World.WorldPosition);
+			TestFalse(TEXT("Unresolved target"), Loaded.Entries[4].TargetObject.IsValid());
+			TestEqual(TEXT("Payload bytes"), Loaded.NumPayloadBytes, 4 + 4 + 5 + 1 + 1);
+		});
+
+		It("rejects batches over the entry and payload limits", [this]()
+		{
+			const UScriptStruct* PayloadType = FGameplayMessageBenchmarkPayload::StaticStruct();
+
+			FGameplayMessageRelayBatch TooManyEntries;
+			for (uint32 Index = 0; Index <= FGameplayMessageRelayBatch::MaxEntries; ++Index)
+			{
+				AddRelayEntry(TooManyEntries, PayloadType, {});
+			}
+			FGameplayMessageRelayBatch Loaded;
+			TestFalse(TEXT("Too many entries"), RoundTrip(TooManyEntries, Loaded));
+
+			FGameplayMessageRelayBatch TooLarge;
+			TArray<uint8> Payload;
+			Payload.SetNumZeroed(FGameplayMessageRelayBatch::MaxPayloadBits / 8 + 1);
+			AddRelayEntry(TooLarge, PayloadType, Payload);
+			Loaded.Reset();
+			TestFalse(TEXT("Payload too large"), RoundTrip(TooLarge, Loaded));
+		});
+	});
+
+	Describe("Async action pool", [this]()
+	{
+		It("hands back a matching action first, then any action of the requested class", [this]()
+		{
+			IConsoleVariable* CVarEnabled = IConsoleManager::Get().FindConsoleVariable(TEXT("GameplayMessages.AsyncActionPool.Enabled"));
+			const bool bWasEnabled = CVarEnabled->GetBool();
+			CVarEnabled->Set(true);
+
+			UGameplayMessageAsyncActionPool* Pool = NewObject<UGameplayMessageAsyncActionPool>(GetTransientPackage());
+			UAsyncAction_ListenForGameplayMessage* First = NewObject<UAsyncAction_ListenForGameplayMessage>(Pool);
+			UAsyncAction_ListenForGameplayMessage* Second = NewObject<UAsyncAction_ListenForGameplayMessage>(Pool);
+			TestTrue(TEXT("Released first"), Pool->Release(First));
+			TestTrue(TEXT("Released second"), Pool->Release(Second));
+
+			bool bSameRegistration = false;
+			UAsyncAction_ListenForGameplayMessage* Matching = Pool->Acquire<UAsyncAction_ListenForGameplayMessage>([First](const UAsyncAction_ListenForGameplayMessage& Action) { return &Action == First; }, bSameRegistration);
+			TestTrue(TEXT("Matching action"), Matching == First && bSameRegistration);
+
+			UAsyncAction_ListenForGameplayMessage* Any = Pool->Acquire<UAsyncAction_ListenForGameplayMessage>([](const UAsyncAction_ListenForGameplayMessage&) { return false; }, bSameRegistration);
+			TestTrue(TEXT("Any action"), Any == Second && !bSameRegistration);
+
+			TestNull(TEXT("Empty pool"), Pool->Acquire<UAsyncAction_ListenForGameplayMessage>([](const UAsyncAction_ListenForGameplayMessage&) { return true; }, bSameRegistration));
+
+			CVarEnabled->Set(bWasEnabled);
+			Pool->MarkAsGarbage();
+		});
+	});
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
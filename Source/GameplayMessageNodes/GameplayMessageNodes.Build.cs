@@ -16,6 +16,7 @@ public class GameplayMessageNodes : ModuleRules
 				"Engine",
 				"KismetCompiler",
 				"PropertyEditor",
+				"ToolMenus",
 				"GameplayMessageRuntime",
 				"UnrealEd",
 				
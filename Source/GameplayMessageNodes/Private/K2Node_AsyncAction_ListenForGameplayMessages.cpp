@@ -9,6 +9,7 @@
 #include "GameplayTagContainer.h"
 #include "K2Node_AssignmentStatement.h"
 #include "K2Node_AsyncAction.h"
+#include "K2Node_BreakStruct.h"
 #include "K2Node_CallFunction.h"
 #include "K2Node_TemporaryVariable.h"
 #include "KismetCompiler.h"
@@ -51,7 +52,7 @@ void UK2Node_AsyncAction_ListenForGameplayMessages::GetPinHoverText(const UEdGra
 	Super::GetPinHoverText(Pin, HoverTextOut);
 	if (Pin.PinName == UK2Node_AsyncAction_ListenForGameplayMessagesHelper::PayloadPinName)
 	{
-		HoverTextOut = HoverTextOut + LOCTEXT("PayloadOutTooltip", "\n\nThe message structure that we received").ToString();
+		HoverTextOut = HoverTextOut + LOCTEXT("PayloadOutTooltip", "\n\nThe message structure that we received. Split the pin to only read the members used instead of copying the whole payload").ToString();
 	}
 }
 
@@ -147,6 +148,31 @@ bool UK2Node_AsyncAction_ListenForGameplayMessages::HandlePayloadImplementation(
 		}
 	}
 
+	UEdGraphPin* PayloadVarPin = PayloadVar.TempVar->GetVariablePin();
+	if (PayloadVarPin->LinkedTo.Num() == 0)
+	{
+		// Nothing reads the payload, don't copy it
+		return true;
+	}
+
+	// A split payload pin only reads the members it uses, straight from the received payload
+	TArray<UK2Node_BreakStruct*> BreakNodes;
+	for (UEdGraphPin* LinkedPin : PayloadVarPin->LinkedTo)
+	{
+		UK2Node_BreakStruct* BreakNode = Cast<UK2Node_BreakStruct>(LinkedPin->GetOwningNode());
+		if (!BreakNode)
+		{
+			BreakNodes.Reset();
+			break;
+		}
+		BreakNodes.AddUnique(BreakNode);
+	}
+
+	if (BreakNodes.Num() > 0)
+	{
+		return HandlePayloadMembersImplementation(CurrentProperty, ProxyObjectVar, BreakNodes, InOutLastActivatedThenPin, SourceGraph, CompilerContext);
+	}
+
 	UK2Node_TemporaryVariable* TempVarOutput = CompilerContext.SpawnInternalVariable(
 		this, PinType.PinCategory, PinType.PinSubCategory, PinType.PinSubCategoryObject.Get(), PinType.ContainerType, PinType.PinValueType);
 
@@ -189,6 +215,65 @@ bool UK2Node_AsyncAction_ListenForGameplayMessages::HandlePayloadImplementation(
 	return bIsErrorFree;
 }
 
+bool UK2Node_AsyncAction_ListenForGameplayMessages::HandlePayloadMembersImplementation(FMulticastDelegateProperty* CurrentProperty, const FBaseAsyncTaskHelper::FOutputPinAndLocalVariable& ProxyObjectVar, TConstArrayView<UK2Node_BreakStruct*> BreakNodes, UEdGraphPin*& InOutLastActivatedThenPin, UEdGraph* SourceGraph, FKismetCompilerContext& CompilerContext)
+{
+	bool bIsErrorFree = true;
+	const UEdGraphSchema_K2* Schema = CompilerContext.GetSchema();
+
+	UEdGraphPin* FirstExecPin = nullptr;
+	UEdGraphPin* LastThenPin = nullptr;
+
+	for (UK2Node_BreakStruct* BreakNode : BreakNodes)
+	{
+		for (UEdGraphPin* MemberPin : BreakNode->Pins)
+		{
+			if (MemberPin->Direction != EGPD_Output || MemberPin->LinkedTo.Num() == 0)
+			{
+				continue;
+			}
+
+			const FEdGraphPinType& MemberType = MemberPin->PinType;
+			UK2Node_TemporaryVariable* MemberVar = CompilerContext.SpawnInternalVariable(
+				this, MemberType.PinCategory, MemberType.PinSubCategory, MemberType.PinSubCategoryObject.Get(), MemberType.ContainerType, MemberType.PinValueType);
+
+			UK2Node_CallFunction* const CallGetMemberNode = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
+			CallGetMemberNode->FunctionReference.SetExternalMember(GET_FUNCTION_NAME_CHECKED(UAsyncAction_ListenForGameplayMessage, GetPayloadProperty), CurrentProperty->GetOwnerClass());
+			CallGetMemberNode->AllocateDefaultPins();
+
+			UEdGraphPin* GetMemberCallSelfPin = Schema->FindSelfPin(*CallGetMemberNode, EGPD_Input);
+			bIsErrorFree &= GetMemberCallSelfPin && Schema->TryCreateConnection(GetMemberCallSelfPin, ProxyObjectVar.TempVar->GetVariablePin());
+
+			// Break struct pins are named after the member they read
+			CallGetMemberNode->FindPinChecked(TEXT("PropertyName"))->DefaultValue = MemberPin->PinName.ToString();
+
+			UEdGraphPin* GetMemberValuePin = CallGetMemberNode->FindPinChecked(TEXT("OutValue"));
+			GetMemberValuePin->PinType = MemberType;
+			bIsErrorFree &= Schema->TryCreateConnection(MemberVar->GetVariablePin(), GetMemberValuePin);
+			bIsErrorFree &= CompilerContext.MovePinLinksToIntermediate(*MemberPin, *MemberVar->GetVariablePin()).CanSafeConnect();
+
+			if (LastThenPin)
+			{
+				bIsErrorFree &= Schema->TryCreateConnection(LastThenPin, CallGetMemberNode->GetExecPin());
+			}
+			else
+			{
+				FirstExecPin = CallGetMemberNode->GetExecPin();
+			}
+			LastThenPin = CallGetMemberNode->GetThenPin();
+		}
+
+		BreakNode->BreakAllNodeLinks();
+	}
+
+	if (FirstExecPin)
+	{
+		bIsErrorFree &= CompilerContext.MovePinLinksToIntermediate(*InOutLastActivatedThenPin, *LastThenPin).CanSafeConnect();
+		bIsErrorFree &= Schema->TryCreateConnection(InOutLastActivatedThenPin, FirstExecPin);
+	}
+
+	return bIsErrorFree;
+}
+
 void UK2Node_AsyncAction_ListenForGameplayMessages::RefreshOutputPayloadType()
 {
 	UEdGraphPin* PayloadPin = GetPayloadPin();
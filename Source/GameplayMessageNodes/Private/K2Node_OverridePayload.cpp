@@ -5,9 +5,13 @@
 #include "BlueprintActionDatabaseRegistrar.h"
 #include "BlueprintNodeSpawner.h"
 #include "EdGraphSchema_K2.h"
+#include "Framework/Commands/UIAction.h"
 #include "K2Node_AsyncAction_ListenForGameplayMessages.h"
 #include "K2Node_CallFunction.h"
 #include "KismetCompiler.h"
+#include "Kismet2/BlueprintEditorUtils.h"
+#include "ScopedTransaction.h"
+#include "ToolMenu.h"
 #include "GameFramework/AsyncAction_ListenForGameplayMessage.h"
 
 #define LOCTEXT_NAMESPACE "K2Node_OverridePayload"
@@ -37,6 +41,12 @@ void UK2Node_OverridePayload::ExpandNode(FKismetCompilerContext& CompilerContext
 {
 	Super::ExpandNode(CompilerContext, SourceGraph);
 
+	if (GetContextPin()->SubPins.Num() > 0)
+	{
+		ExpandPayloadMembers(CompilerContext, SourceGraph);
+		return;
+	}
+
 	UK2Node_CallFunction* OverridePayloadNode = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
 	OverridePayloadNode->FunctionReference.SetExternalMember(GET_FUNCTION_NAME_CHECKED(UAsyncAction_ListenForGameplayMessage, OverridePayload), UAsyncAction_ListenForGameplayMessage::StaticClass());
 	OverridePayloadNode->AllocateDefaultPins();
@@ -70,6 +80,79 @@ void UK2Node_OverridePayload::ExpandNode(FKismetCompilerContext& CompilerContext
 	BreakAllNodeLinks();
 }
 
+UK2Node* UK2Node_OverridePayload::ExpandSplitPin(FKismetCompilerContext* CompilerContext, UEdGraph* SourceGraph, UEdGraphPin* Pin)
+{
+	// A split Context pin is expanded into member writes by ExpandPayloadMembers instead of a make struct node,
+	// which would also overwrite the members left unset with their defaults
+	if (Pin == GetContextPin())
+	{
+		return nullptr;
+	}
+
+	return Super::ExpandSplitPin(CompilerContext, SourceGraph, Pin);
+}
+
+void UK2Node_OverridePayload::ExpandPayloadMembers(FKismetCompilerContext& CompilerContext, UEdGraph* SourceGraph)
+{
+	const UEdGraphSchema_K2* Schema = CompilerContext.GetSchema();
+	UEdGraphPin* ContextPin = GetContextPin();
+	UEdGraphPin* ListenerInstancePin = GetListenerInstancePin();
+
+	// Split pins are named <Context>_<Member>
+	const int32 MemberNameOffset = ContextPin->PinName.ToString().Len() + 1;
+	UObject* ContextType = ContextPin->PinType.PinSubCategoryObject.Get();
+
+	UEdGraphPin* LastThenPin = nullptr;
+	for (UEdGraphPin* MemberPin : ContextPin->SubPins)
+	{
+		// Whether a member is written is only told by the skip list, a literal equal to the default is written too
+		if (MemberPin->bHidden || SkippedPayloadMembers.Contains(MemberPin->PinName))
+		{
+			continue;
+		}
+
+		UK2Node_CallFunction* SetMemberNode = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
+		SetMemberNode->FunctionReference.SetExternalMember(GET_FUNCTION_NAME_CHECKED(UAsyncAction_ListenForGameplayMessage, SetPayloadProperty), UAsyncAction_ListenForGameplayMessage::StaticClass());
+		SetMemberNode->AllocateDefaultPins();
+
+		SetMemberNode->FindPinChecked(TEXT("ContextType"))->DefaultObject = ContextType;
+		SetMemberNode->FindPinChecked(TEXT("PropertyName"))->DefaultValue = MemberPin->PinName.ToString().RightChop(MemberNameOffset);
+		CompilerContext.CopyPinLinksToIntermediate(*ListenerInstancePin, *SetMemberNode->FindPinChecked(TEXT("self")));
+
+		UEdGraphPin* SetMemberValuePin = SetMemberNode->FindPinChecked(TEXT("InValue"));
+		SetMemberValuePin->PinType = MemberPin->PinType;
+		CompilerContext.MovePinLinksToIntermediate(*MemberPin, *SetMemberValuePin);
+
+		if (LastThenPin)
+		{
+			Schema->TryCreateConnection(LastThenPin, SetMemberNode->GetExecPin());
+		}
+		else
+		{
+			CompilerContext.MovePinLinksToIntermediate(*GetExecPin(), *SetMemberNode->GetExecPin());
+		}
+		LastThenPin = SetMemberNode->GetThenPin();
+	}
+
+	if (LastThenPin)
+	{
+		CompilerContext.MovePinLinksToIntermediate(*GetThenPin(), *LastThenPin);
+	}
+	else
+	{
+		// Nothing to write, pass the execution straight through
+		for (UEdGraphPin* ExecSourcePin : TArray<UEdGraphPin*>(GetExecPin()->LinkedTo))
+		{
+			for (UEdGraphPin* ThenTargetPin : GetThenPin()->LinkedTo)
+			{
+				Schema->TryCreateConnection(ExecSourcePin, ThenTargetPin);
+			}
+		}
+	}
+
+	BreakAllNodeLinks();
+}
+
 FText UK2Node_OverridePayload::GetNodeTitle(ENodeTitleType::Type TitleType) const
 {
 	return LOCTEXT("NodeTitle", "Override Gameplay Message Payload");
@@ -77,13 +160,82 @@ FText UK2Node_OverridePayload::GetNodeTitle(ENodeTitleType::Type TitleType) cons
 
 FText UK2Node_OverridePayload::GetTooltipText() const
 {
-	return LOCTEXT("NodeTooltip", "Overrides the payload of a Gameplay Message Listener with a new context");
+	return LOCTEXT("NodeTooltip", "Overrides the payload of a Gameplay Message Listener with a new context.\nSplit the Context pin to write its members straight into the payload.\nRight click a member pin to skip it, skipped members keep their value");
+}
+
+void UK2Node_OverridePayload::GetNodeContextMenuActions(UToolMenu* Menu, UGraphNodeContextMenuContext* Context) const
+{
+	Super::GetNodeContextMenuActions(Menu, Context);
+
+	if (Context->bIsDebugging)
+	{
+		return;
+	}
+
+	UK2Node_OverridePayload* MutableThis = const_cast<UK2Node_OverridePayload*>(this);
+	FToolMenuSection& Section = Menu->AddSection("K2NodeOverridePayload", LOCTEXT("OverridePayloadHeader", "Override Payload"));
+
+	if (Context->Pin != nullptr && Context->Pin->ParentPin == GetContextPin())
+	{
+		Section.AddMenuEntry(
+			"SkipPayloadMember",
+			LOCTEXT("SkipPayloadMember", "Skip Member"),
+			LOCTEXT("SkipPayloadMemberTooltip", "Leave this member of the payload untouched and hide its pin"),
+			FSlateIcon(),
+			FUIAction(FExecuteAction::CreateUObject(MutableThis, &UK2Node_OverridePayload::SkipPayloadMember, Context->Pin->PinName)));
+	}
+
+	if (SkippedPayloadMembers.Num() > 0)
+	{
+		Section.AddMenuEntry(
+			"WriteAllPayloadMembers",
+			LOCTEXT("WriteAllPayloadMembers", "Write All Members"),
+			LOCTEXT("WriteAllPayloadMembersTooltip", "Show the skipped member pins again and write every member of the payload"),
+			FSlateIcon(),
+			FUIAction(FExecuteAction::CreateUObject(MutableThis, &UK2Node_OverridePayload::WriteAllPayloadMembers)));
+	}
+}
+
+void UK2Node_OverridePayload::SkipPayloadMember(FName MemberPinName)
+{
+	const FScopedTransaction Transaction(LOCTEXT("SkipPayloadMemberTransaction", "Skip Payload Member"));
+	Modify();
+
+	SkippedPayloadMembers.AddUnique(MemberPinName);
+	if (UEdGraphPin* MemberPin = FindPin(MemberPinName))
+	{
+		MemberPin->BreakAllPinLinks(true);
+	}
+	RefreshSkippedMemberPins();
+
+	FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(GetBlueprint());
+}
+
+void UK2Node_OverridePayload::WriteAllPayloadMembers()
+{
+	const FScopedTransaction Transaction(LOCTEXT("WriteAllPayloadMembersTransaction", "Write All Payload Members"));
+	Modify();
+
+	SkippedPayloadMembers.Reset();
+	RefreshSkippedMemberPins();
+
+	FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(GetBlueprint());
+}
+
+void UK2Node_OverridePayload::RefreshSkippedMemberPins()
+{
+	for (UEdGraphPin* MemberPin : GetContextPin()->SubPins)
+	{
+		MemberPin->bHidden = SkippedPayloadMembers.Contains(MemberPin->PinName);
+	}
+	GetGraph()->NotifyNodeChanged(this);
 }
 
 void UK2Node_OverridePayload::PostReconstructNode()
 {
 	Super::PostReconstructNode();
 	RefreshOutputContentType();
+	RefreshSkippedMemberPins();
 }
 
 void UK2Node_OverridePayload::PinDefaultValueChanged(UEdGraphPin* ChangedPin)
@@ -105,6 +257,7 @@ void UK2Node_OverridePayload::RefreshOutputContentType()
 		{
 			GetSchema()->RecombinePin(ContextPin);
 		}
+		SkippedPayloadMembers.Reset();
 		
 		UScriptStruct* PayloadType = nullptr;
 
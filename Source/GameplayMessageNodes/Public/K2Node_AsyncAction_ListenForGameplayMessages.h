@@ -10,6 +10,7 @@ class FBlueprintActionDatabaseRegistrar;
 class FKismetCompilerContext;
 class FMulticastDelegateProperty;
 class FString;
+class UK2Node_BreakStruct;
 class UEdGraph;
 class UEdGraphPin;
 class UObject;
@@ -49,6 +50,13 @@ private:
 		const FBaseAsyncTaskHelper::FOutputPinAndLocalVariable& ActualChannelVar,
 		UEdGraphPin*& InOutLastActivatedThenPin, UEdGraph* SourceGraph, FKismetCompilerContext& CompilerContext);
 
+	// Read the members used through a split payload pin one by one instead of copying the whole payload
+	bool HandlePayloadMembersImplementation(
+		FMulticastDelegateProperty* CurrentProperty,
+		const FBaseAsyncTaskHelper::FOutputPinAndLocalVariable& ProxyObjectVar,
+		TConstArrayView<UK2Node_BreakStruct*> BreakNodes,
+		UEdGraphPin*& InOutLastActivatedThenPin, UEdGraph* SourceGraph, FKismetCompilerContext& CompilerContext);
+
 	// Make sure the output Payload wildcard matches the input PayloadType 
 	void RefreshOutputPayloadType();
 
@@ -22,8 +22,10 @@ public:
 	virtual FText GetMenuCategory() const override;
 	virtual void GetMenuActions(FBlueprintActionDatabaseRegistrar& ActionRegistrar) const override;
 	virtual void AllocateDefaultPins() override;
+	virtual void GetNodeContextMenuActions(class UToolMenu* Menu, class UGraphNodeContextMenuContext* Context) const override;
 
 	virtual void ExpandNode(class FKismetCompilerContext& CompilerContext, UEdGraph* SourceGraph) override;
+	virtual UK2Node* ExpandSplitPin(class FKismetCompilerContext* CompilerContext, UEdGraph* SourceGraph, UEdGraphPin* Pin) override;
 
 	
 	/**
@@ -33,6 +35,22 @@ public:
 	
 
 private:
+	// Write every shown member of the split Context pin straight into the payload, leaving the skipped ones untouched
+	void ExpandPayloadMembers(class FKismetCompilerContext& CompilerContext, UEdGraph* SourceGraph);
+
+	// Stop writing a member of the split Context pin, its pin is hidden
+	void SkipPayloadMember(FName MemberPinName);
+
+	// Write every member of the split Context pin again
+	void WriteAllPayloadMembers();
+
+	// Hide the member pins listed in SkippedPayloadMembers
+	void RefreshSkippedMemberPins();
+
+	// Member pins of the split Context pin that are not written, the others are written even when they hold their default
+	UPROPERTY()
+	TArray<FName> SkippedPayloadMembers;
+
 	UEdGraphPin* GetListenerInstancePin() const;
 	UEdGraphPin* GetContextPin() const;
 };
@@ -20,6 +20,7 @@ public class GameplayMessageRuntime : ModuleRules
 			new string[]
 			{
 				"CoreUObject",
+				"DeveloperSettings",
 			});
 		
 		DynamicallyLoadedModuleNames.AddRange(
@@ -4,6 +4,7 @@
 
 #include "Engine/Engine.h"
 #include "Engine/World.h"
+#include "GameFramework/GameplayMessageAsyncActionPool.h"
 #include "GameFramework/GameplayMessageSubsystem.h"
 #include "UObject/ScriptMacros.h"
 #include "UObject/Stack.h"
@@ -18,15 +19,7 @@ UAsyncAction_ListenForGameplayMessage* UAsyncAction_ListenForGameplayMessage::Li
 		return nullptr;
 	}
 
-	UAsyncAction_ListenForGameplayMessage* Action = NewObject<UAsyncAction_ListenForGameplayMessage>();
-	Action->WorldPtr = World;
-	Action->ChannelToRegister = Channel;
-	Action->MessageStructType = PayloadType;
-	Action->MessageMatchType = MatchType;
-	Action->Priority = Priority;
-	Action->RegisterWithGameInstance(World);
-
-	return Action;
+	return CreateAction(World, Channel, PayloadType, MatchType, Priority, nullptr);
 }
 
 UAsyncAction_ListenForGameplayMessage* UAsyncAction_ListenForGameplayMessage::ListenForGameplayObjectMessages(UObject* TargetObject, FGameplayTag Channel, UScriptStruct* PayloadType, EGameplayMessageMatch MatchType, EGameplayMessagePriority Priority)
@@ -37,16 +30,7 @@ UAsyncAction_ListenForGameplayMessage* UAsyncAction_ListenForGameplayMessage::Li
 		return nullptr;
 	}
 
-	UAsyncAction_ListenForGameplayMessage* Action = NewObject<UAsyncAction_ListenForGameplayMessage>();
-	Action->WorldPtr = World;
-	Action->ChannelToRegister = Channel;
-	Action->MessageStructType = PayloadType;
-	Action->MessageMatchType = MatchType;
-	Action->Priority = Priority;
-	Action->RegisterWithGameInstance(World);
-	if (IsValid(TargetObject)) Action->TargetObject = TWeakObjectPtr<UObject>(TargetObject);
-
-	return Action;
+	return CreateAction(World, Channel, PayloadType, MatchType, Priority, IsValid(TargetObject) ? TargetObject : nullptr);
 }
 
 UAsyncAction_ListenForGameplayMessage* UAsyncAction_ListenForGameplayMessage::SimpleListenForGameplayMessages(UObject* WorldContextObject, UScriptStruct* PayloadType, EGameplayMessagePriority Priority)
@@ -57,15 +41,7 @@ UAsyncAction_ListenForGameplayMessage* UAsyncAction_ListenForGameplayMessage::Si
 		return nullptr;
 	}
 
-	UAsyncAction_ListenForGameplayMessage* Action = NewObject<UAsyncAction_ListenForGameplayMessage>();
-	Action->WorldPtr = World;
-	Action->ChannelToRegister = UE::GameplayMessageSubsystem::TAG_DefaultMessageChannel;
-	Action->MessageStructType = PayloadType;
-	Action->MessageMatchType = EGameplayMessageMatch::PartialMatch;
-	Action->Priority = Priority;
-	Action->RegisterWithGameInstance(World);
-
-	return Action;
+	return CreateAction(World, UE::GameplayMessageSubsystem::TAG_DefaultMessageChannel, PayloadType, EGameplayMessageMatch::PartialMatch, Priority, nullptr);
 }
 
 UAsyncAction_ListenForGameplayMessage* UAsyncAction_ListenForGameplayMessage::SimpleListenForGameplayObjectMessages(UObject* TargetObject, UScriptStruct* PayloadType, EGameplayMessagePriority Priority)
@@ -76,25 +52,68 @@ UAsyncAction_ListenForGameplayMessage* UAsyncAction_ListenForGameplayMessage::Si
 		return nullptr;
 	}
 
-	UAsyncAction_ListenForGameplayMessage* Action = NewObject<UAsyncAction_ListenForGameplayMessage>();
+	return CreateAction(World, UE::GameplayMessageSubsystem::TAG_DefaultMessageChannel, PayloadType, EGameplayMessageMatch::PartialMatch, Priority, IsValid(TargetObject) ? TargetObject : nullptr);
+}
+
+UAsyncAction_ListenForGameplayMessage* UAsyncAction_ListenForGameplayMessage::CreateAction(UWorld* World, FGameplayTag Channel, UScriptStruct* PayloadType, EGameplayMessageMatch MatchType, EGameplayMessagePriority Priority, UObject* TargetObject)
+{
+	UAsyncAction_ListenForGameplayMessage* Action = nullptr;
+
+	if (UGameplayMessageAsyncActionPool* Pool = UGameplayMessageAsyncActionPool::Get(World))
+	{
+		bool bSameRegistration = false;
+		Action = Pool->Acquire<UAsyncAction_ListenForGameplayMessage>([&](const UAsyncAction_ListenForGameplayMessage& Pooled)
+			{
+				return Pooled.ListenerHandle.IsValid()
+					&& Pooled.WorldPtr == World
+					&& Pooled.ChannelToRegister == Channel
+					&& Pooled.MessageStructType == PayloadType
+					&& Pooled.MessageMatchType == MatchType
+					&& Pooled.Priority == Priority
+					&& Pooled.TargetObject == TargetObject;
+			}, bSameRegistration);
+
+		if (Action)
+		{
+			// The parked registration is kept for identical parameters and picked up again by Activate
+			if (!bSameRegistration)
+			{
+				Action->ListenerHandle.Unregister();
+			}
+			Action->bPooled = false;
+			Action->SetFlags(RF_StrongRefOnFrame);
+		}
+	}
+
+	if (!Action)
+	{
+		Action = NewObject<UAsyncAction_ListenForGameplayMessage>();
+	}
+
 	Action->WorldPtr = World;
-	Action->ChannelToRegister = UE::GameplayMessageSubsystem::TAG_DefaultMessageChannel;
+	Action->ChannelToRegister = Channel;
 	Action->MessageStructType = PayloadType;
-	Action->MessageMatchType = EGameplayMessageMatch::PartialMatch;
+	Action->MessageMatchType = MatchType;
 	Action->Priority = Priority;
+	Action->TargetObject = TargetObject;
 	Action->RegisterWithGameInstance(World);
-	if (IsValid(TargetObject)) Action->TargetObject = TWeakObjectPtr<UObject>(TargetObject);
 
 	return Action;
 }
 
-
 void UAsyncAction_ListenForGameplayMessage::Activate()
 {
 	if (UWorld* World = WorldPtr.Get())
 	{
 		if (UGameplayMessageSubsystem::HasInstance(World))
 		{
+			if (ListenerHandle.IsValid())
+			{
+				// Recycled from the pool along with its registration
+				INC_DWORD_STAT(STAT_GameplayMessages_AsyncActionRegistrationsReused);
+				return;
+			}
+
 			UGameplayMessageSubsystem& Router = UGameplayMessageSubsystem::Get(World);
 
 			TWeakObjectPtr<UAsyncAction_ListenForGameplayMessage> WeakThis(this);
@@ -120,9 +139,24 @@ void UAsyncAction_ListenForGameplayMessage::Activate()
 
 void UAsyncAction_ListenForGameplayMessage::SetReadyToDestroy()
 {
-	ListenerHandle.Unregister();
+	if (bPooled)
+	{
+		return;
+	}
 
 	Super::SetReadyToDestroy();
+
+	// Pooled actions keep their registration parked until they are reused
+	UGameplayMessageAsyncActionPool* Pool = UGameplayMessageAsyncActionPool::Get(WorldPtr.Get());
+	if (Pool && Pool->Release(this))
+	{
+		bPooled = true;
+		OnMessageReceived.Clear();
+	}
+	else
+	{
+		ListenerHandle.Unregister();
+	}
 }
 
 
@@ -179,9 +213,95 @@ DEFINE_FUNCTION(UAsyncAction_ListenForGameplayMessage::execOverridePayload)
 	}
 }
 
+bool UAsyncAction_ListenForGameplayMessage::GetPayloadProperty(FName PropertyName, int32& OutValue)
+{
+	checkNoEntry();
+	return false;
+}
+
+DEFINE_FUNCTION(UAsyncAction_ListenForGameplayMessage::execGetPayloadProperty)
+{
+	P_GET_PROPERTY(FNameProperty, PropertyName);
+
+	Stack.MostRecentPropertyAddress = nullptr;
+	Stack.StepCompiledIn<FProperty>(nullptr);
+	void* ValuePtr = Stack.MostRecentPropertyAddress;
+	FProperty* ValueProp = Stack.MostRecentProperty;
+	P_FINISH;
+
+	bool bSuccess = false;
+
+	const FProperty* MemberProp = (ValuePtr != nullptr) ? P_THIS->FindPayloadProperty(PropertyName, ValueProp) : nullptr;
+	if (MemberProp && (P_THIS->ReceivedMessagePayloadPtr != nullptr))
+	{
+		MemberProp->CopyCompleteValue(ValuePtr, MemberProp->ContainerPtrToValuePtr<void>(P_THIS->ReceivedMessagePayloadPtr));
+		bSuccess = true;
+	}
+
+	*(bool*)RESULT_PARAM = bSuccess;
+}
+
+void UAsyncAction_ListenForGameplayMessage::SetPayloadProperty(const UScriptStruct* ContextType, FName PropertyName, const int32& InValue)
+{
+	// This will never be called, the exec version below will be hit instead
+	checkNoEntry();
+}
+
+DEFINE_FUNCTION(UAsyncAction_ListenForGameplayMessage::execSetPayloadProperty)
+{
+	P_GET_OBJECT(UScriptStruct, ContextType);
+	P_GET_PROPERTY(FNameProperty, PropertyName);
+
+	// The step writes a literal to the storage it is given and copies a variable into it, like the array library does
+	// for its wildcard items. The value was compiled against the Context struct's member, not the payload received,
+	// and a member removed since falls back to storage the size of the whole struct
+	const FProperty* ValueMember = ContextType ? ContextType->FindPropertyByName(PropertyName) : nullptr;
+	const int32 StorageSize = ValueMember ? ValueMember->GetSize() : (ContextType ? ContextType->GetStructureSize() : 0);
+	const int32 StorageAlignment = ValueMember ? ValueMember->GetMinAlignment() : (ContextType ? ContextType->GetMinAlignment() : 1);
+	void* StorageSpace = FMemory_Alloca_Aligned(FMath::Max(StorageSize, 1), StorageAlignment);
+	if (ValueMember)
+	{
+		ValueMember->InitializeValue(StorageSpace);
+	}
+	else
+	{
+		FMemory::Memzero(StorageSpace, StorageSize);
+	}
+
+	Stack.MostRecentPropertyAddress = nullptr;
+	Stack.StepCompiledIn<FProperty>(StorageSpace);
+	void* ValuePtr = (Stack.MostRecentPropertyAddress != nullptr) ? Stack.MostRecentPropertyAddress : StorageSpace;
+	FProperty* ValueProp = Stack.MostRecentProperty;
+	P_FINISH;
+
+	if (ValueMember)
+	{
+		// Payloads of a child type keep the listened type's layout, a Context of any other type does not
+		if (P_THIS->ReceivedMessagePayloadPtr && ContextType == P_THIS->MessageStructType.Get() && (!ValueProp || ValueMember->SameType(ValueProp)))
+		{
+			ValueMember->CopyCompleteValue(ValueMember->ContainerPtrToValuePtr<void>(P_THIS->ReceivedMessagePayloadPtr), ValuePtr);
+		}
+
+		ValueMember->DestroyValue(StorageSpace);
+	}
+}
+
+const FProperty* UAsyncAction_ListenForGameplayMessage::FindPayloadProperty(FName PropertyName, const FProperty* ValueProperty) const
+{
+	const UScriptStruct* StructType = MessageStructType.Get();
+	const FProperty* MemberProp = StructType ? StructType->FindPropertyByName(PropertyName) : nullptr;
+	return (MemberProp && ValueProperty && MemberProp->SameType(ValueProperty)) ? MemberProp : nullptr;
+}
+
 void UAsyncAction_ListenForGameplayMessage::HandleMessageReceived(FGameplayTag Channel, const UScriptStruct* StructType, void* Payload)
 {
-	if (!MessageStructType.Get() || (MessageStructType.Get() == StructType))
+	if (bPooled)
+	{
+		return;
+	}
+
+	// Messages of a child struct type are delivered too, GetPayload copies their MessageStructType part
+	if (!MessageStructType.Get() || StructType->IsChildOf(MessageStructType.Get()))
 	{
 		ReceivedMessagePayloadPtr = Payload;
 
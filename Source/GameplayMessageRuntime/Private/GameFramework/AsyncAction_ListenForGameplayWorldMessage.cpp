@@ -4,6 +4,8 @@
 
 #include "Engine/Engine.h"
 #include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/GameplayMessageAsyncActionPool.h"
 #include "GameFramework/GameplayWorldMessageSubsystem.h"
 #include "UObject/ScriptMacros.h"
 #include "UObject/Stack.h"
@@ -18,17 +20,18 @@ UAsyncAction_ListenForGameplayWorldMessage* UAsyncAction_ListenForGameplayWorldM
 		return nullptr;
 	}
 
-	UAsyncAction_ListenForGameplayWorldMessage* Action = NewObject<UAsyncAction_ListenForGameplayWorldMessage>();
-	Action->WorldPtr = World;
-	Action->ChannelToRegister = Channel;
-	Action->MessageStructType = PayloadType;
-	Action->MessageMatchType = MatchType;
-	Action->Priority = Priority;
-	Action->ListenPosition = ListenPosition;
-	Action->ListenRadius = ListenRadius;
-	Action->RegisterWithGameInstance(World);
+	return CreateAction(World, Channel, PayloadType, MatchType, Priority, ListenPosition, ListenRadius, nullptr, 0.0f);
+}
 
-	return Action;
+UAsyncAction_ListenForGameplayWorldMessage* UAsyncAction_ListenForGameplayWorldMessage::ListenForGameplayWorldMessagesAroundActor(UObject* WorldContextObject, FGameplayTag Channel, UScriptStruct* PayloadType, AActor* FollowActor, float ListenRadius, float MoveThreshold, EGameplayMessageMatch MatchType, EGameplayMessagePriority Priority)
+{
+	UWorld* World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull);
+	if (!World || !FollowActor)
+	{
+		return nullptr;
+	}
+
+	return CreateAction(World, Channel, PayloadType, MatchType, Priority, FollowActor->GetActorLocation(), ListenRadius, FollowActor, MoveThreshold);
 }
 
 UAsyncAction_ListenForGameplayWorldMessage* UAsyncAction_ListenForGameplayWorldMessage::SimpleListenForGameplayWorldMessages(UObject* WorldContextObject, UScriptStruct* PayloadType, FVector ListenPosition, float ListenRadius, EGameplayMessagePriority Priority)
@@ -39,14 +42,52 @@ UAsyncAction_ListenForGameplayWorldMessage* UAsyncAction_ListenForGameplayWorldM
 		return nullptr;
 	}
 
-	UAsyncAction_ListenForGameplayWorldMessage* Action = NewObject<UAsyncAction_ListenForGameplayWorldMessage>();
+	return CreateAction(World, UE::GameplayWorldMessageSubsystem::TAG_DefaultMessageChannel, PayloadType, EGameplayMessageMatch::PartialMatch, Priority, ListenPosition, ListenRadius, nullptr, 0.0f);
+}
+
+UAsyncAction_ListenForGameplayWorldMessage* UAsyncAction_ListenForGameplayWorldMessage::CreateAction(UWorld* World, FGameplayTag Channel, UScriptStruct* PayloadType, EGameplayMessageMatch MatchType, EGameplayMessagePriority Priority, const FVector& ListenPosition, float ListenRadius, AActor* FollowActor, float MoveThreshold)
+{
+	UAsyncAction_ListenForGameplayWorldMessage* Action = nullptr;
+
+	if (UGameplayMessageAsyncActionPool* Pool = UGameplayMessageAsyncActionPool::Get(World))
+	{
+		// The location is not part of the registration, a reused one is relocated by Activate
+		bool bSameRegistration = false;
+		Action = Pool->Acquire<UAsyncAction_ListenForGameplayWorldMessage>([&](const UAsyncAction_ListenForGameplayWorldMessage& Pooled)
+			{
+				return Pooled.ListenerHandle.IsValid()
+					&& Pooled.WorldPtr == World
+					&& Pooled.ChannelToRegister == Channel
+					&& Pooled.MessageStructType == PayloadType
+					&& Pooled.MessageMatchType == MatchType
+					&& Pooled.Priority == Priority;
+			}, bSameRegistration);
+
+		if (Action)
+		{
+			if (!bSameRegistration)
+			{
+				Action->ListenerHandle.Unregister();
+			}
+			Action->bPooled = false;
+			Action->SetFlags(RF_StrongRefOnFrame);
+		}
+	}
+
+	if (!Action)
+	{
+		Action = NewObject<UAsyncAction_ListenForGameplayWorldMessage>();
+	}
+
 	Action->WorldPtr = World;
-	Action->ChannelToRegister = UE::GameplayWorldMessageSubsystem::TAG_DefaultMessageChannel;
+	Action->ChannelToRegister = Channel;
 	Action->MessageStructType = PayloadType;
-	Action->MessageMatchType = EGameplayMessageMatch::PartialMatch;
+	Action->MessageMatchType = MatchType;
 	Action->Priority = Priority;
 	Action->ListenPosition = ListenPosition;
 	Action->ListenRadius = ListenRadius;
+	Action->FollowActor = FollowActor;
+	Action->FollowMoveThreshold = MoveThreshold;
 	Action->RegisterWithGameInstance(World);
 
 	return Action;
@@ -60,6 +101,19 @@ void UAsyncAction_ListenForGameplayWorldMessage::Activate()
 		{
 			UGameplayWorldMessageSubsystem& Router = UGameplayWorldMessageSubsystem::Get(World);
 
+			// Recycled from the pool along with its registration, only its location has to change
+			if (ListenerHandle.IsValid() && Router.UpdateRegisterListenerLocation(ListenerHandle, ListenPosition, ListenRadius))
+			{
+				INC_DWORD_STAT(STAT_GameplayMessages_AsyncActionRegistrationsReused);
+
+				if (const AActor* Actor = FollowActor.Get())
+				{
+					Router.SetListenerFollowActor(ListenerHandle, Actor, FollowMoveThreshold);
+				}
+
+				return;
+			}
+
 			TWeakObjectPtr<UAsyncAction_ListenForGameplayWorldMessage> WeakThis(this);
 			ListenerHandle = Router.RegisterListenerInternal(ChannelToRegister,
 				[WeakThis](FGameplayTag Channel, const UScriptStruct* StructType, void* Payload)
@@ -75,6 +129,11 @@ void UAsyncAction_ListenForGameplayWorldMessage::Activate()
 				ListenPosition,
 				ListenRadius);
 
+			if (const AActor* Actor = FollowActor.Get())
+			{
+				Router.SetListenerFollowActor(ListenerHandle, Actor, FollowMoveThreshold);
+			}
+
 			return;
 		}
 	}
@@ -84,9 +143,31 @@ void UAsyncAction_ListenForGameplayWorldMessage::Activate()
 
 void UAsyncAction_ListenForGameplayWorldMessage::SetReadyToDestroy()
 {
-	ListenerHandle.Unregister();
+	if (bPooled)
+	{
+		return;
+	}
 
 	Super::SetReadyToDestroy();
+
+	// Pooled actions keep their registration parked where it is until they are reused
+	UWorld* World = WorldPtr.Get();
+	UGameplayMessageAsyncActionPool* Pool = UGameplayMessageAsyncActionPool::Get(World);
+	if (Pool && Pool->Release(this))
+	{
+		bPooled = true;
+		OnMessageReceived.Clear();
+
+		if (FollowActor.IsValid() && UGameplayWorldMessageSubsystem::HasInstance(World))
+		{
+			UGameplayWorldMessageSubsystem::Get(World).SetListenerFollowComponent(ListenerHandle, nullptr);
+		}
+		FollowActor.Reset();
+	}
+	else
+	{
+		ListenerHandle.Unregister();
+	}
 }
 
 bool UAsyncAction_ListenForGameplayWorldMessage::GetPayload(int32& OutPayload)
@@ -143,7 +224,13 @@ DEFINE_FUNCTION(UAsyncAction_ListenForGameplayWorldMessage::execOverridePayload)
 
 void UAsyncAction_ListenForGameplayWorldMessage::HandleMessageReceived(FGameplayTag Channel, const UScriptStruct* StructType, void* Payload)
 {
-	if (!MessageStructType.Get() || (MessageStructType.Get() == StructType))
+	if (bPooled)
+	{
+		return;
+	}
+
+	// Messages of a child struct type are delivered too, GetPayload copies their MessageStructType part
+	if (!MessageStructType.Get() || StructType->IsChildOf(MessageStructType.Get()))
 	{
 		ReceivedMessagePayloadPtr = Payload;
 
@@ -0,0 +1,60 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "GameFramework/GameplayMessageAsyncActionPool.h"
+
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(GameplayMessageAsyncActionPool)
+
+namespace UE::GameplayMessageAsyncActionPool
+{
+	static bool bEnabled = false;
+	static FAutoConsoleVariableRef CVarEnabled(TEXT("GameplayMessages.AsyncActionPool.Enabled"),
+		bEnabled,
+		TEXT("Reuse cancelled listen async actions, and their router registration, instead of creating new ones"));
+
+	static int32 MaxSize = 256;
+	static FAutoConsoleVariableRef CVarMaxSize(TEXT("GameplayMessages.AsyncActionPool.MaxSize"),
+		MaxSize,
+		TEXT("Maximum number of cancelled listen async actions kept per game instance"));
+}
+
+void UGameplayMessageAsyncActionPool::Deinitialize()
+{
+	DEC_DWORD_STAT_BY(STAT_GameplayMessages_AsyncActionsPooled, FreeActions.Num());
+	FreeActions.Empty();
+
+	Super::Deinitialize();
+}
+
+UGameplayMessageAsyncActionPool* UGameplayMessageAsyncActionPool::Get(const UWorld* World)
+{
+	if (IsEnabled() && World)
+	{
+		if (const UGameInstance* GameInstance = World->GetGameInstance())
+		{
+			return GameInstance->GetSubsystem<UGameplayMessageAsyncActionPool>();
+		}
+	}
+	return nullptr;
+}
+
+bool UGameplayMessageAsyncActionPool::IsEnabled()
+{
+	return UE::GameplayMessageAsyncActionPool::bEnabled;
+}
+
+bool UGameplayMessageAsyncActionPool::Release(UCancellableAsyncAction* Action)
+{
+	if (!IsEnabled() || !IsValid(Action) || FreeActions.Num() >= UE::GameplayMessageAsyncActionPool::MaxSize)
+	{
+		return false;
+	}
+
+	checkSlow(!FreeActions.Contains(Action));
+	FreeActions.Add(Action);
+	INC_DWORD_STAT(STAT_GameplayMessages_AsyncActionsPooled);
+	return true;
+}
@@ -0,0 +1,476 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "GameFramework/GameplayMessageCapture.h"
+
+#include "Containers/Ticker.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "GameFramework/GameplayMessageSubsystem.h"
+#include "GameFramework/GameplayWorldMessageSubsystem.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/ObjectAndNameAsStringProxyArchive.h"
+#include "UObject/StructOnScope.h"
+
+namespace UE::GameplayMessageCapture
+{
+	static constexpr uint32 FileMagic = 0x50434D47; // "GMCP"
+	static constexpr int32 FileVersion = 2;
+
+	static int32 BufferSizeKB = 4096;
+	static FAutoConsoleVariableRef CVarBufferSizeKB(TEXT("GameplayMessages.Capture.BufferSizeKB"),
+		BufferSizeKB,
+		TEXT("Size of the message capture ring buffer in KB, changing it clears the buffer"));
+
+	static bool bDumpOnEnsure = true;
+	static FAutoConsoleVariableRef CVarDumpOnEnsure(TEXT("GameplayMessages.Capture.DumpOnEnsure"),
+		bDumpOnEnsure,
+		TEXT("Dump the message capture to disk when an ensure fires"));
+
+	// Record header, the payload follows as PayloadSize bytes. Point broadcasts leave the area extent out.
+	static void SerializeRecordHeader(FArchive& Ar, double& Time, uint8& Router, FName& ChannelName, FString& StructPath, FString& TargetPath, FVector& WorldPosition, uint8& Shape, FVector& AreaExtent)
+	{
+		Ar << Time;
+		Ar << Router;
+		Ar << ChannelName;
+		Ar << StructPath;
+		Ar << TargetPath;
+		Ar << WorldPosition;
+		Ar << Shape;
+		if (Shape != static_cast<uint8>(EGameplayMessageCaptureShape::Point))
+		{
+			Ar << AreaExtent;
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////
+// FGameplayMessageCapture
+
+bool FGameplayMessageCapture::bEnabled = false;
+bool FGameplayMessageCapture::bSuppressed = false;
+
+FAutoConsoleVariableRef FGameplayMessageCapture::CVarEnabled(TEXT("GameplayMessages.Capture.Enabled"),
+	FGameplayMessageCapture::bEnabled,
+	TEXT("Record every broadcast of the message routers into the capture ring buffer"));
+
+FGameplayMessageCapture& FGameplayMessageCapture::Get()
+{
+	static FGameplayMessageCapture Instance;
+	return Instance;
+}
+
+FGameplayMessageCapture::FGameplayMessageCapture()
+{
+	FCoreDelegates::OnHandleSystemEnsure.AddRaw(this, &FGameplayMessageCapture::HandleSystemEnsure);
+}
+
+void FGameplayMessageCapture::Record(EGameplayMessageCaptureRouter Router, FGameplayTag Channel, const UScriptStruct* StructType, const void* MessageBytes, const UObject* TargetObject, const FVector& WorldPosition,
+	EGameplayMessageCaptureShape Shape, const FVector& AreaExtent)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	const int32 Capacity = FMath::Max(UE::GameplayMessageCapture::BufferSizeKB, 1) * 1024;
+	if (Buffer.Num() != Capacity)
+	{
+		Buffer.SetNumUninitialized(Capacity);
+		ReadOffset = 0;
+		UsedBytes = 0;
+		NumRecords = 0;
+	}
+
+	FString* pStructPath = StructPaths.Find(StructType);
+	if (!pStructPath)
+	{
+		pStructPath = &StructPaths.Add(StructType, StructType->GetPathName());
+	}
+
+	double Time = FPlatformTime::Seconds() - GStartTime;
+	uint8 RouterValue = static_cast<uint8>(Router);
+	FName ChannelName = Channel.GetTagName();
+	FString TargetPath = TargetObject ? TargetObject->GetPathName() : FString();
+	FVector Position = WorldPosition;
+	uint8 ShapeValue = static_cast<uint8>(Shape);
+	FVector Extent = AreaExtent;
+
+	Scratch.Reset();
+	FMemoryWriter Writer(Scratch);
+	FObjectAndNameAsStringProxyArchive Ar(Writer, /*bInLoadIfFindFails=*/ false);
+	UE::GameplayMessageCapture::SerializeRecordHeader(Ar, Time, RouterValue, ChannelName, *pStructPath, TargetPath, Position, ShapeValue, Extent);
+
+	// Size prefixed so a capture can be read back without the struct being loaded
+	const int64 PayloadSizeOffset = Ar.Tell();
+	int32 PayloadSize = 0;
+	Ar << PayloadSize;
+	const_cast<UScriptStruct*>(StructType)->SerializeItem(Ar, const_cast<void*>(MessageBytes), /*Defaults=*/ nullptr);
+	const int64 PayloadEnd = Ar.Tell();
+	PayloadSize = static_cast<int32>(PayloadEnd - PayloadSizeOffset - sizeof(int32));
+	Ar.Seek(PayloadSizeOffset);
+	Ar << PayloadSize;
+	Ar.Seek(PayloadEnd);
+
+	uint32 RecordSize = Scratch.Num();
+	const int32 TotalSize = sizeof(uint32) + Scratch.Num();
+	if (TotalSize > Capacity)
+	{
+		return;
+	}
+
+	while (Capacity - UsedBytes < TotalSize)
+	{
+		DropOldestRecord();
+	}
+
+	const int32 WriteOffset = (ReadOffset + UsedBytes) % Capacity;
+	WriteBytes(WriteOffset, &RecordSize, sizeof(uint32));
+	WriteBytes((WriteOffset + sizeof(uint32)) % Capacity, Scratch.GetData(), Scratch.Num());
+	UsedBytes += TotalSize;
+	++NumRecords;
+}
+
+FString FGameplayMessageCapture::Dump(const FString& Filename)
+{
+	TArray<uint8> FileData;
+	{
+		FScopeLock Lock(&CriticalSection);
+		if (NumRecords == 0)
+		{
+			return FString();
+		}
+
+		FMemoryWriter Writer(FileData);
+		uint32 Magic = UE::GameplayMessageCapture::FileMagic;
+		int32 Version = UE::GameplayMessageCapture::FileVersion;
+		int32 RecordCount = NumRecords;
+		Writer << Magic << Version << RecordCount;
+
+		// Unwrap the ring, records keep their [Size][bytes] layout
+		const int32 HeaderSize = FileData.Num();
+		FileData.AddUninitialized(UsedBytes);
+		ReadBytes(ReadOffset, FileData.GetData() + HeaderSize, UsedBytes);
+	}
+
+	const FString OutFilename = !Filename.IsEmpty() ? Filename
+		: FPaths::ProfilingDir() / TEXT("GameplayMessages") / FString::Printf(TEXT("Capture-%s.gmcap"), *FDateTime::Now().ToString());
+	if (!FFileHelper::SaveArrayToFile(FileData, *OutFilename))
+	{
+		UE_LOG(LogGameplayMessageSubsystem, Error, TEXT("Failed to write message capture to %s"), *OutFilename);
+		return FString();
+	}
+
+	return OutFilename;
+}
+
+void FGameplayMessageCapture::Reset()
+{
+	FScopeLock Lock(&CriticalSection);
+	ReadOffset = 0;
+	UsedBytes = 0;
+	NumRecords = 0;
+}
+
+int32 FGameplayMessageCapture::Num() const
+{
+	FScopeLock Lock(&CriticalSection);
+	return NumRecords;
+}
+
+bool FGameplayMessageCapture::Load(const FString& Filename, TArray<FGameplayMessageCaptureRecord>& OutRecords)
+{
+	TArray<uint8> FileData;
+	if (!FFileHelper::LoadFileToArray(FileData, *Filename))
+	{
+		UE_LOG(LogGameplayMessageSubsystem, Error, TEXT("Failed to read message capture %s"), *Filename);
+		return false;
+	}
+
+	FMemoryReader Reader(FileData);
+	uint32 Magic = 0;
+	int32 Version = 0;
+	int32 RecordCount = 0;
+	Reader << Magic << Version << RecordCount;
+	if (Magic != UE::GameplayMessageCapture::FileMagic || Version != UE::GameplayMessageCapture::FileVersion || RecordCount < 0)
+	{
+		UE_LOG(LogGameplayMessageSubsystem, Error, TEXT("%s is not a message capture of version %d"), *Filename, UE::GameplayMessageCapture::FileVersion);
+		return false;
+	}
+
+	OutRecords.Reset(RecordCount);
+	for (int32 Index = 0; Index < RecordCount; ++Index)
+	{
+		uint32 RecordSize = 0;
+		Reader << RecordSize;
+		if (Reader.IsError() || Reader.Tell() + RecordSize > Reader.TotalSize())
+		{
+			UE_LOG(LogGameplayMessageSubsystem, Error, TEXT("Message capture %s is truncated after %d records"), *Filename, Index);
+			return false;
+		}
+
+		const int64 RecordStart = Reader.Tell();
+		FObjectAndNameAsStringProxyArchive Ar(Reader, /*bInLoadIfFindFails=*/ false);
+
+		FGameplayMessageCaptureRecord& Record = OutRecords.AddDefaulted_GetRef();
+		uint8 RouterValue = 0;
+		uint8 ShapeValue = 0;
+		FName ChannelName;
+		UE::GameplayMessageCapture::SerializeRecordHeader(Ar, Record.Time, RouterValue, ChannelName, Record.StructPath, Record.TargetPath, Record.WorldPosition, ShapeValue, Record.AreaExtent);
+		Record.Router = static_cast<EGameplayMessageCaptureRouter>(RouterValue);
+		Record.Shape = static_cast<EGameplayMessageCaptureShape>(ShapeValue);
+		Record.Channel = FGameplayTag::RequestGameplayTag(ChannelName, /*ErrorIfNotFound=*/ false);
+
+		int32 PayloadSize = 0;
+		Ar << PayloadSize;
+		if (PayloadSize < 0 || Reader.Tell() + PayloadSize > RecordStart + RecordSize)
+		{
+			UE_LOG(LogGameplayMessageSubsystem, Error, TEXT("Message capture %s has a corrupt record %d"), *Filename, Index);
+			return false;
+		}
+
+		Record.Payload.SetNumUninitialized(PayloadSize);
+		Reader.Serialize(Record.Payload.GetData(), PayloadSize);
+		Reader.Seek(RecordStart + RecordSize);
+	}
+
+	return !Reader.IsError();
+}
+
+void FGameplayMessageCapture::HandleSystemEnsure()
+{
+	if (UE::GameplayMessageCapture::bDumpOnEnsure && bEnabled)
+	{
+		const FString Filename = Dump();
+		if (!Filename.IsEmpty())
+		{
+			UE_LOG(LogGameplayMessageSubsystem, Warning, TEXT("Ensure fired, message capture written to %s"), *Filename);
+		}
+	}
+}
+
+void FGameplayMessageCapture::WriteBytes(int32 Offset, const void* Data, int32 NumBytes)
+{
+	const int32 FirstPart = FMath::Min(NumBytes, Buffer.Num() - Offset);
+	FMemory::Memcpy(Buffer.GetData() + Offset, Data, FirstPart);
+	FMemory::Memcpy(Buffer.GetData(), static_cast<const uint8*>(Data) + FirstPart, NumBytes - FirstPart);
+}
+
+void FGameplayMessageCapture::ReadBytes(int32 Offset, void* Data, int32 NumBytes) const
+{
+	const int32 FirstPart = FMath::Min(NumBytes, Buffer.Num() - Offset);
+	FMemory::Memcpy(Data, Buffer.GetData() + Offset, FirstPart);
+	FMemory::Memcpy(static_cast<uint8*>(Data) + FirstPart, Buffer.GetData(), NumBytes - FirstPart);
+}
+
+void FGameplayMessageCapture::DropOldestRecord()
+{
+	uint32 RecordSize = 0;
+	ReadBytes(ReadOffset, &RecordSize, sizeof(uint32));
+
+	const int32 TotalSize = sizeof(uint32) + RecordSize;
+	ReadOffset = (ReadOffset + TotalSize) % Buffer.Num();
+	UsedBytes -= TotalSize;
+	--NumRecords;
+}
+
+//////////////////////////////////////////////////////////////////////
+// FGameplayMessageReplay
+
+namespace UE::GameplayMessageCapture
+{
+	struct FTimedReplay
+	{
+		TWeakObjectPtr<UWorld> World;
+		TArray<FGameplayMessageCaptureRecord> Records;
+		int32 NextRecord = 0;
+		double StartSeconds = 0.0;
+		float Rate = 1.0f;
+		FTSTicker::FDelegateHandle TickerHandle;
+	};
+
+	static FTimedReplay TimedReplay;
+
+	static bool TickTimedReplay(float DeltaTime)
+	{
+		UWorld* World = TimedReplay.World.Get();
+		if (!World || !TimedReplay.Records.IsValidIndex(TimedReplay.NextRecord))
+		{
+			UE_LOG(LogGameplayMessageSubsystem, Log, TEXT("Message replay finished after %d records"), TimedReplay.NextRecord);
+			TimedReplay.Records.Empty();
+			TimedReplay.TickerHandle.Reset();
+			return false;
+		}
+
+		const double CaptureStart = TimedReplay.Records[0].Time;
+		const double Elapsed = (FPlatformTime::Seconds() - TimedReplay.StartSeconds) * TimedReplay.Rate;
+		while (TimedReplay.Records.IsValidIndex(TimedReplay.NextRecord) && TimedReplay.Records[TimedReplay.NextRecord].Time - CaptureStart <= Elapsed)
+		{
+			FGameplayMessageReplay::Broadcast(World, TimedReplay.Records[TimedReplay.NextRecord++]);
+		}
+
+		return true;
+	}
+
+	static void LoadAndReplay(const TArray<FString>& Args, UWorld* World)
+	{
+		if (Args.Num() == 0 || !World)
+		{
+			UE_LOG(LogGameplayMessageSubsystem, Warning, TEXT("Usage: GameplayMessages.Replay <File> [Rate=1.0] [Immediate]"));
+			return;
+		}
+
+		TArray<FGameplayMessageCaptureRecord> Records;
+		if (!FGameplayMessageCapture::Load(Args[0], Records))
+		{
+			return;
+		}
+
+		const FString Options = FString::Join(Args, TEXT(" "));
+		if (Options.Contains(TEXT("Immediate")))
+		{
+			const double StartSeconds = FPlatformTime::Seconds();
+			const int32 NumBroadcast = FGameplayMessageReplay::ReplayImmediate(World, Records);
+			UE_LOG(LogGameplayMessageSubsystem, Log, TEXT("Replayed %d of %d messages in %.3f ms"), NumBroadcast, Records.Num(), (FPlatformTime::Seconds() - StartSeconds) * 1000.0);
+			return;
+		}
+
+		float Rate = 1.0f;
+		FParse::Value(*Options, TEXT("Rate="), Rate);
+		FGameplayMessageReplay::StartTimed(World, MoveTemp(Records), Rate);
+	}
+
+	static FAutoConsoleCommand CmdDumpCapture(TEXT("GameplayMessages.Capture.Dump"),
+		TEXT("Write the message capture ring buffer to disk. Usage: GameplayMessages.Capture.Dump [Filename]"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			const FString Filename = FGameplayMessageCapture::Get().Dump(Args.Num() > 0 ? Args[0] : FString());
+			if (Filename.IsEmpty())
+			{
+				UE_LOG(LogGameplayMessageSubsystem, Warning, TEXT("No message capture written, is GameplayMessages.Capture.Enabled set?"));
+				return;
+			}
+
+			UE_LOG(LogGameplayMessageSubsystem, Log, TEXT("Message capture written to %s"), *Filename);
+		}));
+
+	static FAutoConsoleCommand CmdClearCapture(TEXT("GameplayMessages.Capture.Clear"),
+		TEXT("Drop every message recorded in the capture ring buffer"),
+		FConsoleCommandDelegate::CreateLambda([]() { FGameplayMessageCapture::Get().Reset(); }));
+
+	static FAutoConsoleCommandWithWorldAndArgs CmdReplay(TEXT("GameplayMessages.Replay"),
+		TEXT("Re-broadcast a message capture through the routers of the current world.\n")
+		TEXT("Usage: GameplayMessages.Replay <File> [Rate=1.0] [Immediate]. Immediate broadcasts every message within the frame."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&LoadAndReplay));
+
+	static FAutoConsoleCommand CmdStopReplay(TEXT("GameplayMessages.Replay.Stop"),
+		TEXT("Stop the running timed message replay"),
+		FConsoleCommandDelegate::CreateStatic(&FGameplayMessageReplay::Stop));
+}
+
+bool FGameplayMessageReplay::Broadcast(UWorld* World, const FGameplayMessageCaptureRecord& Record)
+{
+	return Broadcast(UGameInstance::GetSubsystem<UGameplayMessageSubsystem>(World->GetGameInstance()), World->GetSubsystem<UGameplayWorldMessageSubsystem>(), Record);
+}
+
+bool FGameplayMessageReplay::Broadcast(UGameplayMessageSubsystem* GlobalRouter, UGameplayWorldMessageSubsystem* WorldRouter, const FGameplayMessageCaptureRecord& Record)
+{
+	const UScriptStruct* StructType = FindObject<UScriptStruct>(nullptr, *Record.StructPath);
+	if (!StructType || !Record.Channel.IsValid())
+	{
+		UE_LOG(LogGameplayMessageSubsystem, Verbose, TEXT("Skipping replayed message %s on %s, struct or channel not found"), *Record.StructPath, *Record.Channel.ToString());
+		return false;
+	}
+
+	FStructOnScope Payload(StructType);
+	{
+		FMemoryReader Reader(Record.Payload);
+		FObjectAndNameAsStringProxyArchive Ar(Reader, /*bInLoadIfFindFails=*/ false);
+		const_cast<UScriptStruct*>(StructType)->SerializeItem(Ar, Payload.GetStructMemory(), /*Defaults=*/ nullptr);
+	}
+
+	TGuardValue<bool> SuppressGuard(FGameplayMessageCapture::bSuppressed, true);
+
+	if (Record.Router == EGameplayMessageCaptureRouter::World)
+	{
+		if (!WorldRouter)
+		{
+			return false;
+		}
+
+		switch (Record.Shape)
+		{
+		case EGameplayMessageCaptureShape::Sphere:
+			WorldRouter->BroadcastMessageInAreaInternal(Record.Channel, StructType, Payload.GetStructMemory(), UGameplayWorldMessageSubsystem::FBroadcastArea(FSphere(Record.WorldPosition, Record.AreaExtent.X)));
+			break;
+		case EGameplayMessageCaptureShape::Box:
+			WorldRouter->BroadcastMessageInAreaInternal(Record.Channel, StructType, Payload.GetStructMemory(), UGameplayWorldMessageSubsystem::FBroadcastArea(FBox::BuildAABB(Record.WorldPosition, Record.AreaExtent)));
+			break;
+		default:
+			WorldRouter->BroadcastMessageInternal(Record.Channel, StructType, Payload.GetStructMemory(), Record.WorldPosition);
+			break;
+		}
+		return true;
+	}
+
+	if (!GlobalRouter)
+	{
+		return false;
+	}
+
+	// A target that no longer exists only leaves the untargeted listeners to reach
+	UObject* TargetObject = !Record.TargetPath.IsEmpty() ? StaticFindObject(UObject::StaticClass(), nullptr, *Record.TargetPath) : nullptr;
+	GlobalRouter->BroadcastMessageInternal(Record.Channel, StructType, Payload.GetStructMemory(), TargetObject);
+	return true;
+}
+
+int32 FGameplayMessageReplay::ReplayImmediate(UWorld* World, TConstArrayView<FGameplayMessageCaptureRecord> Records)
+{
+	int32 NumBroadcast = 0;
+	for (const FGameplayMessageCaptureRecord& Record : Records)
+	{
+		NumBroadcast += Broadcast(World, Record) ? 1 : 0;
+	}
+
+	return NumBroadcast;
+}
+
+void FGameplayMessageReplay::StartTimed(UWorld* World, TArray<FGameplayMessageCaptureRecord>&& Records, float Rate)
+{
+	using namespace UE::GameplayMessageCapture;
+
+	Stop();
+
+	if (Records.Num() == 0)
+	{
+		return;
+	}
+
+	TimedReplay.World = World;
+	TimedReplay.Records = MoveTemp(Records);
+	TimedReplay.NextRecord = 0;
+	TimedReplay.StartSeconds = FPlatformTime::Seconds();
+	TimedReplay.Rate = Rate > 0.0f ? Rate : 1.0f;
+	TimedReplay.TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&TickTimedReplay));
+}
+
+void FGameplayMessageReplay::Stop()
+{
+	using namespace UE::GameplayMessageCapture;
+
+	if (TimedReplay.TickerHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(TimedReplay.TickerHandle);
+		TimedReplay.TickerHandle.Reset();
+	}
+
+	TimedReplay.Records.Empty();
+	TimedReplay.NextRecord = 0;
+}
+
+bool FGameplayMessageReplay::IsReplaying()
+{
+	return UE::GameplayMessageCapture::TimedReplay.TickerHandle.IsValid();
+}
@@ -0,0 +1,175 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "GameFramework/GameplayMessageQueue.h"
+
+#include "Algo/StableSort.h"
+#include "UObject/Class.h"
+
+FGameplayMessageQueue::~FGameplayMessageQueue()
+{
+	Reset();
+}
+
+FQueuedGameplayMessage& FGameplayMessageQueue::Enqueue(const UScriptStruct* StructType, const void* MessageBytes, FGameplayTag Channel)
+{
+	check(StructType && MessageBytes);
+
+	void* Payload = Arena.Alloc(FMath::Max(StructType->GetStructureSize(), 1), StructType->GetMinAlignment());
+	StructType->InitializeStruct(Payload);
+	StructType->CopyScriptStruct(Payload, MessageBytes);
+
+	FQueuedGameplayMessage& Message = Messages.AddDefaulted_GetRef();
+	Message.StructType = StructType;
+	Message.Payload = Payload;
+	Message.Channel = Channel;
+	++NumEnqueued;
+	return Message;
+}
+
+FQueuedGameplayMessage& FGameplayMessageQueue::EnqueueCoalesced(const UScriptStruct* StructType, const void* MessageBytes, FGameplayTag Channel, TWeakObjectPtr<UObject> TargetObject, FGameplayMessageQueuedCallback&& OnComplete)
+{
+	const FCoalesceKey Key{ StructType, Channel, TargetObject };
+	if (const int32* ExistingIndex = CoalescedMessages.Find(Key))
+	{
+		// Last value wins, the message keeps its place in the queue
+		FQueuedGameplayMessage& Message = Messages[*ExistingIndex];
+		StructType->CopyScriptStruct(Message.Payload, MessageBytes);
+		++Message.NumCoalesced;
+		++NumEnqueued;
+
+		if (OnComplete)
+		{
+			if (Message.OnComplete)
+			{
+				Message.OnComplete = [First = MoveTemp(Message.OnComplete), Second = MoveTemp(OnComplete)](const FGameplayMessageBroadcastResult& Result)
+				{
+					First(Result);
+					Second(Result);
+				};
+			}
+			else
+			{
+				Message.OnComplete = MoveTemp(OnComplete);
+			}
+		}
+
+		return Message;
+	}
+
+	CoalescedMessages.Add(Key, Messages.Num());
+
+	FQueuedGameplayMessage& Message = Enqueue(StructType, MessageBytes, Channel);
+	Message.TargetObject = TargetObject;
+	Message.OnComplete = MoveTemp(OnComplete);
+	return Message;
+}
+
+void FGameplayMessageQueue::SortForDispatch()
+{
+	// Indices are about to change, and nothing may be merged into a queue that is being dispatched anyway
+	CoalescedMessages.Reset();
+
+	Algo::StableSort(Messages, [](const FQueuedGameplayMessage& A, const FQueuedGameplayMessage& B)
+	{
+		if (A.StructType != B.StructType)
+		{
+			return A.StructType < B.StructType;
+		}
+
+		return A.Channel.GetTagName().FastLess(B.Channel.GetTagName());
+	});
+}
+
+void FGameplayMessageQueue::Reset()
+{
+	for (FQueuedGameplayMessage& Message : Messages)
+	{
+		Message.StructType->DestroyStruct(Message.Payload);
+	}
+
+	Messages.Reset();
+	CoalescedMessages.Reset();
+	NumEnqueued = 0;
+
+	// Pages go back to the shared page allocator, which caches them for the next frame
+	Arena.Flush();
+}
+
+FGameplayMessageInbox::~FGameplayMessageInbox()
+{
+	Reset();
+}
+
+void FGameplayMessageInbox::Enqueue(const UScriptStruct* StructType, const void* MessageBytes, FGameplayTag Channel, TWeakObjectPtr<UObject> TargetObject, const FVector& WorldPosition)
+{
+	check(StructType && MessageBytes);
+
+	FInboxMessage Pending;
+	const int32 PayloadSize = FMath::Max(StructType->GetStructureSize(), 1);
+	Pending.bInlinePayload = static_cast<SIZE_T>(PayloadSize) <= InlinePayloadSize && StructType->GetMinAlignment() <= 16;
+	void* Payload = Pending.bInlinePayload ? Pending.InlinePayload : FMemory::Malloc(PayloadSize, StructType->GetMinAlignment());
+	StructType->InitializeStruct(Payload);
+	StructType->CopyScriptStruct(Payload, MessageBytes);
+
+	Pending.Message.StructType = StructType;
+	Pending.Message.Payload = Pending.bInlinePayload ? nullptr : Payload;
+	Pending.Message.Channel = Channel;
+	Pending.Message.TargetObject = TargetObject;
+	Pending.Message.WorldPosition = WorldPosition;
+	Messages.Enqueue(MoveTemp(Pending));
+
+	NumPending.Increment();
+}
+
+int32 FGameplayMessageInbox::Drain(TFunctionRef<void(FQueuedGameplayMessage&)> Dispatch)
+{
+	check(IsInGameThread());
+
+	const int32 NumToDrain = NumPending.GetValue();
+
+	// Dispatched straight from the queue node, which is only freed once the message has been destroyed
+	int32 NumDrained = 0;
+	FInboxMessage* Pending = nullptr;
+	while (NumDrained < NumToDrain && (Pending = Messages.Peek()) != nullptr)
+	{
+		++NumDrained;
+		if (Pending->bInlinePayload)
+		{
+			Pending->Message.Payload = Pending->InlinePayload;
+		}
+		Dispatch(Pending->Message);
+		DestroyMessage(*Pending);
+		Messages.Pop();
+	}
+
+	NumPending.Subtract(NumDrained);
+	return NumDrained;
+}
+
+void FGameplayMessageInbox::Reset()
+{
+	int32 NumDrained = 0;
+	while (FInboxMessage* Pending = Messages.Peek())
+	{
+		++NumDrained;
+		if (Pending->bInlinePayload)
+		{
+			Pending->Message.Payload = Pending->InlinePayload;
+		}
+		DestroyMessage(*Pending);
+		Messages.Pop();
+	}
+
+	NumPending.Subtract(NumDrained);
+}
+
+void FGameplayMessageInbox::DestroyMessage(FInboxMessage& Pending)
+{
+	FQueuedGameplayMessage& Message = Pending.Message;
+	Message.StructType->DestroyStruct(Message.Payload);
+	if (!Pending.bInlinePayload)
+	{
+		FMemory::Free(Message.Payload);
+	}
+	Message = FQueuedGameplayMessage();
+}
@@ -0,0 +1,137 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "GameFramework/GameplayMessageRateLimiter.h"
+
+#include "GameFramework/GameplayMessageSettings.h"
+#include "GameFramework/GameplayMessageStats.h"
+#include "Misc/OutputDevice.h"
+
+const FGameplayMessageRateLimit* FGameplayMessageRateLimiter::FindLimit(FGameplayTag Channel)
+{
+	const UGameplayMessageSettings* Settings = GetDefault<UGameplayMessageSettings>();
+	const TArray<FGameplayMessageRateLimit>& RateLimits = Settings->RateLimits;
+	if (RateLimits.Num() == 0)
+	{
+		return nullptr;
+	}
+
+	// The settings bump their revision on edits in the project settings, the number also catches limits added from code
+	if (CachedLimitsRevision != Settings->GetRateLimitsRevision() || NumCachedLimits != RateLimits.Num())
+	{
+		LimitIndexByChannel.Reset();
+		CachedLimitsRevision = Settings->GetRateLimitsRevision();
+		NumCachedLimits = RateLimits.Num();
+	}
+
+	int32* pLimitIndex = LimitIndexByChannel.Find(Channel);
+	if (!pLimitIndex)
+	{
+		// The most specific limit wins, a limit on A.B takes over from a limit on A for A.B.C
+		int32 BestIndex = INDEX_NONE;
+		for (int32 Index = 0; Index < RateLimits.Num(); ++Index)
+		{
+			const FGameplayTag& LimitChannel = RateLimits[Index].Channel;
+			if (Channel.MatchesTag(LimitChannel) && (BestIndex == INDEX_NONE || LimitChannel.MatchesTag(RateLimits[BestIndex].Channel)))
+			{
+				BestIndex = Index;
+			}
+		}
+
+		pLimitIndex = &LimitIndexByChannel.Add(Channel, BestIndex);
+	}
+
+	return RateLimits.IsValidIndex(*pLimitIndex) ? &RateLimits[*pLimitIndex] : nullptr;
+}
+
+bool FGameplayMessageRateLimiter::TryConsume(const FGameplayMessageRateLimit& Limit, FGameplayTag Channel, FObjectKey TargetObject, int64 GridCell)
+{
+	FBudgetKey Key;
+	Key.Channel = Channel;
+	if (Limit.Scope == EGameplayMessageRateLimitScope::TargetObject)
+	{
+		Key.TargetObject = TargetObject;
+	}
+	else if (Limit.Scope == EGameplayMessageRateLimitScope::GridCell)
+	{
+		Key.GridCell = GridCell;
+	}
+
+	const uint64 CurrentWindow = GetCurrentWindow(Limit.Window);
+	FBudget& Budget = Budgets.FindOrAdd(Key, FBudget{ CurrentWindow, 0, Limit.Window });
+	if (Budget.Window != CurrentWindow || Budget.WindowType != Limit.Window)
+	{
+		Budget = FBudget{ CurrentWindow, 0, Limit.Window };
+	}
+
+	if (Budget.NumBroadcasts >= Limit.MaxBroadcasts)
+	{
+		++NumThrottledByChannel.FindOrAdd(Channel);
+		INC_DWORD_STAT(STAT_GameplayMessages_ThrottledBroadcasts);
+		return false;
+	}
+
+	++Budget.NumBroadcasts;
+	return true;
+}
+
+void FGameplayMessageRateLimiter::Prune()
+{
+	RemoveExpiredBudgets();
+
+	Budgets.Compact();
+	Budgets.Shrink();
+}
+
+void FGameplayMessageRateLimiter::PruneExpired()
+{
+	// Windows last a second at most, so the budgets left over in between never amount to more than a second of keys
+	const double Now = FPlatformTime::Seconds();
+	if (Now < NextPruneTime)
+	{
+		return;
+	}
+	NextPruneTime = Now + 1.0;
+
+	RemoveExpiredBudgets();
+}
+
+void FGameplayMessageRateLimiter::RemoveExpiredBudgets()
+{
+	const uint64 CurrentFrame = GetCurrentWindow(EGameplayMessageRateLimitWindow::Frame);
+	const uint64 CurrentSecond = GetCurrentWindow(EGameplayMessageRateLimitWindow::Second);
+	for (auto It = Budgets.CreateIterator(); It; ++It)
+	{
+		const FBudget& Budget = It.Value();
+		if (Budget.Window != (Budget.WindowType == EGameplayMessageRateLimitWindow::Frame ? CurrentFrame : CurrentSecond))
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void FGameplayMessageRateLimiter::Reset()
+{
+	Budgets.Empty();
+	LimitIndexByChannel.Empty();
+	CachedLimitsRevision = 0;
+	NumCachedLimits = 0;
+	NextPruneTime = 0.0;
+	NumThrottledByChannel.Empty();
+}
+
+void FGameplayMessageRateLimiter::DumpThrottled(FOutputDevice& Ar, const TCHAR* RouterName) const
+{
+	TArray<TPair<FGameplayTag, int64>> Channels = NumThrottledByChannel.Array();
+	Channels.Sort([](const TPair<FGameplayTag, int64>& A, const TPair<FGameplayTag, int64>& B) { return A.Value > B.Value; });
+
+	Ar.Logf(TEXT("%s: %d throttled channels, %d active budgets"), RouterName, Channels.Num(), Budgets.Num());
+	for (const TPair<FGameplayTag, int64>& Pair : Channels)
+	{
+		Ar.Logf(TEXT("  %s: %lld broadcasts dropped"), *Pair.Key.ToString(), Pair.Value);
+	}
+}
+
+uint64 FGameplayMessageRateLimiter::GetCurrentWindow(EGameplayMessageRateLimitWindow Window)
+{
+	return Window == EGameplayMessageRateLimitWindow::Frame ? GFrameCounter : static_cast<uint64>(FPlatformTime::Seconds());
+}
@@ -0,0 +1,387 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "GameFramework/GameplayMessageRelayComponent.h"
+
+#include "Engine/NetConnection.h"
+#include "Engine/NetSerialization.h"
+#include "Engine/World.h"
+#include "GameFramework/GameplayMessageSettings.h"
+#include "GameFramework/GameplayMessageStats.h"
+#include "GameFramework/GameplayMessageSubsystem.h"
+#include "GameFramework/GameplayWorldMessageSubsystem.h"
+#include "GameFramework/PlayerController.h"
+#include "UObject/CoreNet.h"
+#include "UObject/StructOnScope.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(GameplayMessageRelayComponent)
+
+namespace UE::GameplayMessageRelay
+{
+	// Client side relevancy reports: how often the bounds are checked and how much they have to change to be sent
+	static constexpr float RelevancyReportInterval = 1.0f;
+	static constexpr float RelevancyReportTolerance = 0.1f;
+
+	static bool SerializePayload(FArchive& Ar, UPackageMap* Map, const UScriptStruct* StructType, void* MessageBytes)
+	{
+		if (EnumHasAnyFlags(StructType->StructFlags, STRUCT_NetSerializeNative))
+		{
+			bool bSuccess = true;
+			StructType->GetCppStructOps()->NetSerialize(Ar, Map, bSuccess, MessageBytes);
+			return bSuccess && !Ar.IsError();
+		}
+
+		// Same fallback as a replicated property of a struct without NetSerialize, object references go through Map
+		StructType->SerializeBin(Ar, MessageBytes);
+		return !Ar.IsError();
+	}
+}
+
+//////////////////////////////////////////////////////////////////////
+// FGameplayMessageRelayBatch
+
+bool FGameplayMessageRelayBatch::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	using namespace UE::GameplayMessageRelay;
+
+	uint32 NumEntries = Entries.Num();
+	Ar.SerializeIntPacked(NumEntries);
+	if (Ar.IsLoading())
+	{
+		if (NumEntries > MaxEntries)
+		{
+			Ar.SetError();
+			bOutSuccess = false;
+			return true;
+		}
+
+		Entries.SetNum(NumEntries);
+		NumPayloadBytes = 0;
+	}
+
+	const FGameplayMessageRelayEntry* Previous = nullptr;
+	for (FGameplayMessageRelayEntry& Entry : Entries)
+	{
+		// Runs of the same struct type only send it once
+		uint8 bSameType = Ar.IsSaving() && Previous && Previous->StructType == Entry.StructType;
+		Ar.SerializeBits(&bSameType, 1);
+		if (bSameType)
+		{
+			if (!Previous)
+			{
+				Ar.SetError();
+				break;
+			}
+			Entry.StructType = Previous->StructType;
+		}
+		else
+		{
+			UObject* StructObject = const_cast<UScriptStruct*>(Entry.StructType);
+			Map->SerializeObject(Ar, UScriptStruct::StaticClass(), StructObject);
+			Entry.StructType = Cast<UScriptStruct>(StructObject);
+		}
+
+		bool bTagSuccess = true;
+		Entry.Channel.NetSerialize(Ar, Map, bTagSuccess);
+
+		uint8 bWorld = Entry.Router == EGameplayMessageCaptureRouter::World;
+		Ar.SerializeBits(&bWorld, 1);
+		Entry.Router = bWorld ? EGameplayMessageCaptureRouter::World : EGameplayMessageCaptureRouter::Global;
+		if (bWorld)
+		{
+			FVector_NetQuantize Position(Entry.WorldPosition);
+			bool bPositionSuccess = true;
+			Position.NetSerialize(Ar, Map, bPositionSuccess);
+			Entry.WorldPosition = Position;
+		}
+		else
+		{
+			// Sent apart from the reference, a target that is gone or unknown to the client loads as null either way
+			uint8 bHasTarget = Entry.bHasTarget;
+			Ar.SerializeBits(&bHasTarget, 1);
+			Entry.bHasTarget = bHasTarget != 0;
+			if (bHasTarget)
+			{
+				UObject* Target = Entry.TargetObject.Get();
+				Map->SerializeObject(Ar, UObject::StaticClass(), Target);
+				Entry.TargetObject = Target;
+			}
+		}
+
+		// A payload the size of the previous one of the same type is sent as the bytes that changed
+		uint8 bDelta = Ar.IsSaving() && bSameType && Previous->PayloadBits == Entry.PayloadBits;
+		Ar.SerializeBits(&bDelta, 1);
+		if (bDelta)
+		{
+			if (!bSameType)
+			{
+				Ar.SetError();
+				break;
+			}
+
+			Entry.PayloadBits = Previous->PayloadBits;
+			Entry.Payload.SetNumUninitialized(Previous->Payload.Num());
+			for (int32 ByteIndex = 0; ByteIndex < Entry.Payload.Num(); ++ByteIndex)
+			{
+				uint8 bChanged = Ar.IsSaving() && Entry.Payload[ByteIndex] != Previous->Payload[ByteIndex];
+				Ar.SerializeBits(&bChanged, 1);
+				if (bChanged)
+				{
+					Ar << Entry.Payload[ByteIndex];
+				}
+				else
+				{
+					Entry.Payload[ByteIndex] = Previous->Payload[ByteIndex];
+				}
+			}
+		}
+		else
+		{
+			uint32 PayloadBits = Entry.PayloadBits;
+			Ar.SerializeIntPacked(PayloadBits);
+			if (PayloadBits > MaxPayloadBits)
+			{
+				Ar.SetError();
+				break;
+			}
+
+			Entry.PayloadBits = PayloadBits;
+			if (Ar.IsLoading())
+			{
+				Entry.Payload.SetNumZeroed((PayloadBits + 7) >> 3);
+			}
+			Ar.SerializeBits(Entry.Payload.GetData(), PayloadBits);
+		}
+
+		if (Ar.IsLoading())
+		{
+			NumPayloadBytes += Entry.Payload.Num();
+		}
+
+		Previous = &Entry;
+	}
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////
+// UGameplayMessageRelayComponent
+
+TArray<UGameplayMessageRelayComponent*> UGameplayMessageRelayComponent::ServerRelays;
+
+UGameplayMessageRelayComponent::UGameplayMessageRelayComponent()
+{
+	SetIsReplicatedByDefault(true);
+
+	// Flush after gameplay has broadcast this frame's messages
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.TickGroup = TG_PostUpdateWork;
+}
+
+void UGameplayMessageRelayComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// The server relays for remote players only, a local player already received the message
+	APlayerController* PlayerController = GetPlayerController();
+	if (PlayerController && GetOwnerRole() == ROLE_Authority && !PlayerController->IsLocalController())
+	{
+		ServerRelays.Add(this);
+	}
+}
+
+void UGameplayMessageRelayComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	ServerRelays.RemoveSingleSwap(this, EAllowShrinking::No);
+	PendingBatch.Reset();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UGameplayMessageRelayComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (GetOwnerRole() == ROLE_Authority)
+	{
+		FlushBatch();
+	}
+	else
+	{
+		UpdateRelevancyBounds(DeltaTime);
+	}
+}
+
+APlayerController* UGameplayMessageRelayComponent::GetPlayerController() const
+{
+	return Cast<APlayerController>(GetOwner());
+}
+
+void UGameplayMessageRelayComponent::RelayMessage(const UWorld* World, EGameplayMessageCaptureRouter Router, FGameplayTag Channel, const UScriptStruct* StructType, const void* MessageBytes, const UObject* TargetObject, const FVector& WorldPosition)
+{
+	if (!GetDefault<UGameplayMessageSettings>()->ShouldReplicate(Channel))
+	{
+		return;
+	}
+
+	// The client could not resolve the target, broadcasting the message untargeted would reach the wrong listeners
+	if (TargetObject && !TargetObject->IsSupportedForNetworking())
+	{
+		return;
+	}
+
+	for (UGameplayMessageRelayComponent* Relay : ServerRelays)
+	{
+		if (Relay->GetWorld() == World)
+		{
+			Relay->EnqueueMessage(Router, Channel, StructType, MessageBytes, TargetObject, WorldPosition);
+		}
+	}
+}
+
+void UGameplayMessageRelayComponent::EnqueueMessage(EGameplayMessageCaptureRouter Router, FGameplayTag Channel, const UScriptStruct* StructType, const void* MessageBytes, const UObject* TargetObject, const FVector& WorldPosition)
+{
+	APlayerController* PlayerController = GetPlayerController();
+	UNetConnection* Connection = PlayerController ? PlayerController->GetNetConnection() : nullptr;
+	if (!Connection || !Connection->PackageMap)
+	{
+		return;
+	}
+
+	if (Router == EGameplayMessageCaptureRouter::World && RelevancyRadius < MAX_flt && FVector::DistSquared(RelevancyCenter, WorldPosition) > FMath::Square(RelevancyRadius))
+	{
+		return;
+	}
+
+	// Serialized now with this connection's package map, the batch itself only copies bits around
+	FNetBitWriter Writer(Connection->PackageMap, 256 * 8);
+	if (!UE::GameplayMessageRelay::SerializePayload(Writer, Connection->PackageMap, StructType, const_cast<void*>(MessageBytes)))
+	{
+		UE_LOG(LogGameplayMessageSubsystem, Warning, TEXT("Failed to serialize %s for relay on channel %s"), *GetNameSafe(StructType), *Channel.ToString());
+		return;
+	}
+
+	// The client rejects the whole batch when one payload is over the limit
+	if (Writer.GetNumBits() > FGameplayMessageRelayBatch::MaxPayloadBits)
+	{
+		UE_LOG(LogGameplayMessageSubsystem, Warning, TEXT("Dropped %s on channel %s from the relay, its payload of %lld bits is over the limit of %u"), *GetNameSafe(StructType), *Channel.ToString(), Writer.GetNumBits(), FGameplayMessageRelayBatch::MaxPayloadBits);
+		return;
+	}
+
+	FGameplayMessageRelayEntry& Entry = PendingBatch.Entries.AddDefaulted_GetRef();
+	Entry.StructType = StructType;
+	Entry.Channel = Channel;
+	Entry.Router = Router;
+	Entry.TargetObject = const_cast<UObject*>(TargetObject);
+	Entry.bHasTarget = TargetObject != nullptr;
+	Entry.WorldPosition = WorldPosition;
+	Entry.PayloadBits = Writer.GetNumBits();
+	Entry.Payload.Append(Writer.GetData(), Writer.GetNumBytes());
+	PendingBatch.NumPayloadBytes += Entry.Payload.Num();
+
+	if (PendingBatch.NumPayloadBytes >= GetDefault<UGameplayMessageSettings>()->RelayMaxBatchBytes || PendingBatch.Entries.Num() >= static_cast<int32>(FGameplayMessageRelayBatch::MaxEntries))
+	{
+		FlushBatch();
+	}
+}
+
+void UGameplayMessageRelayComponent::FlushBatch()
+{
+	if (PendingBatch.Entries.Num() == 0)
+	{
+		return;
+	}
+
+	INC_DWORD_STAT(STAT_GameplayMessages_RelayBatches);
+	INC_DWORD_STAT_BY(STAT_GameplayMessages_RelayedMessages, PendingBatch.Entries.Num());
+	INC_DWORD_STAT_BY(STAT_GameplayMessages_RelayPayloadBytes, PendingBatch.NumPayloadBytes);
+
+	ClientReceiveMessages(PendingBatch);
+	PendingBatch.Reset();
+}
+
+void UGameplayMessageRelayComponent::ClientReceiveMessages_Implementation(const FGameplayMessageRelayBatch& Batch)
+{
+	UNetConnection* Connection = GetNetConnection();
+	UPackageMap* PackageMap = Connection ? Connection->PackageMap : nullptr;
+	UWorld* World = GetWorld();
+	if (!PackageMap || !World)
+	{
+		return;
+	}
+
+	UGameplayWorldMessageSubsystem* WorldRouter = World->GetSubsystem<UGameplayWorldMessageSubsystem>();
+	UGameplayMessageSubsystem* GlobalRouter = UGameplayMessageSubsystem::HasInstance(World) ? &UGameplayMessageSubsystem::Get(World) : nullptr;
+
+	for (const FGameplayMessageRelayEntry& Entry : Batch.Entries)
+	{
+		// Struct types unknown to this build resolve to null
+		if (!Entry.StructType)
+		{
+			continue;
+		}
+
+		// Broadcasting it untargeted would reach the wrong listeners
+		if (Entry.bHasTarget && !Entry.TargetObject.IsValid())
+		{
+			UE_LOG(LogGameplayMessageSubsystem, Verbose, TEXT("Dropped relayed %s on channel %s, its target could not be resolved"), *Entry.StructType->GetName(), *Entry.Channel.ToString());
+			continue;
+		}
+
+		FStructOnScope Message(Entry.StructType);
+		FNetBitReader Reader(PackageMap, const_cast<uint8*>(Entry.Payload.GetData()), Entry.PayloadBits);
+		if (!UE::GameplayMessageRelay::SerializePayload(Reader, PackageMap, Entry.StructType, Message.GetStructMemory()))
+		{
+			UE_LOG(LogGameplayMessageSubsystem, Warning, TEXT("Failed to read relayed %s on channel %s"), *Entry.StructType->GetName(), *Entry.Channel.ToString());
+			continue;
+		}
+
+		if (Entry.Router == EGameplayMessageCaptureRouter::World)
+		{
+			if (WorldRouter)
+			{
+				WorldRouter->BroadcastMessageInternal(Entry.Channel, Entry.StructType, Message.GetStructMemory(), Entry.WorldPosition);
+			}
+		}
+		else if (GlobalRouter)
+		{
+			GlobalRouter->BroadcastMessageInternal(Entry.Channel, Entry.StructType, Message.GetStructMemory(), Entry.TargetObject);
+		}
+	}
+}
+
+void UGameplayMessageRelayComponent::UpdateRelevancyBounds(float DeltaTime)
+{
+	TimeUntilRelevancyReport -= DeltaTime;
+	if (TimeUntilRelevancyReport > 0.0f)
+	{
+		return;
+	}
+	TimeUntilRelevancyReport = UE::GameplayMessageRelay::RelevancyReportInterval;
+
+	const APlayerController* PlayerController = GetPlayerController();
+	const UGameplayWorldMessageSubsystem* WorldRouter = GetWorld() ? GetWorld()->GetSubsystem<UGameplayWorldMessageSubsystem>() : nullptr;
+	if (!PlayerController || !PlayerController->IsLocalController() || !WorldRouter)
+	{
+		return;
+	}
+
+	// Centered on the view target so the bounds stay tight while the listeners follow it, but they cover every listener
+	const AActor* ViewTarget = PlayerController->GetViewTarget();
+	const FVector Center = ViewTarget ? ViewTarget->GetActorLocation() : FVector::ZeroVector;
+	const float Radius = WorldRouter->GetListenBoundRadius(Center);
+
+	const float Tolerance = ReportedRelevancyRadius * UE::GameplayMessageRelay::RelevancyReportTolerance;
+	if (ReportedRelevancyRadius < 0.0f || FMath::Abs(Radius - ReportedRelevancyRadius) > Tolerance || FVector::DistSquared(Center, ReportedRelevancyCenter) > FMath::Square(Tolerance))
+	{
+		ReportedRelevancyCenter = Center;
+		ReportedRelevancyRadius = Radius;
+		ServerSetRelevancyBounds(Center, Radius);
+	}
+}
+
+void UGameplayMessageRelayComponent::ServerSetRelevancyBounds_Implementation(FVector Center, float Radius)
+{
+	RelevancyCenter = Center;
+	RelevancyRadius = FMath::Max(Radius, 0.0f);
+}
@@ -0,0 +1,49 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "GameFramework/GameplayMessageSettings.h"
+
+#include "Engine/World.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(GameplayMessageSettings)
+
+UGameplayMessageSettings::UGameplayMessageSettings()
+{
+	CategoryName = TEXT("Plugins");
+}
+
+const FGameplayWorldMessageGridSettings& UGameplayMessageSettings::GetWorldGridSettings(const UWorld* World) const
+{
+	if (World && WorldGridOverrides.Num() > 0)
+	{
+		const FString PackageName = UWorld::RemovePIEPrefix(World->GetOutermost()->GetName());
+		for (const TPair<TSoftObjectPtr<UWorld>, FGameplayWorldMessageGridSettings>& Override : WorldGridOverrides)
+		{
+			if (Override.Key.ToSoftObjectPath().GetLongPackageName() == PackageName)
+			{
+				return Override.Value;
+			}
+		}
+	}
+
+	return DefaultWorldGrid;
+}
+
+void UGameplayMessageSettings::PostReloadConfig(FProperty* PropertyThatWasLoaded)
+{
+	Super::PostReloadConfig(PropertyThatWasLoaded);
+
+	NotifyRateLimitsChanged();
+}
+
+#if WITH_EDITOR
+void UGameplayMessageSettings::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	// Editing the channel or scope of a limit keeps their number, so any edit of the array is a change
+	if (PropertyChangedEvent.GetMemberPropertyName() == GET_MEMBER_NAME_CHECKED(UGameplayMessageSettings, RateLimits))
+	{
+		NotifyRateLimitsChanged();
+	}
+}
+#endif
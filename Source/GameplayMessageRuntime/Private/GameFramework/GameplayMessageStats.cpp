@@ -0,0 +1,27 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "GameFramework/GameplayMessageStats.h"
+
+UE_TRACE_CHANNEL_DEFINE(GameplayMessagesChannel);
+
+DEFINE_STAT(STAT_GameplayMessages_Broadcast);
+DEFINE_STAT(STAT_GameplayMessages_FlushQueue);
+
+DEFINE_STAT(STAT_GameplayMessages_Broadcasts);
+DEFINE_STAT(STAT_GameplayMessages_ListenersVisited);
+DEFINE_STAT(STAT_GameplayMessages_ListenersInvoked);
+DEFINE_STAT(STAT_GameplayMessages_Cancellations);
+DEFINE_STAT(STAT_GameplayMessages_GridCellsTouched);
+DEFINE_STAT(STAT_GameplayMessages_QueueDepth);
+DEFINE_STAT(STAT_GameplayMessages_Coalesced);
+DEFINE_STAT(STAT_GameplayMessages_ThrottledBroadcasts);
+DEFINE_STAT(STAT_GameplayMessages_FarDeliveriesSkipped);
+DEFINE_STAT(STAT_GameplayMessages_InboxMessages);
+DEFINE_STAT(STAT_GameplayMessages_FollowedListenersMoved);
+DEFINE_STAT(STAT_GameplayMessages_RelayedMessages);
+DEFINE_STAT(STAT_GameplayMessages_RelayBatches);
+DEFINE_STAT(STAT_GameplayMessages_RelayPayloadBytes);
+DEFINE_STAT(STAT_GameplayMessages_AsyncActionPoolHits);
+DEFINE_STAT(STAT_GameplayMessages_AsyncActionPoolMisses);
+DEFINE_STAT(STAT_GameplayMessages_AsyncActionRegistrationsReused);
+DEFINE_STAT(STAT_GameplayMessages_AsyncActionsPooled);
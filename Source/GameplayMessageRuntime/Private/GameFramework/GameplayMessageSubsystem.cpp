@@ -1,11 +1,23 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "GameFramework/GameplayMessageSubsystem.h"
+
+#include "Algo/Sort.h"
+#include "Async/ParallelFor.h"
 #include "Engine/Engine.h"
 #include "Engine/GameInstance.h"
 #include "Engine/World.h"
+#include "GameFramework/GameplayMessageCapture.h"
+#include "GameFramework/GameplayMessageRelayComponent.h"
+#include "GameFramework/GameplayMessageSettings.h"
+#include "GameFramework/GameplayMessageStats.h"
+#include "GameFramework/GameplayWorldMessageSubsystem.h"
+#include "GameplayTagsManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/OutputDevice.h"
 #include "UObject/ScriptMacros.h"
 #include "UObject/Stack.h"
+#include "UObject/UObjectGlobals.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(GameplayMessageSubsystem)
 
@@ -21,6 +33,64 @@ namespace UE
 		static FAutoConsoleVariableRef CVarShouldLogMessages(TEXT("GameplayMessageSubsystem.LogMessages"),
 			ShouldLogMessages,
 			TEXT("Should messages broadcast through the gameplay message subsystem be logged?"));
+
+		// Compacting rehashes the map, only worth it once most of its element slots have been freed
+		template <typename MapType>
+		static bool CompactIfSparse(MapType& Map)
+		{
+			if (Map.GetMaxIndex() <= 2 * Map.Num() + 4)
+			{
+				return false;
+			}
+
+			Map.Compact();
+			Map.Shrink();
+			return true;
+		}
+
+		static void DumpRouterMemory(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			if (!World)
+			{
+				return;
+			}
+
+			if (UGameplayMessageSubsystem* Router = UGameInstance::GetSubsystem<UGameplayMessageSubsystem>(World->GetGameInstance()))
+			{
+				Router->DumpMemory(Ar);
+			}
+
+			if (UGameplayWorldMessageSubsystem* WorldRouter = World->GetSubsystem<UGameplayWorldMessageSubsystem>())
+			{
+				WorldRouter->DumpMemory(Ar);
+			}
+		}
+
+		static void DumpThrottledBroadcasts(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			if (!World)
+			{
+				return;
+			}
+
+			if (UGameplayMessageSubsystem* Router = UGameInstance::GetSubsystem<UGameplayMessageSubsystem>(World->GetGameInstance()))
+			{
+				Router->GetRateLimiter().DumpThrottled(Ar, *Router->GetPathName());
+			}
+
+			if (UGameplayWorldMessageSubsystem* WorldRouter = World->GetSubsystem<UGameplayWorldMessageSubsystem>())
+			{
+				WorldRouter->GetRateLimiter().DumpThrottled(Ar, *WorldRouter->GetPathName());
+			}
+		}
+
+		static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdDumpThrottled(TEXT("GameplayMessages.DumpThrottled"),
+			TEXT("List how many broadcasts the rate limits of UGameplayMessageSettings dropped on each channel of the current world's routers"),
+			FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic(&DumpThrottledBroadcasts));
+
+		static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdDumpMemory(TEXT("GameplayMessages.DumpMemory"),
+			TEXT("Report the memory used by the message routers of the current world, per struct type, per channel and per grid level"),
+			FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic(&DumpRouterMemory));
 	}
 }
 
@@ -29,18 +99,24 @@ namespace UE
 
 void FGameplayMessageListenerHandle::Unregister()
 {
-	if (UGameplayMessageSubsystem* StrongSubsystem = Subsystem.Get())
+	if (const TSharedPtr<FGameplayMessageRouter> StrongRouter = Router.Pin())
 	{
-		StrongSubsystem->UnregisterListener(*this);
-		Subsystem.Reset();
+		StrongRouter->UnregisterListener(*this);
+		Router.Reset();
 		StructType = nullptr;
-		ID = 0;
+		SlotIndex = INDEX_NONE;
+		Generation = 0;
 	}
 }
 
 //////////////////////////////////////////////////////////////////////
 // UGameplayMessageSubsystem
 
+UGameplayMessageSubsystem::UGameplayMessageSubsystem()
+	: Router(MakeShared<FGameplayMessageRouter>(*this))
+{
+}
+
 UGameplayMessageSubsystem& UGameplayMessageSubsystem::Get(const UObject* WorldContextObject)
 {
 	UWorld* World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::Assert);
@@ -57,82 +133,179 @@ bool UGameplayMessageSubsystem::HasInstance(const UObject* WorldContextObject)
 	return Router != nullptr;
 }
 
+void UGameplayMessageSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	FCoreUObjectDelegates::GetPostGarbageCollect().AddUObject(this, &ThisClass::PruneDeadTargetListeners);
+}
+
 void UGameplayMessageSubsystem::Deinitialize()
 {
-	ListenerMap.Reset();
+	FCoreUObjectDelegates::GetPostGarbageCollect().RemoveAll(this);
+
+	Inbox.Reset();
+	MessageQueues[0].Reset();
+	MessageQueues[1].Reset();
+	RateLimiter.Reset();
+	ParallelListenerCalls.Reset();
+
+	// Dropping the router destroys its scope routers, and the handles of their listeners go stale along with the rest
+	Router = MakeShared<FGameplayMessageRouter>(*this);
 
 	Super::Deinitialize();
 }
 
-FGameplayMessageBroadcastResult UGameplayMessageSubsystem::BroadcastMessageInternal(FGameplayTag Channel, const UScriptStruct* StructType, void* MessageBytes, TWeakObjectPtr<UObject> TargetObject)
+void UGameplayMessageSubsystem::Tick(float DeltaTime)
 {
-	// Log the message if enabled
-	if (UE::GameplayMessageSubsystem::ShouldLogMessages != 0)
+	[[maybe_unused]] const int32 NumInboxMessages = Inbox.Drain([this](FQueuedGameplayMessage& Message)
 	{
-		FString* pContextString = nullptr;
-#if WITH_EDITOR
-		if (GIsEditor)
+		BroadcastMessageInternal(Message.Channel, Message.StructType, Message.Payload, Message.TargetObject);
+	});
+	INC_DWORD_STAT_BY(STAT_GameplayMessages_InboxMessages, NumInboxMessages);
+
+	FlushQueuedMessages();
+
+	// Budgets scoped to target objects would otherwise pile up until the next garbage collection
+	RateLimiter.PruneExpired();
+}
+
+ETickableTickType UGameplayMessageSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+bool UGameplayMessageSubsystem::IsTickable() const
+{
+	return !MessageQueues[ActiveQueueIndex].IsEmpty() || !Inbox.IsEmpty() || RateLimiter.HasBudgets();
+}
+
+TStatId UGameplayMessageSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGameplayMessageSubsystem, STATGROUP_Tickables);
+}
+
+void UGameplayMessageSubsystem::QueueMessageInternal(FGameplayTag Channel, const UScriptStruct* StructType, const void* MessageBytes, TWeakObjectPtr<UObject> TargetObject, FGameplayMessageQueuedCallback&& OnComplete)
+{
+	// The queues and their arenas are owned by the game thread, a worker would race the flush that swaps them
+	if (!ensureMsgf(!bDispatchingParallelListeners, TEXT("Thread-safe listeners cannot queue messages")))
+	{
+		return;
+	}
+
+	++QueueStats.NumQueued;
+
+	FGameplayMessageQueue& Queue = MessageQueues[ActiveQueueIndex];
+	if (GetDefault<UGameplayMessageSettings>()->ShouldCoalesce(Channel))
+	{
+		Queue.EnqueueCoalesced(StructType, MessageBytes, Channel, TargetObject, MoveTemp(OnComplete));
+		return;
+	}
+
+	FQueuedGameplayMessage& Message = Queue.Enqueue(StructType, MessageBytes, Channel);
+	Message.TargetObject = TargetObject;
+	Message.OnComplete = MoveTemp(OnComplete);
+}
+
+void UGameplayMessageSubsystem::FlushQueuedMessages()
+{
+	FGameplayMessageQueue& Queue = MessageQueues[ActiveQueueIndex];
+	if (bFlushingQueue || Queue.IsEmpty())
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_GameplayMessages_FlushQueue);
+	TGuardValue<bool> FlushGuard(bFlushingQueue, true);
+
+	// Anything queued by the listeners below goes to the other buffer
+	ActiveQueueIndex ^= 1;
+
+	INC_DWORD_STAT_BY(STAT_GameplayMessages_QueueDepth, Queue.Num());
+	INC_DWORD_STAT_BY(STAT_GameplayMessages_Coalesced, Queue.NumReceived() - Queue.Num());
+	QueueStats.LastFlushQueued = Queue.NumReceived();
+	QueueStats.LastFlushDispatched = Queue.Num();
+	QueueStats.NumDispatched += Queue.Num();
+	QueueStats.NumCoalesced += Queue.NumReceived() - Queue.Num();
+
+	// Dispatch same type/channel runs back to back so their listener buckets stay in cache
+	Queue.SortForDispatch();
+	// Thread-safe listeners of the whole batch fan out together once the ordered listeners have seen every message
+	const int32 FirstParallelCall = ParallelListenerCalls.Num();
+	for (FQueuedGameplayMessage& Message : Queue.GetMessages())
+	{
+		bBatchParallelListenerCalls = true;
+		const FGameplayMessageBroadcastResult Result = BroadcastMessageInternal(Message.Channel, Message.StructType, Message.Payload, Message.TargetObject);
+		if (Message.OnComplete)
 		{
-			extern ENGINE_API FString GPlayInEditorContextString;
-			pContextString = &GPlayInEditorContextString;
+			Message.OnComplete(Result);
 		}
-#endif
+	}
 
-		FString HumanReadableMessage;
-		StructType->ExportText(/*out*/ HumanReadableMessage, MessageBytes, /*Defaults=*/ nullptr, /*OwnerObject=*/ nullptr, PPF_None, /*ExportRootScope=*/ nullptr);
-		UE_LOG(LogGameplayMessageSubsystem, Log, TEXT("BroadcastMessage(%s, %s, %s)"), pContextString ? **pContextString : *GetPathNameSafe(this), *Channel.ToString(), *HumanReadableMessage);
+	DispatchParallelListenerCalls(FirstParallelCall);
+
+	Queue.Reset();
+}
+
+bool UGameplayMessageSubsystem::AddBroadcastContinuation(UE::Tasks::TTask<FGameplayMessageBroadcastResult> Continuation)
+{
+	if (!ensureMsgf(!bDispatchingParallelListeners, TEXT("Thread-safe listeners cannot add broadcast continuations")))
+	{
+		return false;
+	}
+
+	if (BroadcastContinuations == nullptr || !Continuation.IsValid())
+	{
+		return false;
 	}
 
-	// Reset State
-	BroadcastResultCache.Reset();
+	BroadcastContinuations->Add(MoveTemp(Continuation));
+	return true;
+}
 
-	// Broadcast the message
-	if (const FChannelListenerList* pList = ListenerMap.Find(StructType))
+bool UGameplayMessageSubsystem::AddBroadcastContinuation(UE::Tasks::FTask Continuation)
+{
+	if (!ensureMsgf(!bDispatchingParallelListeners, TEXT("Thread-safe listeners cannot add broadcast continuations")))
 	{
-		// Copy in case there are removals while handling callbacks
-		TArray<FGameplayMessageListenerData> ListenerArray(pList->Listeners);
+		return false;
+	}
 
-		for (const FGameplayMessageListenerData& Listener : ListenerArray)
-		{
-			if (!Listener.ListenerStructType.IsValid())
-			{
-				UE_LOG(LogGameplayMessageSubsystem, Warning, TEXT("Listener struct type has gone invalid on Channel %s. Removing listener from list"), *Channel.ToString());
-				UnregisterListenerInternal(StructType, Listener.HandleID);
-				continue;
-			}
+	if (BroadcastContinuations == nullptr || !Continuation.IsValid())
+	{
+		return false;
+	}
 
-			// 检查结构体类型是否匹配
-			if (StructType != Listener.ListenerStructType.Get())
-			{
-				continue;
-			}
+	return AddBroadcastContinuation(UE::Tasks::Launch(UE_SOURCE_LOCATION, []() { return FGameplayMessageBroadcastResult(); }, UE::Tasks::Prerequisites(Continuation)));
+}
 
-			// 检查 TargetObject 是否匹配。如果 TargetObject 未设置，或者TargetObject就是目标（需要确认TargetObject是Valid，不然==会误判）
-			if (!Listener.TargetObject.IsExplicitlyNull() && Listener.TargetObject != TargetObject)
-			{
-				continue;
-			}
+void UGameplayMessageSubsystem::DispatchParallelListenerCalls(int32 FirstCall)
+{
+	const int32 NumCalls = ParallelListenerCalls.Num() - FirstCall;
+	if (NumCalls <= 0)
+	{
+		return;
+	}
 
-			// 检查Tag是否匹配
-			bool bMatchAny = Listener.MatchType == EGameplayMessageMatch::PartialMatch && Channel.MatchesTag(Listener.Channel);
-			bool bMatchExact = Listener.MatchType == EGameplayMessageMatch::ExactMatch && Channel.MatchesTagExact(Listener.Channel);
-			if (!bMatchAny && !bMatchExact)
-			{
-				continue;
-			}
+	{
+		TGuardValue<bool> ParallelGuard(bDispatchingParallelListeners, true);
 
-			// 执行
-			Listener.ReceivedCallback(Channel, StructType, MessageBytes);
+		// Nothing mutates the slot table while the game thread waits here, and callbacks are not allowed to
+		const FParallelListenerCall* Calls = ParallelListenerCalls.GetData() + FirstCall;
+		ParallelFor(NumCalls, [Calls](int32 CallIndex)
+		{
+			const FParallelListenerCall& Call = Calls[CallIndex];
 
-			// Check the message has been interrupted
-			if (BroadcastResultCache.bInterrupted)
+			// Unregistered by an ordered listener, or by a later message of the same batch
+			const FGameplayMessageRouter::FListenerSlot& Slot = Call.Router->ListenerSlots[Call.SlotIndex];
+			if (Slot.Generation == Call.Generation)
 			{
-				break;
+				UE::GameplayMessage::Private::FMessageTraceScope ListenerTraceScope(TEXT("Listener"), Slot.Listener.Channel, Call.StructType);
+				Slot.Listener.ReceivedCallback(Call.Channel, Call.StructType, Call.MessageBytes);
 			}
-		}
+		});
 	}
 
-	return BroadcastResultCache;
+	ParallelListenerCalls.SetNum(FirstCall, EAllowShrinking::No);
 }
 
 FGameplayMessageBroadcastResult UGameplayMessageSubsystem::K2_BroadcastMessage(FGameplayTag Channel, UPARAM(ref) int32& Message)
@@ -249,81 +422,1010 @@ DEFINE_FUNCTION(UGameplayMessageSubsystem::execK2_BroadcastSimpleObjectMessage)
 	*(FGameplayMessageBroadcastResult*)RESULT_PARAM = Result;
 }
 
-FGameplayMessageListenerHandle UGameplayMessageSubsystem::RegisterListenerInternal(FGameplayTag Channel, TFunction<void(FGameplayTag, const UScriptStruct*, void*)>&& Callback, const UScriptStruct* StructType, EGameplayMessageMatch MatchType, int32 Priority, TWeakObjectPtr<UObject> TargetObject)
+void UGameplayMessageSubsystem::CancelCurrentMessage(UObject* WorldContext, bool bCancel, bool bInterrupted)
 {
-	FChannelListenerList& List = ListenerMap.FindOrAdd(StructType);
-
-	// Find index by priority to insert
-	int32 Index = List.Listeners.Num();
-	for (int i = List.Listeners.Num()-1; i >= 0; --i)
+	if (!IsValid(WorldContext))
 	{
-		if (List.Listeners[i].Priority > Priority)
-		{
-			Index = i;
-		}
-		else
-		{
-			break;
-		}
+		return;
 	}
+	
+	UGameplayMessageSubsystem& GameplayMessageSubsystem = UGameplayMessageSubsystem::Get(WorldContext);
+	GameplayMessageSubsystem.CancelMessage(bCancel, bInterrupted);
+}
 
-	FGameplayMessageListenerData& Entry = List.Listeners.InsertDefaulted_GetRef(Index);
-	Entry.ReceivedCallback = MoveTemp(Callback);
-	Entry.ListenerStructType = StructType;
-	Entry.Channel = Channel;
-	Entry.HandleID = ++List.HandleID;
-	Entry.MatchType = MatchType;
-	Entry.TargetObject = TargetObject;
-	Entry.Priority = Priority;
+void UGameplayMessageSubsystem::CancelMessage(bool bCancel, bool bInterrupt)
+{
+	if (!ensureMsgf(!bDispatchingParallelListeners, TEXT("Thread-safe listeners cannot cancel or interrupt a message")))
+	{
+		return;
+	}
 
-	return FGameplayMessageListenerHandle(this, StructType, Entry.HandleID);
+	BroadcastResultCache.bCancelled = bCancel;
+	BroadcastResultCache.bInterrupted = bInterrupt;
 }
 
 void UGameplayMessageSubsystem::UnregisterListener(FGameplayMessageListenerHandle Handle)
 {
-	if (Handle.IsValid())
-	{
-		check(Handle.Subsystem == this);
+	Router->UnregisterListener(Handle);
+}
 
-		UnregisterListenerInternal(Handle.StructType, Handle.ID);
-	}
-	else
-	{
-		UE_LOG(LogGameplayMessageSubsystem, Warning, TEXT("Trying to unregister an invalid Handle."));
-	}
+void UGameplayMessageSubsystem::UnregisterListeners(TConstArrayView<FGameplayMessageListenerHandle> Handles)
+{
+	Router->UnregisterListeners(Handles);
 }
 
-void UGameplayMessageSubsystem::CancelCurrentMessage(UObject* WorldContext, bool bCancel, bool bInterrupted)
+void UGameplayMessageSubsystem::ReserveListeners(int32 NumListeners)
 {
-	if (!IsValid(WorldContext))
+	Router->ReserveListeners(NumListeners);
+}
+
+void UGameplayMessageSubsystem::CompactListenerStorage()
+{
+	RateLimiter.Prune();
+	Router->CompactListenerStorage();
+}
+
+void UGameplayMessageSubsystem::PruneDeadTargetListeners()
+{
+	RateLimiter.Prune();
+	Router->PruneDeadTargetListeners();
+}
+
+//////////////////////////////////////////////////////////////////////
+// FGameplayMessageRouter
+
+FGameplayMessageRouter::FGameplayMessageRouter(UGameplayMessageSubsystem& InOwner)
+	: Owner(InOwner)
+{
+}
+
+FGameplayMessageRouter::~FGameplayMessageRouter()
+{
+	// Scope routers kept alive by a running broadcast must not forward to this router anymore
+	for (const TPair<FGameplayMessageRouterScope, TSharedPtr<FGameplayMessageRouter>>& ScopePair : ScopeRouters)
 	{
-		return;
+		DestroyScopeRouterInternal(*ScopePair.Value);
 	}
-	
-	UGameplayMessageSubsystem& GameplayMessageSubsystem = UGameplayMessageSubsystem::Get(WorldContext);
-	GameplayMessageSubsystem.CancelMessage(bCancel, bInterrupted);
 }
 
-void UGameplayMessageSubsystem::CancelMessage(bool bCancel, bool bInterrupt)
+bool FGameplayMessageRouter::AddBroadcastContinuation(UE::Tasks::TTask<FGameplayMessageBroadcastResult> Continuation)
 {
-	BroadcastResultCache.bCancelled = bCancel;
-	BroadcastResultCache.bInterrupted = bInterrupt;
+	return Owner.AddBroadcastContinuation(MoveTemp(Continuation));
+}
+
+bool FGameplayMessageRouter::AddBroadcastContinuation(UE::Tasks::FTask Continuation)
+{
+	return Owner.AddBroadcastContinuation(MoveTemp(Continuation));
+}
+
+void FGameplayMessageRouter::CancelMessage(bool bCancel, bool bInterrupt)
+{
+	Owner.CancelMessage(bCancel, bInterrupt);
 }
 
-void UGameplayMessageSubsystem::UnregisterListenerInternal(const UScriptStruct* StructType, int32 HandleID)
+FGameplayMessageBroadcastResult FGameplayMessageRouter::BroadcastMessageInternal(FGameplayTag Channel, const UScriptStruct* StructType, void* MessageBytes, TWeakObjectPtr<UObject> TargetObject, FChannelRoutingCache* RoutingCache, bool bForwarded)
 {
-	if (FChannelListenerList* StructMap = ListenerMap.Find(StructType))
+	SCOPE_CYCLE_COUNTER(STAT_GameplayMessages_Broadcast);
+	UE::GameplayMessage::Private::FMessageTraceScope TraceScope(TEXT("BroadcastMessage"), Channel, StructType);
+	INC_DWORD_STAT(STAT_GameplayMessages_Broadcasts);
+
+	// BroadcastDepth, the result cache and the pending parallel calls belong to the game thread broadcast in flight
+	if (!ensureMsgf(!Owner.bDispatchingParallelListeners, TEXT("Thread-safe listeners cannot broadcast messages")))
+	{
+		return FGameplayMessageBroadcastResult();
+	}
+
+	// A listener may destroy the scope it is called from, its buckets have to outlive the broadcast walking them
+	TSharedPtr<FGameplayMessageRouter> ScopeGuard;
+	if (bIsScopeRouter)
+	{
+		ScopeGuard = AsShared();
+	}
+
+	// Nested broadcasts from listeners are synchronous unless they are async broadcasts themselves
+	TGuardValue<TArray<UE::Tasks::TTask<FGameplayMessageBroadcastResult>>*> ContinuationScope(Owner.BroadcastContinuations, Owner.NextBroadcastContinuations);
+	Owner.NextBroadcastContinuations = nullptr;
+
+	// Only the broadcast issued by the flush batches its thread-safe calls, nested broadcasts own their payloads.
+	// Taken before anything can return early, a dropped message must not leave the flag to the next broadcast.
+	const bool bBatchParallelCalls = Owner.bBatchParallelListenerCalls;
+	Owner.bBatchParallelListenerCalls = false;
+
+	// Scope routers share the budgets of their owner, a forwarded message was counted by the scope it was broadcast on
+	FGameplayMessageRateLimiter& RateLimiter = Owner.RateLimiter;
+	if (const FGameplayMessageRateLimit* RateLimit = bForwarded ? nullptr : RateLimiter.FindLimit(Channel))
 	{
-		int32 MatchIndex = StructMap->Listeners.IndexOfByPredicate([ID = HandleID](const FGameplayMessageListenerData& Other) { return Other.HandleID == ID; });
-		if (MatchIndex != INDEX_NONE)
+		if (!RateLimiter.TryConsume(*RateLimit, Channel, FObjectKey(TargetObject.Get()), 0))
 		{
-			StructMap->Listeners.RemoveAtSwap(MatchIndex);
+			FGameplayMessageBroadcastResult ThrottledResult;
+			ThrottledResult.bThrottled = true;
+			return ThrottledResult;
 		}
-		
-		if (StructMap->Listeners.Num() == 0)
+	}
+
+	// Scope routers are not reachable by replays nor by clients, forwarded messages are captured by the parent
+	if (FGameplayMessageCapture::IsEnabled() && !bIsScopeRouter)
+	{
+		FGameplayMessageCapture::Get().Record(EGameplayMessageCaptureRouter::Global, Channel, StructType, MessageBytes, TargetObject.Get(), FVector::ZeroVector);
+	}
+
+	if (UGameplayMessageRelayComponent::HasServerRelays() && !bIsScopeRouter)
+	{
+		UGameplayMessageRelayComponent::RelayMessage(Owner.GetWorld(), EGameplayMessageCaptureRouter::Global, Channel, StructType, MessageBytes, TargetObject.Get(), FVector::ZeroVector);
+	}
+
+	// Log the message if enabled
+	if (UE::GameplayMessageSubsystem::ShouldLogMessages != 0)
+	{
+		FString* pContextString = nullptr;
+#if WITH_EDITOR
+		if (GIsEditor)
 		{
-			ListenerMap.Remove(StructType);
+			extern ENGINE_API FString GPlayInEditorContextString;
+			pContextString = &GPlayInEditorContextString;
 		}
+#endif
+
+		FString HumanReadableMessage;
+		StructType->ExportText(/*out*/ HumanReadableMessage, MessageBytes, /*Defaults=*/ nullptr, /*OwnerObject=*/ nullptr, PPF_None, /*ExportRootScope=*/ nullptr);
+		UE_LOG(LogGameplayMessageSubsystem, Log, TEXT("BroadcastMessage(%s, %s, %s)"), pContextString ? **pContextString : *GetDebugName(), *Channel.ToString(), *HumanReadableMessage);
 	}
-}
 
+	// Reset State, the enclosing broadcast's result is restored on return
+	FGameplayMessageBroadcastResult& BroadcastResultCache = Owner.BroadcastResultCache;
+	TGuardValue<FGameplayMessageBroadcastResult> ResultScope(BroadcastResultCache, FGameplayMessageBroadcastResult());
+
+	TArray<UGameplayMessageSubsystem::FParallelListenerCall>& ParallelListenerCalls = Owner.ParallelListenerCalls;
+	const int32 FirstParallelCall = ParallelListenerCalls.Num();
+
+	// Broadcast the message
+	// Lists are iterated in place, any listener change made by a callback is deferred until the outermost broadcast returns
+	++BroadcastDepth;
+
+	// Only the buckets registered on this channel (exact) or one of its parents (partial) can match
+	TArray<const FChannelListenerBucket*, TInlineAllocator<8>> GatheredBuckets;
+	TConstArrayView<const FChannelListenerBucket*> Buckets;
+	const bool bCachedRoute = RoutingCache != nullptr && ((RoutingCache->Router.HasSameObject(this) && RoutingCache->Revision == ListenerIndexRevision) || RoutingCache->NumBroadcasts == 0);
+	if (bCachedRoute)
+	{
+		// Typed channels keep the gathered buckets until the index layout changes. They are iterated in place, the layout
+		// cannot change before the outermost broadcast returns and a cache in use is never gathered again.
+		if (!RoutingCache->Router.HasSameObject(this) || RoutingCache->Revision != ListenerIndexRevision)
+		{
+			RoutingCache->Buckets.Reset();
+			for (const UScriptStruct* ListenerStructType : GetCompatibleStructTypes(StructType))
+			{
+				GatherMatchingBuckets(ListenerMap.FindChecked(ListenerStructType), Channel, nullptr, RoutingCache->Buckets);
+			}
+
+			RoutingCache->Router = AsShared();
+			RoutingCache->Revision = ListenerIndexRevision;
+		}
+
+		++RoutingCache->NumBroadcasts;
+		Buckets = RoutingCache->Buckets;
+	}
+	else
+	{
+		// Listeners of StructType and of each of its parents, copied since nested broadcasts may add to the table.
+		// Also taken by a channel broadcast nested in one of the same channel on another router.
+		const TArray<const UScriptStruct*, TInlineAllocator<4>> ListenerStructTypes(GetCompatibleStructTypes(StructType));
+		for (const UScriptStruct* ListenerStructType : ListenerStructTypes)
+		{
+			GatherMatchingBuckets(ListenerMap.FindChecked(ListenerStructType), Channel, TargetObject.Get(), GatheredBuckets);
+		}
+		Buckets = GatheredBuckets;
+	}
+
+	// Merge the buckets back into a single priority order. Entries carry their registration sequence,
+	// so ties resolve exactly like the old single sorted list did.
+	TArray<int32, TInlineAllocator<8>> Cursors;
+	Cursors.SetNumZeroed(Buckets.Num());
+	[[maybe_unused]] int32 NumVisited = 0;
+	[[maybe_unused]] int32 NumInvoked = 0;
+	for (;;)
+	{
+		int32 BestBucket = INDEX_NONE;
+		for (int32 BucketIndex = 0; BucketIndex < Buckets.Num(); ++BucketIndex)
+		{
+			const TArray<FChannelListenerEntry>& Entries = Buckets[BucketIndex]->Entries;
+			if (!Entries.IsValidIndex(Cursors[BucketIndex]))
+			{
+				continue;
+			}
+
+			if (BestBucket == INDEX_NONE || Entries[Cursors[BucketIndex]] < Buckets[BestBucket]->Entries[Cursors[BestBucket]])
+			{
+				BestBucket = BucketIndex;
+			}
+		}
+
+		if (BestBucket == INDEX_NONE)
+		{
+			break;
+		}
+
+		const FChannelListenerEntry& Entry = Buckets[BestBucket]->Entries[Cursors[BestBucket]++];
+		++NumVisited;
+
+		// Unregistered, possibly by an earlier callback of this (or an enclosing) broadcast
+		const FListenerSlot& Slot = ListenerSlots[Entry.SlotIndex];
+		if (Slot.Generation != Entry.Generation)
+		{
+			continue;
+		}
+
+		const FGameplayMessageListenerData& Listener = Slot.Listener;
+
+		if (!Listener.ListenerStructType.IsValid())
+		{
+			UE_LOG(LogGameplayMessageSubsystem, Warning, TEXT("Listener struct type has gone invalid on Channel %s. Removing listener from list"), *Channel.ToString());
+			UnregisterListenerInternal(Entry.SlotIndex, Entry.Generation);
+			continue;
+		}
+
+		// Struct types and target objects are matched by the index, only the buckets of compatible struct types and of
+		// the untargeted and this target's listeners have been gathered.
+		// Thread-safe listeners run after the ordered ones
+		if (EnumHasAnyFlags(Listener.Flags, EGameplayMessageListenerFlags::ThreadSafe))
+		{
+			ParallelListenerCalls.Add({ this, Entry.SlotIndex, Entry.Generation, Channel, StructType, MessageBytes });
+			++NumInvoked;
+			continue;
+		}
+
+		// 执行
+		++NumInvoked;
+		UE::GameplayMessage::Private::FMessageTraceScope ListenerTraceScope(TEXT("Listener"), Listener.Channel, StructType);
+		Listener.ReceivedCallback(Channel, StructType, MessageBytes);
+
+		// Check the message has been interrupted
+		if (BroadcastResultCache.bInterrupted)
+		{
+			break;
+		}
+	}
+
+	if (bCachedRoute)
+	{
+		--RoutingCache->NumBroadcasts;
+	}
+
+	INC_DWORD_STAT_BY(STAT_GameplayMessages_ListenersVisited, NumVisited);
+
+	// An interrupted broadcast does not reach its thread-safe listeners either
+	FGameplayMessageBroadcastResult Result = BroadcastResultCache;
+	if (Result.bInterrupted)
+	{
+		NumInvoked -= ParallelListenerCalls.Num() - FirstParallelCall;
+		ParallelListenerCalls.SetNum(FirstParallelCall, EAllowShrinking::No);
+	}
+	else if (!bBatchParallelCalls)
+	{
+		Owner.DispatchParallelListenerCalls(FirstParallelCall);
+	}
+
+	if (--BroadcastDepth == 0 && PendingListenerChanges.Num() > 0)
+	{
+		ApplyPendingListenerChanges();
+	}
+
+	INC_DWORD_STAT_BY(STAT_GameplayMessages_ListenersInvoked, NumInvoked);
+	if (Result.bCancelled)
+	{
+		INC_DWORD_STAT(STAT_GameplayMessages_Cancellations);
+	}
+
+	// Cleared if a listener destroyed this scope
+	if (bForwardToParent && !Result.bInterrupted && Parent != nullptr)
+	{
+		// Listeners of the parent can add continuations to an async broadcast of this scope
+		Owner.NextBroadcastContinuations = Owner.BroadcastContinuations;
+		const FGameplayMessageBroadcastResult ParentResult = Parent->BroadcastMessageInternal(Channel, StructType, MessageBytes, TargetObject, nullptr, /*bForwarded=*/ true);
+		Result.bCancelled |= ParentResult.bCancelled;
+		Result.bInterrupted |= ParentResult.bInterrupted;
+		Result.bThrottled |= ParentResult.bThrottled;
+	}
+
+	return Result;
+}
+
+UE::Tasks::TTask<FGameplayMessageBroadcastResult> FGameplayMessageRouter::BroadcastMessageAsyncInternal(FGameplayTag Channel, const UScriptStruct* StructType, void* MessageBytes, TWeakObjectPtr<UObject> TargetObject)
+{
+	// Rejected before the continuation list of the next broadcast is handed over, it belongs to the game thread
+	if (!ensureMsgf(!Owner.bDispatchingParallelListeners, TEXT("Thread-safe listeners cannot broadcast messages")))
+	{
+		return UE::Tasks::MakeCompletedTask<FGameplayMessageBroadcastResult>();
+	}
+
+	TArray<UE::Tasks::TTask<FGameplayMessageBroadcastResult>> Continuations;
+	Owner.NextBroadcastContinuations = &Continuations;
+	const FGameplayMessageBroadcastResult Result = BroadcastMessageInternal(Channel, StructType, MessageBytes, TargetObject);
+	check(Owner.NextBroadcastContinuations == nullptr);
+
+	if (Continuations.Num() == 0)
+	{
+		return UE::Tasks::MakeCompletedTask<FGameplayMessageBroadcastResult>(Result);
+	}
+
+	// Only runs once every continuation is done, reading their results does not block
+	return UE::Tasks::Launch(UE_SOURCE_LOCATION, [Result, Continuations]() mutable
+	{
+		FGameplayMessageBroadcastResult FinalResult = Result;
+		for (UE::Tasks::TTask<FGameplayMessageBroadcastResult>& Continuation : Continuations)
+		{
+			const FGameplayMessageBroadcastResult& ContinuationResult = Continuation.GetResult();
+			FinalResult.bCancelled |= ContinuationResult.bCancelled;
+			FinalResult.bInterrupted |= ContinuationResult.bInterrupted;
+		}
+		return FinalResult;
+	}, Continuations);
+}
+
+TConstArrayView<const UScriptStruct*> FGameplayMessageRouter::GetCompatibleStructTypes(const UScriptStruct* StructType)
+{
+	if (const TArray<const UScriptStruct*, TInlineAllocator<4>>* pTypes = CompatibleStructTypes.Find(StructType))
+	{
+		return *pTypes;
+	}
+
+	TArray<const UScriptStruct*, TInlineAllocator<4>>& Types = CompatibleStructTypes.Add(StructType);
+	for (const UStruct* Type = StructType; Type != nullptr; Type = Type->GetSuperStruct())
+	{
+		if (ListenerMap.Contains(static_cast<const UScriptStruct*>(Type)))
+		{
+			Types.Add(static_cast<const UScriptStruct*>(Type));
+		}
+	}
+	return Types;
+}
+
+FGameplayMessageListenerHandle FGameplayMessageRouter::RegisterListenerInternal(FGameplayTag Channel, FGameplayMessageCallback&& Callback, const UScriptStruct* StructType, EGameplayMessageMatch MatchType, int32 Priority, TWeakObjectPtr<UObject> TargetObject, EGameplayMessageListenerFlags Flags)
+{
+	if (!ensureMsgf(!Owner.bDispatchingParallelListeners, TEXT("Thread-safe listeners cannot register listeners")))
+	{
+		return FGameplayMessageListenerHandle();
+	}
+
+	// Untargeted listeners are indexed under the null key, a listener bound to an object that is already gone would end up there
+	if (!TargetObject.IsExplicitlyNull() && !TargetObject.IsValid())
+	{
+		UE_LOG(LogGameplayMessageSubsystem, Warning, TEXT("Trying to register a listener on Channel %s for a target object that is no longer valid."), *Channel.ToString());
+		return FGameplayMessageListenerHandle();
+	}
+
+	// Slots never move, so one can be claimed even while a broadcast is running callbacks
+	const int32 SlotIndex = ListenerSlots.Allocate();
+	FListenerSlot& Slot = ListenerSlots[SlotIndex];
+	Slot.StructType = StructType;
+	Slot.Sequence = ++LastSequence;
+
+	FGameplayMessageListenerData& Entry = Slot.Listener;
+	Entry.ReceivedCallback = MoveTemp(Callback);
+	Entry.ListenerStructType = StructType;
+	Entry.Channel = Channel;
+	Entry.MatchType = MatchType;
+	Entry.TargetObject = TargetObject;
+	Entry.Priority = static_cast<uint8>(FMath::Clamp<int32>(Priority, 0, MAX_uint8));
+	Entry.Flags = Flags;
+	Slot.TargetKey = FObjectKey(TargetObject.Get());
+
+	if (BroadcastDepth > 0)
+	{
+		// A broadcast is iterating the index, the listener will start receiving messages once it returns
+		PendingListenerChanges.Add({ SlotIndex, Slot.Generation, true });
+	}
+	else if (ListenerBatchDepth > 0)
+	{
+		BatchedListeners.Emplace(SlotIndex, Slot.Generation);
+	}
+	else
+	{
+		AddListenerToIndex(SlotIndex);
+	}
+
+	return FGameplayMessageListenerHandle(AsShared(), StructType, SlotIndex, Slot.Generation);
+}
+
+void FGameplayMessageRouter::BeginListenerBatch()
+{
+	++ListenerBatchDepth;
+}
+
+void FGameplayMessageRouter::EndListenerBatch()
+{
+	check(ListenerBatchDepth > 0);
+	if (--ListenerBatchDepth > 0 || BatchedListeners.Num() == 0)
+	{
+		return;
+	}
+
+	// Append the whole batch, then sort each bucket that ended up out of order once. Bucket addresses are only
+	// stable once nothing is added anymore, so the buckets are looked up again from their slots afterwards.
+	TArray<int32> UnsortedSlots;
+	for (const TPair<int32, int32>& Batched : BatchedListeners)
+	{
+		// Listeners unregistered within the batch have already been released
+		const FListenerSlot& Slot = ListenerSlots[Batched.Key];
+		if (Slot.bInUse && Slot.Generation == Batched.Value && !AddListenerToIndex(Batched.Key, true))
+		{
+			UnsortedSlots.Add(Batched.Key);
+		}
+	}
+
+	TSet<FChannelListenerBucket*> UnsortedBuckets;
+	for (int32 SlotIndex : UnsortedSlots)
+	{
+		const FListenerSlot& Slot = ListenerSlots[SlotIndex];
+		FChannelListenerList& List = ListenerMap.FindChecked(Slot.StructType);
+		FChannelListenerIndex& Index = Slot.TargetKey == FObjectKey() ? List.UntargetedListeners : List.TargetedListeners.FindChecked(Slot.TargetKey);
+		UnsortedBuckets.Add(&Index.GetBuckets(Slot.Listener.MatchType).FindChecked(Slot.Listener.Channel));
+	}
+
+	// Sequences are unique, so ordering by (priority, sequence) keeps equal priorities in registration order
+	for (FChannelListenerBucket* Bucket : UnsortedBuckets)
+	{
+		Algo::Sort(Bucket->Entries);
+	}
+
+	BatchedListeners.Reset();
+}
+
+void FGameplayMessageRouter::ReserveListeners(int32 NumListeners)
+{
+	if (NumListeners > 0)
+	{
+		ListenerSlots.Reserve(NumListeners);
+	}
+}
+
+bool FGameplayMessageRouter::AddListenerToIndex(int32 SlotIndex, bool bAppend)
+{
+	FListenerSlot& Slot = ListenerSlots[SlotIndex];
+	const FGameplayMessageListenerData& Listener = Slot.Listener;
+	Slot.bIndexed = true;
+
+	FChannelListenerList* pList = ListenerMap.Find(Slot.StructType);
+	if (!pList)
+	{
+		// A new listener struct type, broadcasts of its child types have to resolve their compatible types again
+		pList = &ListenerMap.Add(Slot.StructType);
+		CompatibleStructTypes.Reset();
+	}
+	FChannelListenerList& List = *pList;
+	FChannelListenerIndex& Index = Slot.TargetKey == FObjectKey() ? List.UntargetedListeners : List.TargetedListeners.FindOrAdd(Slot.TargetKey);
+	TMap<FGameplayTag, FChannelListenerBucket>& Buckets = Index.GetBuckets(Listener.MatchType);
+	if (Slot.TargetKey == FObjectKey() && !Buckets.Contains(Listener.Channel))
+	{
+		// Bucket addresses may move, channel routing caches (untargeted only) have to gather them again
+		++ListenerIndexRevision;
+	}
+	FChannelListenerBucket& Bucket = Buckets.FindOrAdd(Listener.Channel);
+	++List.NumListeners;
+
+	FChannelListenerEntry NewEntry;
+	NewEntry.SlotIndex = SlotIndex;
+	NewEntry.Generation = Slot.Generation;
+	NewEntry.Priority = Listener.Priority;
+	NewEntry.Sequence = Slot.Sequence;
+
+	if (bAppend)
+	{
+		const bool bInOrder = Bucket.Entries.Num() == 0 || !(NewEntry < Bucket.Entries.Last());
+		Bucket.Entries.Add(NewEntry);
+		return bInOrder;
+	}
+
+	// Find index by priority to insert
+	int32 InsertIndex = Bucket.Entries.Num();
+	for (int i = Bucket.Entries.Num()-1; i >= 0; --i)
+	{
+		if (NewEntry < Bucket.Entries[i])
+		{
+			InsertIndex = i;
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	Bucket.Entries.Insert(NewEntry, InsertIndex);
+	return true;
+}
+
+void FGameplayMessageRouter::GatherMatchingBuckets(const FChannelListenerList& List, FGameplayTag Channel, const UObject* TargetObject, TArray<const FChannelListenerBucket*, TInlineAllocator<8>>& OutBuckets)
+{
+	// Listeners bound to another object never match, only this target's index is visited next to the untargeted one
+	TArray<const FChannelListenerIndex*, TInlineAllocator<2>> Indices;
+	Indices.Add(&List.UntargetedListeners);
+	if (TargetObject != nullptr)
+	{
+		if (const FChannelListenerIndex* TargetIndex = List.TargetedListeners.Find(FObjectKey(TargetObject)))
+		{
+			Indices.Add(TargetIndex);
+		}
+	}
+
+	bool bHasPartialListeners = false;
+	for (const FChannelListenerIndex* Index : Indices)
+	{
+		if (const FChannelListenerBucket* ExactBucket = Index->ExactListeners.Find(Channel))
+		{
+			OutBuckets.Add(ExactBucket);
+		}
+
+		bHasPartialListeners |= Index->PartialListeners.Num() > 0;
+	}
+
+	if (!bHasPartialListeners)
+	{
+		return;
+	}
+
+	// Walk the tag tree from the broadcast channel up to its root, a partial listener on any of these matches
+	TSharedPtr<FGameplayTagNode> ChannelNode = UGameplayTagsManager::Get().FindTagNode(Channel);
+	for (const FGameplayTagNode* Node = ChannelNode.Get(); Node != nullptr; Node = Node->GetParentTagNode())
+	{
+		const FGameplayTag& NodeTag = Node->GetCompleteTag();
+		if (!NodeTag.IsValid())
+		{
+			// The root node of the tag tree has no tag of its own
+			break;
+		}
+
+		for (const FChannelListenerIndex* Index : Indices)
+		{
+			if (const FChannelListenerBucket* PartialBucket = Index->PartialListeners.Find(NodeTag))
+			{
+				OutBuckets.Add(PartialBucket);
+			}
+		}
+	}
+}
+
+void FGameplayMessageRouter::PruneDeadTargetListeners()
+{
+	// Only the subsystem is bound to garbage collection, each router prunes its scope routers as well
+	TArray<FGameplayMessageRouterScope> DeadScopes;
+	for (const TPair<FGameplayMessageRouterScope, TSharedPtr<FGameplayMessageRouter>>& ScopePair : ScopeRouters)
+	{
+		if (ScopePair.Key.HasObject() && ScopePair.Key.Object.ResolveObjectPtr() == nullptr)
+		{
+			DeadScopes.Add(ScopePair.Key);
+		}
+		else
+		{
+			ScopePair.Value->PruneDeadTargetListeners();
+		}
+	}
+
+	for (const FGameplayMessageRouterScope& Scope : DeadScopes)
+	{
+		DestroyScopeRouter(Scope);
+	}
+
+	TArray<FChannelListenerEntry> DeadListeners;
+	for (const TPair<const UScriptStruct*, FChannelListenerList>& StructPair : ListenerMap)
+	{
+		for (const TPair<FObjectKey, FChannelListenerIndex>& TargetPair : StructPair.Value.TargetedListeners)
+		{
+			if (TargetPair.Key.ResolveObjectPtr() != nullptr)
+			{
+				continue;
+			}
+
+			for (const TMap<FGameplayTag, FChannelListenerBucket>* Buckets : { &TargetPair.Value.ExactListeners, &TargetPair.Value.PartialListeners })
+			{
+				for (const TPair<FGameplayTag, FChannelListenerBucket>& BucketPair : *Buckets)
+				{
+					DeadListeners.Append(BucketPair.Value.Entries);
+				}
+			}
+		}
+	}
+
+	// Stale entries are rejected by the generation check, the index is cleaned up as the last listeners go
+	for (const FChannelListenerEntry& Entry : DeadListeners)
+	{
+		UnregisterListenerInternal(Entry.SlotIndex, Entry.Generation);
+	}
+
+	CompactListenerStorage();
+}
+
+void FGameplayMessageRouter::CompactListenerStorage()
+{
+	if (BroadcastDepth > 0)
+	{
+		return;
+	}
+
+	using UE::GameplayMessageSubsystem::CompactIfSparse;
+
+	// Compacting moves buckets around, the routing caches pointing at them have to gather again
+	bool bBucketsMoved = CompactIfSparse(ListenerMap);
+	auto CompactIndex = [&bBucketsMoved](FChannelListenerIndex& Index)
+	{
+		for (TMap<FGameplayTag, FChannelListenerBucket>* Buckets : { &Index.ExactListeners, &Index.PartialListeners })
+		{
+			bBucketsMoved |= CompactIfSparse(*Buckets);
+			for (TPair<FGameplayTag, FChannelListenerBucket>& BucketPair : *Buckets)
+			{
+				// Buckets are read live, their entries can be reallocated without invalidating anything
+				TArray<FChannelListenerEntry>& Entries = BucketPair.Value.Entries;
+				if (Entries.GetSlack() > Entries.Num())
+				{
+					Entries.Shrink();
+				}
+			}
+		}
+	};
+
+	for (TPair<const UScriptStruct*, FChannelListenerList>& StructPair : ListenerMap)
+	{
+		CompactIndex(StructPair.Value.UntargetedListeners);
+
+		CompactIfSparse(StructPair.Value.TargetedListeners);
+		for (TPair<FObjectKey, FChannelListenerIndex>& TargetPair : StructPair.Value.TargetedListeners)
+		{
+			CompactIndex(TargetPair.Value);
+		}
+	}
+
+	if (bBucketsMoved)
+	{
+		++ListenerIndexRevision;
+	}
+
+	// Slot pages are kept, their generations are what tells stale handles apart from the listeners reusing the slots
+	if (ListenerSlots.FreeSlots.GetSlack() > ListenerSlots.FreeSlots.Num())
+	{
+		ListenerSlots.FreeSlots.Shrink();
+	}
+}
+
+void FGameplayMessageRouter::DumpMemory(FOutputDevice& Ar) const
+{
+	struct FMemoryUsage
+	{
+		int32 NumListeners = 0;
+		SIZE_T Bytes = 0;
+	};
+
+	TMap<const UScriptStruct*, FMemoryUsage> UsageByStructType;
+	TMap<FGameplayTag, FMemoryUsage> UsageByChannel;
+
+	// A listener costs its slot, plus its share of the index below
+	for (int32 SlotIndex = 0; SlotIndex < ListenerSlots.NumSlots; ++SlotIndex)
+	{
+		const FListenerSlot& Slot = ListenerSlots[SlotIndex];
+		if (Slot.bInUse)
+		{
+			for (FMemoryUsage* Usage : { &UsageByStructType.FindOrAdd(Slot.StructType), &UsageByChannel.FindOrAdd(Slot.Listener.Channel) })
+			{
+				++Usage->NumListeners;
+				Usage->Bytes += sizeof(FListenerSlot);
+			}
+		}
+	}
+
+	SIZE_T IndexBytes = ListenerMap.GetAllocatedSize();
+	auto AddIndexUsage = [&UsageByChannel, &IndexBytes](const FChannelListenerIndex& Index, FMemoryUsage& StructUsage)
+	{
+		for (const TMap<FGameplayTag, FChannelListenerBucket>* Buckets : { &Index.ExactListeners, &Index.PartialListeners })
+		{
+			StructUsage.Bytes += Buckets->GetAllocatedSize();
+			IndexBytes += Buckets->GetAllocatedSize();
+			for (const TPair<FGameplayTag, FChannelListenerBucket>& BucketPair : *Buckets)
+			{
+				const SIZE_T EntryBytes = BucketPair.Value.Entries.GetAllocatedSize();
+				StructUsage.Bytes += EntryBytes;
+				IndexBytes += EntryBytes;
+				UsageByChannel.FindOrAdd(BucketPair.Key).Bytes += EntryBytes;
+			}
+		}
+	};
+
+	for (const TPair<const UScriptStruct*, FChannelListenerList>& StructPair : ListenerMap)
+	{
+		FMemoryUsage& StructUsage = UsageByStructType.FindOrAdd(StructPair.Key);
+		AddIndexUsage(StructPair.Value.UntargetedListeners, StructUsage);
+
+		StructUsage.Bytes += StructPair.Value.TargetedListeners.GetAllocatedSize();
+		IndexBytes += StructPair.Value.TargetedListeners.GetAllocatedSize();
+		for (const TPair<FObjectKey, FChannelListenerIndex>& TargetPair : StructPair.Value.TargetedListeners)
+		{
+			AddIndexUsage(TargetPair.Value, StructUsage);
+		}
+	}
+
+	const SIZE_T SlotBytes = ListenerSlots.GetAllocatedSize();
+	const SIZE_T OtherBytes = CompatibleStructTypes.GetAllocatedSize() + PendingListenerChanges.GetAllocatedSize() + ScopeRouters.GetAllocatedSize();
+
+	Ar.Logf(TEXT("%s: %.1f KB, %d listener slots (%.1f KB), index %.1f KB, other %.1f KB"),
+		*GetDebugName(), (SlotBytes + IndexBytes + OtherBytes) / 1024.0, ListenerSlots.NumSlots, SlotBytes / 1024.0, IndexBytes / 1024.0, OtherBytes / 1024.0);
+
+	UsageByStructType.ValueSort([](const FMemoryUsage& A, const FMemoryUsage& B) { return A.Bytes > B.Bytes; });
+	Ar.Logf(TEXT("  By struct type:"));
+	for (const TPair<const UScriptStruct*, FMemoryUsage>& Pair : UsageByStructType)
+	{
+		Ar.Logf(TEXT("    %s: %d listeners, %.1f KB"), *GetNameSafe(Pair.Key), Pair.Value.NumListeners, Pair.Value.Bytes / 1024.0);
+	}
+
+	UsageByChannel.ValueSort([](const FMemoryUsage& A, const FMemoryUsage& B) { return A.Bytes > B.Bytes; });
+	Ar.Logf(TEXT("  By channel:"));
+	for (const TPair<FGameplayTag, FMemoryUsage>& Pair : UsageByChannel)
+	{
+		Ar.Logf(TEXT("    %s: %d listeners, %.1f KB"), *Pair.Key.ToString(), Pair.Value.NumListeners, Pair.Value.Bytes / 1024.0);
+	}
+
+	for (const TPair<FGameplayMessageRouterScope, TSharedPtr<FGameplayMessageRouter>>& ScopePair : ScopeRouters)
+	{
+		ScopePair.Value->DumpMemory(Ar);
+	}
+}
+
+void FGameplayMessageRouter::UnregisterListener(FGameplayMessageListenerHandle Handle)
+{
+	if (Handle.IsValid())
+	{
+		check(Handle.Router.HasSameObject(this));
+
+		UnregisterListenerInternal(Handle.SlotIndex, Handle.Generation);
+	}
+	else
+	{
+		UE_LOG(LogGameplayMessageSubsystem, Warning, TEXT("Trying to unregister an invalid Handle."));
+	}
+}
+
+void FGameplayMessageRouter::UnregisterListeners(TConstArrayView<FGameplayMessageListenerHandle> Handles)
+{
+	// Unregistering only bumps slot generations, buckets compact their stale entries once they make up half of them,
+	// so a whole level going away costs a few stable passes per bucket rather than one removal per listener
+	for (const FGameplayMessageListenerHandle& Handle : Handles)
+	{
+		if (Handle.IsValid() && Handle.Router.HasSameObject(this))
+		{
+			UnregisterListenerInternal(Handle.SlotIndex, Handle.Generation);
+		}
+	}
+}
+
+FGameplayMessageRouter& FGameplayMessageRouter::GetScopeRouter(const FGameplayMessageRouterScope& Scope, bool bInForwardToParent)
+{
+	if (const TSharedPtr<FGameplayMessageRouter>* pScopeRouter = ScopeRouters.Find(Scope))
+	{
+		return **pScopeRouter;
+	}
+
+	// Shares the owner's broadcast context, queues and rate limits, only the listener storage is its own
+	const TSharedPtr<FGameplayMessageRouter>& ScopeRouter = ScopeRouters.Add(Scope, MakeShared<FGameplayMessageRouter>(Owner));
+	ScopeRouter->Parent = this;
+	ScopeRouter->ScopeKey = Scope;
+	ScopeRouter->bIsScopeRouter = true;
+	ScopeRouter->bForwardToParent = bInForwardToParent;
+	return *ScopeRouter;
+}
+
+FGameplayMessageRouter* FGameplayMessageRouter::FindScopeRouter(const FGameplayMessageRouterScope& Scope) const
+{
+	const TSharedPtr<FGameplayMessageRouter>* pScopeRouter = ScopeRouters.Find(Scope);
+	return pScopeRouter != nullptr ? pScopeRouter->Get() : nullptr;
+}
+
+void FGameplayMessageRouter::DestroyScopeRouter(const FGameplayMessageRouterScope& Scope)
+{
+	TSharedPtr<FGameplayMessageRouter> ScopeRouter;
+	if (ScopeRouters.RemoveAndCopyValue(Scope, ScopeRouter))
+	{
+		DestroyScopeRouterInternal(*ScopeRouter);
+	}
+}
+
+void FGameplayMessageRouter::DestroyScopeRouterInternal(FGameplayMessageRouter& ScopeRouter)
+{
+	ScopeRouter.Parent = nullptr;
+	ScopeRouter.bForwardToParent = false;
+
+	for (const TPair<FGameplayMessageRouterScope, TSharedPtr<FGameplayMessageRouter>>& ScopePair : ScopeRouter.ScopeRouters)
+	{
+		DestroyScopeRouterInternal(*ScopePair.Value);
+	}
+	ScopeRouter.ScopeRouters.Reset();
+
+	if (ScopeRouter.BroadcastDepth > 0)
+	{
+		// Destroyed by one of its own listeners, the running broadcast keeps the router alive and still walks its buckets
+		// so listeners are only unregistered, their slots are released as the broadcast unwinds
+		for (int32 SlotIndex = 0; SlotIndex < ScopeRouter.ListenerSlots.NumSlots; ++SlotIndex)
+		{
+			const FListenerSlot& Slot = ScopeRouter.ListenerSlots[SlotIndex];
+			if (Slot.bInUse)
+			{
+				ScopeRouter.UnregisterListenerInternal(SlotIndex, Slot.Generation);
+			}
+		}
+	}
+}
+
+FString FGameplayMessageRouter::GetDebugName() const
+{
+	const FString OwnerName = GetPathNameSafe(&Owner);
+	if (!bIsScopeRouter)
+	{
+		return OwnerName;
+	}
+
+	return FString::Printf(TEXT("%s [%s %s]"), Parent != nullptr ? *Parent->GetDebugName() : *OwnerName, *ScopeKey.Tag.ToString(), *GetPathNameSafe(ScopeKey.Object.ResolveObjectPtr()));
+}
+
+void FGameplayMessageRouter::UnregisterListenerInternal(int32 SlotIndex, int32 Generation)
+{
+	if (!ensureMsgf(!Owner.bDispatchingParallelListeners, TEXT("Thread-safe listeners cannot unregister listeners")))
+	{
+		return;
+	}
+
+	// Stale handles (already unregistered, or the slot has been recycled since) are rejected without any search
+	if (!ListenerSlots.IsValidIndex(SlotIndex))
+	{
+		return;
+	}
+
+	FListenerSlot& Slot = ListenerSlots[SlotIndex];
+	if (!Slot.bInUse || Slot.Generation != Generation)
+	{
+		return;
+	}
+
+	// Bumping the generation turns every reference to this listener stale, dispatch skips it from now on
+	Slot.Generation = Slot.Generation == MAX_int32 ? 1 : Slot.Generation + 1;
+
+	if (BroadcastDepth > 0)
+	{
+		// The callback may be the one running right now, destroy it once the broadcast unwinds
+		PendingListenerChanges.Add({ SlotIndex, Generation, false });
+	}
+	else
+	{
+		ReleaseListenerSlot(SlotIndex);
+	}
+}
+
+void FGameplayMessageRouter::ReleaseListenerSlot(int32 SlotIndex)
+{
+	FListenerSlot& Slot = ListenerSlots[SlotIndex];
+	const FGameplayMessageListenerData& Listener = Slot.Listener;
+
+	// The bucket entry is left behind as stale, compact once stale entries make up half the bucket.
+	// RemoveAll is stable so the dispatch order of the remaining listeners is unchanged.
+	FChannelListenerList* StructMap = Slot.bIndexed ? ListenerMap.Find(Slot.StructType) : nullptr;
+	if (StructMap)
+	{
+		const bool bTargeted = Slot.TargetKey != FObjectKey();
+		FChannelListenerIndex* Index = bTargeted ? StructMap->TargetedListeners.Find(Slot.TargetKey) : &StructMap->UntargetedListeners;
+		if (Index)
+		{
+			TMap<FGameplayTag, FChannelListenerBucket>& Buckets = Index->GetBuckets(Listener.MatchType);
+			if (FChannelListenerBucket* Bucket = Buckets.Find(Listener.Channel))
+			{
+				if (++Bucket->NumStale * 2 >= Bucket->Entries.Num())
+				{
+					Bucket->Entries.RemoveAll([this](const FChannelListenerEntry& Entry) { return ListenerSlots[Entry.SlotIndex].Generation != Entry.Generation; });
+					Bucket->NumStale = 0;
+				}
+
+				if (Bucket->Entries.Num() == 0)
+				{
+					Buckets.Remove(Listener.Channel);
+					if (!bTargeted)
+					{
+						++ListenerIndexRevision;
+					}
+				}
+			}
+
+			if (bTargeted && Index->IsEmpty())
+			{
+				StructMap->TargetedListeners.Remove(Slot.TargetKey);
+			}
+		}
+
+		if (--StructMap->NumListeners == 0)
+		{
+			ListenerMap.Remove(Slot.StructType);
+			CompatibleStructTypes.Reset();
+			++ListenerIndexRevision;
+		}
+	}
+
+	ListenerSlots.Free(SlotIndex);
+}
+
+void FGameplayMessageRouter::ApplyPendingListenerChanges()
+{
+	check(BroadcastDepth == 0);
+
+	// Changes are replayed in the order they were requested
+	for (const FPendingListenerChange& Change : PendingListenerChanges)
+	{
+		if (Change.bRegister)
+		{
+			// Skip listeners that were registered and unregistered inside the same broadcast, they were never indexed
+			const FListenerSlot& Slot = ListenerSlots[Change.SlotIndex];
+			if (Slot.Generation == Change.Generation)
+			{
+				AddListenerToIndex(Change.SlotIndex);
+			}
+		}
+		else
+		{
+			ReleaseListenerSlot(Change.SlotIndex);
+		}
+	}
+
+	// Keep the allocation around, listener changes from callbacks tend to happen every frame
+	PendingListenerChanges.Reset();
+}
+
+//////////////////////////////////////////////////////////////////////
+// FGameplayMessageRouter::FListenerSlotTable
+
+int32 FGameplayMessageRouter::FListenerSlotTable::Allocate()
+{
+	int32 Index;
+	if (FreeSlots.Num() > 0)
+	{
+		Index = FreeSlots.Pop(EAllowShrinking::No);
+	}
+	else
+	{
+		Index = NumSlots++;
+		if (Index / SlotsPerPage >= Pages.Num())
+		{
+			Pages.Add(MakeUnique<FListenerSlot[]>(SlotsPerPage));
+		}
+	}
+
+	(*this)[Index].bInUse = true;
+	return Index;
+}
+
+void FGameplayMessageRouter::FListenerSlotTable::Reserve(int32 NumToAllocate)
+{
+	const int32 NumNewSlots = NumToAllocate - FreeSlots.Num();
+	if (NumNewSlots > 0)
+	{
+		const int32 NumPages = (NumSlots + NumNewSlots + SlotsPerPage - 1) / SlotsPerPage;
+		Pages.Reserve(NumPages);
+		while (Pages.Num() < NumPages)
+		{
+			Pages.Add(MakeUnique<FListenerSlot[]>(SlotsPerPage));
+		}
+	}
+}
+
+void FGameplayMessageRouter::FListenerSlotTable::Free(int32 Index)
+{
+	FListenerSlot& Slot = (*this)[Index];
+	Slot.Listener = FGameplayMessageListenerData();
+	Slot.StructType = nullptr;
+	Slot.TargetKey = FObjectKey();
+	Slot.bInUse = false;
+	Slot.bIndexed = false;
+	FreeSlots.Add(Index);
+}
+
+void FGameplayMessageRouter::FListenerSlotTable::Reset()
+{
+	Pages.Reset();
+	FreeSlots.Reset();
+	NumSlots = 0;
+}
+
+SIZE_T FGameplayMessageRouter::FListenerSlotTable::GetAllocatedSize() const
+{
+	return Pages.GetAllocatedSize() + Pages.Num() * SlotsPerPage * sizeof(FListenerSlot) + FreeSlots.GetAllocatedSize();
+}
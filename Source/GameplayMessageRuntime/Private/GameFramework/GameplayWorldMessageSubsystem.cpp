@@ -1,10 +1,21 @@
 ﻿// Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "GameFramework/GameplayWorldMessageSubsystem.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/Sort.h"
+#include "Algo/StableSort.h"
+#include "Components/SceneComponent.h"
 #include "Engine/Engine.h"
 #include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/GameplayMessageCapture.h"
+#include "GameFramework/GameplayMessageRelayComponent.h"
+#include "GameFramework/GameplayMessageSettings.h"
+#include "GameFramework/GameplayMessageStats.h"
+#include "Misc/OutputDevice.h"
 #include "UObject/ScriptMacros.h"
 #include "UObject/Stack.h"
+#include "UObject/UObjectGlobals.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(GameplayWorldMessageSubsystem)
 
@@ -20,38 +31,52 @@ namespace UE
 		static FAutoConsoleVariableRef CVarShouldLogMessages(TEXT("GameplayWorldMessageSubsystem.LogMessages"),
 			ShouldLogMessages,
 			TEXT("Should spatial messages broadcast through the gameplay world message subsystem be logged?"));
+
+		// Compacting rehashes the map, only worth it once most of its element slots have been freed
+		template <typename MapType>
+		static bool CompactIfSparse(MapType& Map)
+		{
+			if (Map.GetMaxIndex() <= 2 * Map.Num() + 4)
+			{
+				return false;
+			}
+
+			Map.Compact();
+			Map.Shrink();
+			return true;
+		}
 		
 		// Grid coordinate conversion functions
-		int64 GetGridID(const FVector& WorldPosition)
+		int64 GetGridID(const FVector& WorldPosition, float CellSize)
 		{
-			int32 GridX = FMath::FloorToInt(WorldPosition.X / GRID_SIZE);
-			int32 GridY = FMath::FloorToInt(WorldPosition.Y / GRID_SIZE);
+			int32 GridX = FMath::FloorToInt(WorldPosition.X / CellSize);
+			int32 GridY = FMath::FloorToInt(WorldPosition.Y / CellSize);
 			
 			// Pack X and Y into a single 64-bit integer (high 32 bits = X, low 32 bits = Y)
 			return (static_cast<int64>(GridX) << 32) | (static_cast<int64>(GridY) & 0xFFFFFFFF);
 		}
 		
-		FVector GetGridCenter(int64 GridID)
+		FVector GetGridCenter(int64 GridID, float CellSize)
 		{
 			int32 GridX = static_cast<int32>(GridID >> 32);
 			int32 GridY = static_cast<int32>(GridID & 0xFFFFFFFF);
 			
 			return FVector(
-				(GridX + 0.5f) * GRID_SIZE,
-				(GridY + 0.5f) * GRID_SIZE,
+				(GridX + 0.5f) * CellSize,
+				(GridY + 0.5f) * CellSize,
 				0.0f
 			);
 		}
 		
-		TArray<int64> GetGridsInRadius(const FVector& Center, float Radius)
+		TArray<int64> GetGridsInRadius(const FVector& Center, float Radius, float CellSize)
 		{
 			TArray<int64> GridIDs;
 			
 			// Calculate the grid bounds that could contain points within the radius
-			int32 MinGridX = FMath::FloorToInt((Center.X - Radius) / GRID_SIZE);
-			int32 MaxGridX = FMath::FloorToInt((Center.X + Radius) / GRID_SIZE);
-			int32 MinGridY = FMath::FloorToInt((Center.Y - Radius) / GRID_SIZE);
-			int32 MaxGridY = FMath::FloorToInt((Center.Y + Radius) / GRID_SIZE);
+			int32 MinGridX = FMath::FloorToInt((Center.X - Radius) / CellSize);
+			int32 MaxGridX = FMath::FloorToInt((Center.X + Radius) / CellSize);
+			int32 MinGridY = FMath::FloorToInt((Center.Y - Radius) / CellSize);
+			int32 MaxGridY = FMath::FloorToInt((Center.Y + Radius) / CellSize);
 			
 			// Check each grid cell in the bounding box
 			for (int32 GridX = MinGridX; GridX <= MaxGridX; ++GridX)
@@ -59,8 +84,8 @@ namespace UE
 				for (int32 GridY = MinGridY; GridY <= MaxGridY; ++GridY)
 				{
 					// Calculate the closest point in this grid to the center
-					FVector GridMin(GridX * GRID_SIZE, GridY * GRID_SIZE, 0.0f);
-					FVector GridMax((GridX + 1) * GRID_SIZE, (GridY + 1) * GRID_SIZE, 0.0f);
+					FVector GridMin(GridX * CellSize, GridY * CellSize, 0.0f);
+					FVector GridMax((GridX + 1) * CellSize, (GridY + 1) * CellSize, 0.0f);
 					
 					FVector ClosestPoint;
 					ClosestPoint.X = FMath::Clamp(Center.X, GridMin.X, GridMax.X);
@@ -79,6 +104,71 @@ namespace UE
 			
 			return GridIDs;
 		}
+
+		static constexpr int32 GRID_AXIS_BITS = 21;
+		static constexpr int64 GRID_AXIS_MASK = (int64(1) << GRID_AXIS_BITS) - 1;
+
+		static int64 PackGridID3D(int32 GridX, int32 GridY, int32 GridZ)
+		{
+			// Each axis keeps its low 21 bits (two's complement), high to low: X, Y, Z
+			return ((GridX & GRID_AXIS_MASK) << (2 * GRID_AXIS_BITS)) | ((GridY & GRID_AXIS_MASK) << GRID_AXIS_BITS) | (GridZ & GRID_AXIS_MASK);
+		}
+
+		static int32 UnpackGridAxis(int64 GridID, int32 Shift)
+		{
+			// Sign extend the 21 bit coordinate
+			const int64 Value = (GridID >> Shift) & GRID_AXIS_MASK;
+			return static_cast<int32>((Value ^ (int64(1) << (GRID_AXIS_BITS - 1))) - (int64(1) << (GRID_AXIS_BITS - 1)));
+		}
+
+		int64 GetGridID3D(const FVector& WorldPosition, float CellSize, float CellHeight)
+		{
+			return PackGridID3D(
+				FMath::FloorToInt(WorldPosition.X / CellSize),
+				FMath::FloorToInt(WorldPosition.Y / CellSize),
+				FMath::FloorToInt(WorldPosition.Z / CellHeight));
+		}
+
+		FVector GetGridCenter3D(int64 GridID, float CellSize, float CellHeight)
+		{
+			return FVector(
+				(UnpackGridAxis(GridID, 2 * GRID_AXIS_BITS) + 0.5f) * CellSize,
+				(UnpackGridAxis(GridID, GRID_AXIS_BITS) + 0.5f) * CellSize,
+				(UnpackGridAxis(GridID, 0) + 0.5f) * CellHeight
+			);
+		}
+
+		TArray<int64> GetGridsInSphere(const FVector& Center, float Radius, float CellSize, float CellHeight)
+		{
+			TArray<int64> GridIDs;
+
+			const int32 MinGridX = FMath::FloorToInt((Center.X - Radius) / CellSize);
+			const int32 MaxGridX = FMath::FloorToInt((Center.X + Radius) / CellSize);
+			const int32 MinGridY = FMath::FloorToInt((Center.Y - Radius) / CellSize);
+			const int32 MaxGridY = FMath::FloorToInt((Center.Y + Radius) / CellSize);
+			const int32 MinGridZ = FMath::FloorToInt((Center.Z - Radius) / CellHeight);
+			const int32 MaxGridZ = FMath::FloorToInt((Center.Z + Radius) / CellHeight);
+
+			// Keep the cells of the bounding box whose box intersects the sphere
+			for (int32 GridX = MinGridX; GridX <= MaxGridX; ++GridX)
+			{
+				const double DistX = Center.X - FMath::Clamp<double>(Center.X, GridX * CellSize, (GridX + 1) * CellSize);
+				for (int32 GridY = MinGridY; GridY <= MaxGridY; ++GridY)
+				{
+					const double DistY = Center.Y - FMath::Clamp<double>(Center.Y, GridY * CellSize, (GridY + 1) * CellSize);
+					for (int32 GridZ = MinGridZ; GridZ <= MaxGridZ; ++GridZ)
+					{
+						const double DistZ = Center.Z - FMath::Clamp<double>(Center.Z, GridZ * CellHeight, (GridZ + 1) * CellHeight);
+						if (DistX * DistX + DistY * DistY + DistZ * DistZ <= Radius * Radius)
+						{
+							GridIDs.Add(PackGridID3D(GridX, GridY, GridZ));
+						}
+					}
+				}
+			}
+
+			return GridIDs;
+		}
 	}
 }
 
@@ -115,16 +205,119 @@ bool UGameplayWorldMessageSubsystem::HasInstance(const UObject* WorldContextObje
 	return Router != nullptr;
 }
 
+void UGameplayWorldMessageSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	SetGridSettings(GetDefault<UGameplayMessageSettings>()->GetWorldGridSettings(GetWorld()));
+
+	FCoreUObjectDelegates::GetPostGarbageCollect().AddUObject(this, &ThisClass::CompactListenerStorage);
+}
+
 void UGameplayWorldMessageSubsystem::Deinitialize()
 {
-	GridListenerMap.Reset();
-	HandleToSpatialMap.Reset();
+	FCoreUObjectDelegates::GetPostGarbageCollect().RemoveAll(this);
+
+	Inbox.Reset();
+	MessageQueues[0].Reset();
+	MessageQueues[1].Reset();
+	GridLevels.Reset();
+	ListenerPool.Reset();
+	HandleToListenerIndex.Reset();
+	NumListenersByStructType.Reset();
+	CompatibleStructTypes.Reset();
+	PendingListenerChanges.Reset();
+	FollowedListeners.Reset();
+	RateLimiter.Reset();
+	AreaGatheredListeners.Empty();
 
 	Super::Deinitialize();
 }
 
+void UGameplayWorldMessageSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// Before dispatching anything so this tick's messages see where the followed components are now
+	UpdateFollowedListeners();
+
+	[[maybe_unused]] const int32 NumInboxMessages = Inbox.Drain([this](FQueuedGameplayMessage& Message)
+	{
+		BroadcastMessageInternal(Message.Channel, Message.StructType, Message.Payload, Message.WorldPosition);
+	});
+	INC_DWORD_STAT_BY(STAT_GameplayMessages_InboxMessages, NumInboxMessages);
+
+	FlushQueuedMessages();
+
+	// Budgets scoped to grid cells would otherwise pile up until the next compaction
+	RateLimiter.PruneExpired();
+}
+
+TStatId UGameplayWorldMessageSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGameplayWorldMessageSubsystem, STATGROUP_Tickables);
+}
+
+void UGameplayWorldMessageSubsystem::QueueMessageInternal(FGameplayTag Channel, const UScriptStruct* StructType, const void* MessageBytes, const FVector& WorldPosition, FGameplayMessageQueuedCallback&& OnComplete)
+{
+	FQueuedGameplayMessage& Message = MessageQueues[ActiveQueueIndex].Enqueue(StructType, MessageBytes, Channel);
+	Message.WorldPosition = WorldPosition;
+	Message.OnComplete = MoveTemp(OnComplete);
+}
+
+void UGameplayWorldMessageSubsystem::FlushQueuedMessages()
+{
+	FGameplayMessageQueue& Queue = MessageQueues[ActiveQueueIndex];
+	if (bFlushingQueue || Queue.IsEmpty())
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_GameplayMessages_FlushQueue);
+	TGuardValue<bool> FlushGuard(bFlushingQueue, true);
+
+	// Anything queued by the listeners below goes to the other buffer
+	ActiveQueueIndex ^= 1;
+
+	INC_DWORD_STAT_BY(STAT_GameplayMessages_QueueDepth, Queue.Num());
+
+	// Dispatch same type/channel runs back to back so the listener records they touch stay in cache
+	Queue.SortForDispatch();
+	for (FQueuedGameplayMessage& Message : Queue.GetMessages())
+	{
+		const FGameplayMessageBroadcastResult Result = BroadcastMessageInternal(Message.Channel, Message.StructType, Message.Payload, Message.WorldPosition);
+		if (Message.OnComplete)
+		{
+			Message.OnComplete(Result);
+		}
+	}
+
+	Queue.Reset();
+}
+
 FGameplayMessageBroadcastResult UGameplayWorldMessageSubsystem::BroadcastMessageInternal(FGameplayTag Channel, const UScriptStruct* StructType, void* MessageBytes, const FVector& WorldPosition)
 {
+	SCOPE_CYCLE_COUNTER(STAT_GameplayMessages_Broadcast);
+	UE::GameplayMessage::Private::FMessageTraceScope TraceScope(TEXT("BroadcastWorldMessage"), Channel, StructType);
+	INC_DWORD_STAT(STAT_GameplayMessages_Broadcasts);
+
+	if (IsThrottled(Channel, WorldPosition))
+	{
+		FGameplayMessageBroadcastResult ThrottledResult;
+		ThrottledResult.bThrottled = true;
+		return ThrottledResult;
+	}
+
+	if (FGameplayMessageCapture::IsEnabled())
+	{
+		FGameplayMessageCapture::Get().Record(EGameplayMessageCaptureRouter::World, Channel, StructType, MessageBytes, nullptr, WorldPosition);
+	}
+
+	if (UGameplayMessageRelayComponent::HasServerRelays())
+	{
+		UGameplayMessageRelayComponent::RelayMessage(GetWorld(), EGameplayMessageCaptureRouter::World, Channel, StructType, MessageBytes, nullptr, WorldPosition);
+	}
+
 	// Log the message if enabled
 	if (UE::GameplayWorldMessageSubsystem::ShouldLogMessages != 0)
 	{
@@ -146,68 +339,371 @@ FGameplayMessageBroadcastResult UGameplayWorldMessageSubsystem::BroadcastMessage
 			*WorldPosition.ToString());
 	}
 
-	// Reset State
-	BroadcastResultCache.Reset();
+	// Reset State, the enclosing broadcast's result is restored on return
+	TGuardValue<FGameplayMessageBroadcastResult> ResultScope(BroadcastResultCache, FGameplayMessageBroadcastResult());
+
+	// Listeners of StructType and of each of its parents, copied since nested broadcasts may add to the table
+	const TArray<const UScriptStruct*, TInlineAllocator<4>> ListenerStructTypes(GetCompatibleStructTypes(StructType));
+	if (ListenerStructTypes.Num() == 0)
+	{
+		return BroadcastResultCache;
+	}
 
 	// 优化：只查找广播位置所在的网格，因为监听者已经在注册时覆盖了其监听半径内的所有网格
-	int64 BroadcastGridID = UE::GameplayWorldMessageSubsystem::GetGridID(WorldPosition);
+	// Each level holds listeners of a different size, the broadcast cell of every non-empty level is visited
+	TArray<const FGridListenerList*, TInlineAllocator<8>> Cells;
+	for (const FGridLevel& Level : GridLevels)
+	{
+		if (Level.Cells.Num() == 0)
+		{
+			continue;
+		}
+
+		INC_DWORD_STAT(STAT_GameplayMessages_GridCellsTouched);
+		if (const FGridListenerList* pList = Level.Cells.Find(GetCellID(Level, WorldPosition)))
+		{
+			Cells.Add(pList);
+		}
+	}
 
-	// 从广播位置所在的网格中获取所有监听者
-	const FGridListenerList* pList = GridListenerMap.Find(BroadcastGridID);
-	if (!pList)
+	if (Cells.Num() == 0)
 	{
 		// 没有监听者在这个网格中，直接返回
 		return BroadcastResultCache;
 	}
 
-	// 复制监听者列表以防在回调过程中发生修改
-	TArray<FGameplayWorldMessageListenerData> ListenerArray(pList->Listeners);
+	// Cells are iterated in place, any listener change made by a callback is deferred until the outermost broadcast returns
+	++BroadcastDepth;
+
+	// Cull every cell by distance and struct type on its packed arrays first, only survivors touch the listener records
+	struct FSurvivorRange
+	{
+		int32 Next = 0;
+		int32 End = 0;
+	};
+	TArray<int32, TInlineAllocator<256>> Survivors;
+	TArray<float, TInlineAllocator<256>> SurvivorDistancesSquared;
+	TArray<FSurvivorRange, TInlineAllocator<8>> Ranges;
+	[[maybe_unused]] int32 NumVisited = 0;
+	[[maybe_unused]] int32 NumInvoked = 0;
+	for (const FGridListenerList* Cell : Cells)
+	{
+		FSurvivorRange& Range = Ranges.AddDefaulted_GetRef();
+		Range.Next = Survivors.Num();
+		Cell->CullEntries(WorldPosition, ListenerStructTypes, Survivors, SurvivorDistancesSquared);
+		Range.End = Survivors.Num();
+		NumVisited += Cell->Num();
+	}
 
-	// 处理监听者（已经按优先级排序）
-	for (const FGameplayWorldMessageListenerData& Listener : ListenerArray)
+	// 处理监听者（已经按优先级排序）, cells of different levels are merged by priority, finer levels first on ties
+	for (;;)
 	{
-		if (!Listener.ListenerStructType.IsValid())
+		int32 BestCell = INDEX_NONE;
+		int32 BestPriority = 0;
+		for (int32 CellIndex = 0; CellIndex < Cells.Num(); ++CellIndex)
 		{
-			UE_LOG(LogGameplayWorldMessageSubsystem, Warning, TEXT("Listener struct type has gone invalid on Channel %s. Removing listener from list"), *Channel.ToString());
-			UnregisterListenerInternal(StructType, Listener.HandleID);
-			continue;
+			const FSurvivorRange& Range = Ranges[CellIndex];
+			if (Range.Next < Range.End)
+			{
+				const int32 Priority = Cells[CellIndex]->Listeners[Survivors[Range.Next]].Priority;
+				if (BestCell == INDEX_NONE || Priority < BestPriority)
+				{
+					BestCell = CellIndex;
+					BestPriority = Priority;
+				}
+			}
 		}
 
-		// 检查结构体类型是否匹配
-		if (StructType != Listener.ListenerStructType.Get())
+		if (BestCell == INDEX_NONE)
 		{
-			continue;
+			break;
 		}
 
-		// 检查广播位置是否在监听者的监听半径内（精确距离检查）
-		float DistanceSquared = FVector::DistSquared(WorldPosition, Listener.ListenPosition);
-		if (DistanceSquared > Listener.ListenRadius * Listener.ListenRadius)
+		const int32 SurvivorIndex = Ranges[BestCell].Next++;
+		const FGridListenerEntry& Entry = Cells[BestCell]->Listeners[Survivors[SurvivorIndex]];
+		if (DispatchToListener(Entry.ListenerIndex, Channel, StructType, ListenerStructTypes, MessageBytes, SurvivorDistancesSquared[SurvivorIndex]))
 		{
-			continue;
+			++NumInvoked;
+
+			// 检查消息是否被中断
+			if (BroadcastResultCache.bInterrupted)
+			{
+				break;
+			}
+		}
+	}
+
+	if (--BroadcastDepth == 0 && PendingListenerChanges.Num() > 0)
+	{
+		ApplyPendingListenerChanges();
+	}
+
+	INC_DWORD_STAT_BY(STAT_GameplayMessages_ListenersVisited, NumVisited);
+	INC_DWORD_STAT_BY(STAT_GameplayMessages_ListenersInvoked, NumInvoked);
+	if (BroadcastResultCache.bCancelled)
+	{
+		INC_DWORD_STAT(STAT_GameplayMessages_Cancellations);
+	}
+
+	return BroadcastResultCache;
+}
+
+double UGameplayWorldMessageSubsystem::FBroadcastArea::GetDistanceSquared(const FVector& ListenPosition) const
+{
+	if (SphereRadius >= 0.0)
+	{
+		const double Distance = FMath::Max(FVector::Dist(SphereCenter, ListenPosition) - SphereRadius, 0.0);
+		return Distance * Distance;
+	}
+
+	return Bounds.ComputeSquaredDistanceToPoint(ListenPosition);
+}
+
+FGameplayMessageBroadcastResult UGameplayWorldMessageSubsystem::BroadcastMessageInAreaInternal(FGameplayTag Channel, const UScriptStruct* StructType, void* MessageBytes, const FBroadcastArea& Area)
+{
+	SCOPE_CYCLE_COUNTER(STAT_GameplayMessages_Broadcast);
+	UE::GameplayMessage::Private::FMessageTraceScope TraceScope(TEXT("BroadcastWorldMessageInArea"), Channel, StructType);
+	INC_DWORD_STAT(STAT_GameplayMessages_Broadcasts);
+
+	if (IsThrottled(Channel, Area.Bounds.GetCenter()))
+	{
+		FGameplayMessageBroadcastResult ThrottledResult;
+		ThrottledResult.bThrottled = true;
+		return ThrottledResult;
+	}
+
+	if (FGameplayMessageCapture::IsEnabled())
+	{
+		if (Area.SphereRadius >= 0.0)
+		{
+			FGameplayMessageCapture::Get().Record(EGameplayMessageCaptureRouter::World, Channel, StructType, MessageBytes, nullptr, Area.SphereCenter, EGameplayMessageCaptureShape::Sphere, FVector(Area.SphereRadius, 0.0, 0.0));
+		}
+		else
+		{
+			FGameplayMessageCapture::Get().Record(EGameplayMessageCaptureRouter::World, Channel, StructType, MessageBytes, nullptr, Area.Bounds.GetCenter(), EGameplayMessageCaptureShape::Box, Area.Bounds.GetExtent());
+		}
+	}
+
+	// Log the message if enabled
+	if (UE::GameplayWorldMessageSubsystem::ShouldLogMessages != 0)
+	{
+		FString* pContextString = nullptr;
+#if WITH_EDITOR
+		if (GIsEditor)
+		{
+			extern ENGINE_API FString GPlayInEditorContextString;
+			pContextString = &GPlayInEditorContextString;
+		}
+#endif
+
+		FString HumanReadableMessage;
+		StructType->ExportText(/*out*/ HumanReadableMessage, MessageBytes, /*Defaults=*/ nullptr, /*OwnerObject=*/ nullptr, PPF_None, /*ExportRootScope=*/ nullptr);
+		UE_LOG(LogGameplayWorldMessageSubsystem, Log, TEXT("BroadcastAreaMessage(%s, %s, %s, %s)"),
+			pContextString ? **pContextString : *GetPathNameSafe(this),
+			*Channel.ToString(),
+			*HumanReadableMessage,
+			*Area.Bounds.ToString());
+	}
+
+	// Reset State, the enclosing broadcast's result is restored on return
+	TGuardValue<FGameplayMessageBroadcastResult> ResultScope(BroadcastResultCache, FGameplayMessageBroadcastResult());
+
+	const TArray<const UScriptStruct*, TInlineAllocator<4>> ListenerStructTypes(GetCompatibleStructTypes(StructType));
+	if (ListenerStructTypes.Num() == 0)
+	{
+		return BroadcastResultCache;
+	}
+
+	struct FAreaCandidate
+	{
+		int32 ListenerIndex;
+		int32 Priority;
+		float DistanceSquared;
+	};
+
+	// A listener overlapping the area is stored in at least one cell overlapping its bounds, gather those cells once.
+	// Listeners covering several of them are only kept the first time they are seen.
+	TArray<FAreaCandidate, TInlineAllocator<64>> Candidates;
+	TArray<int32, TInlineAllocator<64>> GatheredListeners;
+	if (AreaGatheredListeners.Num() < ListenerPool.GetMaxIndex())
+	{
+		AreaGatheredListeners.Add(false, ListenerPool.GetMaxIndex() - AreaGatheredListeners.Num());
+	}
+
+	[[maybe_unused]] int32 NumVisited = 0;
+	[[maybe_unused]] int32 NumInvoked = 0;
+	auto GatherCell = [&](const FGridListenerList& Cell)
+	{
+		INC_DWORD_STAT(STAT_GameplayMessages_GridCellsTouched);
+		NumVisited += Cell.Num();
+		for (int32 EntryIndex = 0; EntryIndex < Cell.Num(); ++EntryIndex)
+		{
+			const int32 ListenerIndex = Cell.Listeners[EntryIndex].ListenerIndex;
+			if (AreaGatheredListeners[ListenerIndex] || !ListenerStructTypes.Contains(Cell.StructTypes[EntryIndex]))
+			{
+				continue;
+			}
+
+			AreaGatheredListeners[ListenerIndex] = true;
+			GatheredListeners.Add(ListenerIndex);
+
+			const FVector ListenPosition = Cell.Origin + FVector(Cell.PositionX[EntryIndex], Cell.PositionY[EntryIndex], Cell.PositionZ[EntryIndex]);
+			const float DistanceSquared = static_cast<float>(Area.GetDistanceSquared(ListenPosition));
+			if (DistanceSquared <= Cell.RadiusSquared[EntryIndex])
+			{
+				Candidates.Add({ ListenerIndex, Cell.Listeners[EntryIndex].Priority, DistanceSquared });
+			}
 		}
+	};
 
-		// 检查Tag是否匹配
-		bool bMatchAny = Listener.MatchType == EGameplayMessageMatch::PartialMatch && Channel.MatchesTag(Listener.Channel);
-		bool bMatchExact = Listener.MatchType == EGameplayMessageMatch::ExactMatch && Channel.MatchesTagExact(Listener.Channel);
-		if (!bMatchAny && !bMatchExact)
+	for (const FGridLevel& Level : GridLevels)
+	{
+		if (Level.Cells.Num() == 0)
 		{
 			continue;
 		}
 
-		// 执行回调
-		Listener.ReceivedCallback(Channel, StructType, MessageBytes);
+		const UE::GameplayWorldMessageSubsystem::FGridCellRect Rect = GetAreaCellRect(Level, Area.Bounds);
+		const int64 NumRectCells = int64(Rect.MaxX - Rect.MinX + 1) * (Rect.MaxY - Rect.MinY + 1) * (Rect.MaxZ - Rect.MinZ + 1);
+		if (NumRectCells <= Level.Cells.Num())
+		{
+			for (int32 X = Rect.MinX; X <= Rect.MaxX; ++X)
+			{
+				for (int32 Y = Rect.MinY; Y <= Rect.MaxY; ++Y)
+				{
+					for (int32 Z = Rect.MinZ; Z <= Rect.MaxZ; ++Z)
+					{
+						if (const FGridListenerList* Cell = Level.Cells.Find(PackCellID(Level, X, Y, Z)))
+						{
+							GatherCell(*Cell);
+						}
+					}
+				}
+			}
+		}
+		else
+		{
+			// Areas spanning more cells than the level holds are cheaper to resolve from the occupied cells
+			for (const TPair<int64, FGridListenerList>& Pair : Level.Cells)
+			{
+				int32 X, Y, Z;
+				UnpackCellID(Level, Pair.Key, X, Y, Z);
+				if (Rect.Contains(X, Y, Z))
+				{
+					GatherCell(Pair.Value);
+				}
+			}
+		}
+	}
+
+	// Keep the bitset clear for the next area broadcast, touching only what was set
+	for (int32 ListenerIndex : GatheredListeners)
+	{
+		AreaGatheredListeners[ListenerIndex] = false;
+	}
+
+	if (Candidates.Num() == 0)
+	{
+		return BroadcastResultCache;
+	}
+
+	// Same order as a point broadcast: by priority, in the order the listeners were found for equal priorities
+	Algo::StableSortBy(Candidates, &FAreaCandidate::Priority);
+
+	++BroadcastDepth;
 
-		// 检查消息是否被中断
-		if (BroadcastResultCache.bInterrupted)
+	for (const FAreaCandidate& Candidate : Candidates)
+	{
+		if (DispatchToListener(Candidate.ListenerIndex, Channel, StructType, ListenerStructTypes, MessageBytes, Candidate.DistanceSquared))
 		{
-			break;
+			++NumInvoked;
+
+			// 检查消息是否被中断
+			if (BroadcastResultCache.bInterrupted)
+			{
+				break;
+			}
 		}
 	}
 
+	if (--BroadcastDepth == 0 && PendingListenerChanges.Num() > 0)
+	{
+		ApplyPendingListenerChanges();
+	}
+
+	INC_DWORD_STAT_BY(STAT_GameplayMessages_ListenersVisited, NumVisited);
+	INC_DWORD_STAT_BY(STAT_GameplayMessages_ListenersInvoked, NumInvoked);
+	if (BroadcastResultCache.bCancelled)
+	{
+		INC_DWORD_STAT(STAT_GameplayMessages_Cancellations);
+	}
+
 	return BroadcastResultCache;
 }
 
-FGameplayMessageBroadcastResult UGameplayWorldMessageSubsystem::K2_BroadcastMessage(FGameplayTag Channel, UPARAM(ref) int32& Message, FVector WorldPosition)
+bool UGameplayWorldMessageSubsystem::IsThrottled(FGameplayTag Channel, const FVector& WorldPosition)
+{
+	const FGameplayMessageRateLimit* RateLimit = RateLimiter.FindLimit(Channel);
+	if (!RateLimit)
+	{
+		return false;
+	}
+
+	const int64 GridCell = RateLimit->Scope == EGameplayMessageRateLimitScope::GridCell && GridLevels.Num() > 0 ? GetCellID(GridLevels[0], WorldPosition) : 0;
+	return !RateLimiter.TryConsume(*RateLimit, Channel, FObjectKey(), GridCell);
+}
+
+bool UGameplayWorldMessageSubsystem::DispatchToListener(int32 ListenerIndex, FGameplayTag Channel, const UScriptStruct* StructType, TConstArrayView<const UScriptStruct*> ListenerStructTypes, void* MessageBytes, float DistanceSquared)
+{
+	FGameplayWorldMessageListenerData& Listener = ListenerPool[ListenerIndex];
+
+	// Unregistered by an earlier callback of this (or an enclosing) broadcast
+	if (Listener.bPendingRemoval)
+	{
+		return false;
+	}
+
+	if (!Listener.ListenerStructType.IsValid())
+	{
+		UE_LOG(LogGameplayWorldMessageSubsystem, Warning, TEXT("Listener struct type has gone invalid on Channel %s. Removing listener from list"), *Channel.ToString());
+		UnregisterListenerInternal(StructType, Listener.HandleID);
+		return false;
+	}
+
+	// 检查结构体类型是否匹配, the cell's copy of the type may outlive a struct that has been reloaded
+	if (!ListenerStructTypes.Contains(Listener.ListenerStructType.Get()))
+	{
+		return false;
+	}
+
+	// 检查Tag是否匹配
+	bool bMatchAny = Listener.MatchType == EGameplayMessageMatch::PartialMatch && Channel.MatchesTag(Listener.Channel);
+	bool bMatchExact = Listener.MatchType == EGameplayMessageMatch::ExactMatch && Channel.MatchesTagExact(Listener.Channel);
+	if (!bMatchAny && !bMatchExact)
+	{
+		return false;
+	}
+
+	// Far tier: deliver the first message, then skip the next FarDeliveryInterval - 1
+	if (Listener.FarDeliveryInterval > 1 && DistanceSquared > Listener.InnerRadiusSquared)
+	{
+		if (Listener.NumFarMessagesToSkip > 0)
+		{
+			--Listener.NumFarMessagesToSkip;
+			INC_DWORD_STAT(STAT_GameplayMessages_FarDeliveriesSkipped);
+			return false;
+		}
+		Listener.NumFarMessagesToSkip = Listener.FarDeliveryInterval - 1;
+	}
+
+	// 执行回调, nested broadcasts from the callback restore the distance of this listener when they return
+	UE::GameplayMessage::Private::FMessageTraceScope ListenerTraceScope(TEXT("Listener"), Listener.Channel, StructType);
+	TGuardValue<float> DistanceGuard(CurrentListenerDistanceSquared, DistanceSquared);
+	Listener.ReceivedCallback(Channel, StructType, MessageBytes);
+	return true;
+}
+
+FGameplayMessageBroadcastResult UGameplayWorldMessageSubsystem::K2_BroadcastMessageInSphere(FGameplayTag Channel, UPARAM(ref) int32& Message, FVector Center, float Radius)
 {
 	// This will never be called, the exec version below will be hit instead
 	checkNoEntry();
@@ -215,7 +711,7 @@ FGameplayMessageBroadcastResult UGameplayWorldMessageSubsystem::K2_BroadcastMess
 	return FGameplayMessageBroadcastResult();
 }
 
-DEFINE_FUNCTION(UGameplayWorldMessageSubsystem::execK2_BroadcastMessage)
+DEFINE_FUNCTION(UGameplayWorldMessageSubsystem::execK2_BroadcastMessageInSphere)
 {
 	P_GET_STRUCT(FGameplayTag, Channel);
 
@@ -224,20 +720,21 @@ DEFINE_FUNCTION(UGameplayWorldMessageSubsystem::execK2_BroadcastMessage)
 	void* MessagePtr = Stack.MostRecentPropertyAddress;
 	FStructProperty* StructProp = CastField<FStructProperty>(Stack.MostRecentProperty);
 
-	P_GET_STRUCT(FVector, WorldPosition);
+	P_GET_STRUCT(FVector, Center);
+	P_GET_PROPERTY(FFloatProperty, Radius);
 
 	P_FINISH;
 
 	FGameplayMessageBroadcastResult Result;
 	if (ensure((StructProp != nullptr) && (StructProp->Struct != nullptr) && (MessagePtr != nullptr)))
 	{
-		Result = P_THIS->BroadcastMessageInternal(Channel, StructProp->Struct, MessagePtr, WorldPosition);
+		Result = P_THIS->BroadcastMessageInAreaInternal(Channel, StructProp->Struct, MessagePtr, FBroadcastArea(FSphere(Center, Radius)));
 	}
 
 	*(FGameplayMessageBroadcastResult*)RESULT_PARAM = Result;
 }
 
-FGameplayMessageBroadcastResult UGameplayWorldMessageSubsystem::K2_BroadcastSimpleMessage(UPARAM(ref) int32& Message, FVector WorldPosition)
+FGameplayMessageBroadcastResult UGameplayWorldMessageSubsystem::K2_BroadcastMessageInBox(FGameplayTag Channel, UPARAM(ref) int32& Message, FVector Center, FVector Extent)
 {
 	// This will never be called, the exec version below will be hit instead
 	checkNoEntry();
@@ -245,87 +742,764 @@ FGameplayMessageBroadcastResult UGameplayWorldMessageSubsystem::K2_BroadcastSimp
 	return FGameplayMessageBroadcastResult();
 }
 
-DEFINE_FUNCTION(UGameplayWorldMessageSubsystem::execK2_BroadcastSimpleMessage)
+DEFINE_FUNCTION(UGameplayWorldMessageSubsystem::execK2_BroadcastMessageInBox)
 {
+	P_GET_STRUCT(FGameplayTag, Channel);
+
 	Stack.MostRecentPropertyAddress = nullptr;
 	Stack.StepCompiledIn<FStructProperty>(nullptr);
 	void* MessagePtr = Stack.MostRecentPropertyAddress;
 	FStructProperty* StructProp = CastField<FStructProperty>(Stack.MostRecentProperty);
 
-	P_GET_STRUCT(FVector, WorldPosition);
+	P_GET_STRUCT(FVector, Center);
+	P_GET_STRUCT(FVector, Extent);
 
 	P_FINISH;
 
 	FGameplayMessageBroadcastResult Result;
 	if (ensure((StructProp != nullptr) && (StructProp->Struct != nullptr) && (MessagePtr != nullptr)))
 	{
-		Result = P_THIS->BroadcastMessageInternal(UE::GameplayWorldMessageSubsystem::TAG_DefaultMessageChannel, StructProp->Struct, MessagePtr, WorldPosition);
+		Result = P_THIS->BroadcastMessageInAreaInternal(Channel, StructProp->Struct, MessagePtr, FBroadcastArea(FBox::BuildAABB(Center, Extent)));
 	}
 
 	*(FGameplayMessageBroadcastResult*)RESULT_PARAM = Result;
 }
 
-FGameplayWorldMessageListenerHandle UGameplayWorldMessageSubsystem::RegisterListenerInternal(
+FGameplayMessageBroadcastResult UGameplayWorldMessageSubsystem::K2_BroadcastMessage(FGameplayTag Channel, UPARAM(ref) int32& Message, FVector WorldPosition)
+{
+	// This will never be called, the exec version below will be hit instead
+	checkNoEntry();
+
+	return FGameplayMessageBroadcastResult();
+}
+
+DEFINE_FUNCTION(UGameplayWorldMessageSubsystem::execK2_BroadcastMessage)
+{
+	P_GET_STRUCT(FGameplayTag, Channel);
+
+	Stack.MostRecentPropertyAddress = nullptr;
+	Stack.StepCompiledIn<FStructProperty>(nullptr);
+	void* MessagePtr = Stack.MostRecentPropertyAddress;
+	FStructProperty* StructProp = CastField<FStructProperty>(Stack.MostRecentProperty);
+
+	P_GET_STRUCT(FVector, WorldPosition);
+
+	P_FINISH;
+
+	FGameplayMessageBroadcastResult Result;
+	if (ensure((StructProp != nullptr) && (StructProp->Struct != nullptr) && (MessagePtr != nullptr)))
+	{
+		Result = P_THIS->BroadcastMessageInternal(Channel, StructProp->Struct, MessagePtr, WorldPosition);
+	}
+
+	*(FGameplayMessageBroadcastResult*)RESULT_PARAM = Result;
+}
+
+FGameplayMessageBroadcastResult UGameplayWorldMessageSubsystem::K2_BroadcastSimpleMessage(UPARAM(ref) int32& Message, FVector WorldPosition)
+{
+	// This will never be called, the exec version below will be hit instead
+	checkNoEntry();
+
+	return FGameplayMessageBroadcastResult();
+}
+
+DEFINE_FUNCTION(UGameplayWorldMessageSubsystem::execK2_BroadcastSimpleMessage)
+{
+	Stack.MostRecentPropertyAddress = nullptr;
+	Stack.StepCompiledIn<FStructProperty>(nullptr);
+	void* MessagePtr = Stack.MostRecentPropertyAddress;
+	FStructProperty* StructProp = CastField<FStructProperty>(Stack.MostRecentProperty);
+
+	P_GET_STRUCT(FVector, WorldPosition);
+
+	P_FINISH;
+
+	FGameplayMessageBroadcastResult Result;
+	if (ensure((StructProp != nullptr) && (StructProp->Struct != nullptr) && (MessagePtr != nullptr)))
+	{
+		Result = P_THIS->BroadcastMessageInternal(UE::GameplayWorldMessageSubsystem::TAG_DefaultMessageChannel, StructProp->Struct, MessagePtr, WorldPosition);
+	}
+
+	*(FGameplayMessageBroadcastResult*)RESULT_PARAM = Result;
+}
+
+FGameplayWorldMessageListenerHandle UGameplayWorldMessageSubsystem::RegisterListenerInternal(
 	FGameplayTag Channel, 
-	TFunction<void(FGameplayTag, const UScriptStruct*, void*)>&& Callback,
+	FGameplayMessageCallback&& Callback,
 	const UScriptStruct* StructType,
 	EGameplayMessageMatch MatchType,
 	int32 Priority,
 	const FVector& ListenPosition,
-	float ListenRadius)
+	float ListenRadius,
+	float InnerRadius,
+	int32 FarDeliveryInterval)
+{
+	// Create listener data
+	FGameplayWorldMessageListenerData ListenerData;
+	ListenerData.ReceivedCallback = MoveTemp(Callback);
+	ListenerData.ListenerStructType = StructType;
+	ListenerData.Channel = Channel;
+	ListenerData.MatchType = MatchType;
+	ListenerData.Priority = static_cast<uint8>(FMath::Clamp<int32>(Priority, 0, MAX_uint8));
+	ListenerData.ListenPosition = ListenPosition;
+	ListenerData.ListenRadius = ListenRadius;
+	if (InnerRadius >= 0.0f && FarDeliveryInterval > 1)
+	{
+		ListenerData.InnerRadiusSquared = InnerRadius * InnerRadius;
+		ListenerData.FarDeliveryInterval = static_cast<uint16>(FMath::Min<int32>(FarDeliveryInterval, MAX_uint16));
+	}
+
+	// Generate unique handle ID
+	static int32 GlobalHandleID = 0;
+	ListenerData.HandleID = ++GlobalHandleID;
+
+	const int32 HandleID = ListenerData.HandleID;
+
+	if (BroadcastDepth > 0)
+	{
+		// A broadcast is iterating a cell, the listener will start receiving messages once it returns
+		FPendingListenerChange& Change = PendingListenerChanges.AddDefaulted_GetRef();
+		Change.Type = EPendingListenerChange::Register;
+		Change.HandleID = HandleID;
+		Change.Listener.Emplace(MoveTemp(ListenerData));
+	}
+	else
+	{
+		AddListenerToGrids(MoveTemp(ListenerData));
+	}
+
+	return FGameplayWorldMessageListenerHandle(this, StructType, HandleID);
+}
+
+void UGameplayWorldMessageSubsystem::AddListenerToGrids(FGameplayWorldMessageListenerData&& ListenerData)
+{
+	// Routers created outside of a world have not been configured yet
+	if (GridLevels.Num() == 0)
+	{
+		SetGridSettings(GetDefault<UGameplayMessageSettings>()->DefaultWorldGrid);
+	}
+
+	// Get all grids that this listener could potentially receive messages from
+	ListenerData.GridLevel = static_cast<uint8>(SelectGridLevel(ListenerData.ListenRadius));
+	FGridLevel& Level = GridLevels[ListenerData.GridLevel];
+	ListenerData.CellRect = GetListenerCellRect(Level, ListenerData.ListenPosition, ListenerData.ListenRadius);
+
+	const int32 HandleID = ListenerData.HandleID;
+	const UE::GameplayWorldMessageSubsystem::FGridCellRect Rect = ListenerData.CellRect;
+
+	// The listener itself is stored once, cells only keep its pool index and the data needed for culling
+	ListenerData.StructTypeKey = ListenerData.ListenerStructType.Get();
+	int32& NumStructListeners = NumListenersByStructType.FindOrAdd(ListenerData.StructTypeKey);
+	if (NumStructListeners++ == 0)
+	{
+		// A new listener struct type, broadcasts of its child types have to resolve their compatible types again
+		CompatibleStructTypes.Reset();
+	}
+
+	const int32 ListenerIndex = ListenerPool.Add(MoveTemp(ListenerData));
+	HandleToListenerIndex.Add(HandleID, ListenerIndex);
+	const FGameplayWorldMessageListenerData& Listener = ListenerPool[ListenerIndex];
+
+	// Add listener to all relevant grids
+	for (int32 X = Rect.MinX; X <= Rect.MaxX; ++X)
+	{
+		for (int32 Y = Rect.MinY; Y <= Rect.MaxY; ++Y)
+		{
+			for (int32 Z = Rect.MinZ; Z <= Rect.MaxZ; ++Z)
+			{
+				const int64 GridID = PackCellID(Level, X, Y, Z);
+				FGridListenerList& Cell = Level.Cells.FindOrAdd(GridID);
+				if (ListenerBatchDepth == 0)
+				{
+					InsertGridEntry(Cell, ListenerIndex, Listener);
+				}
+				else
+				{
+					if (Cell.Num() > 0 && Cell.Listeners.Last().Priority > Listener.Priority)
+					{
+						UnsortedCells.Emplace(Listener.GridLevel, GridID);
+					}
+					Cell.InsertEntry(Cell.Num(), ListenerIndex, Listener);
+				}
+			}
+		}
+	}
+}
+
+void UGameplayWorldMessageSubsystem::BeginListenerBatch()
+{
+	++ListenerBatchDepth;
+}
+
+void UGameplayWorldMessageSubsystem::EndListenerBatch()
+{
+	check(ListenerBatchDepth > 0);
+	if (--ListenerBatchDepth > 0 || UnsortedCells.Num() == 0)
+	{
+		return;
+	}
+
+	// One stable sort per cell, however many listeners of the batch landed in it
+	Algo::Sort(UnsortedCells);
+	for (int32 Index = 0; Index < UnsortedCells.Num(); ++Index)
+	{
+		if (Index == 0 || UnsortedCells[Index] != UnsortedCells[Index - 1])
+		{
+			GridLevels[UnsortedCells[Index].Key].Cells.FindChecked(UnsortedCells[Index].Value).SortEntries();
+		}
+	}
+
+	UnsortedCells.Reset();
+}
+
+void UGameplayWorldMessageSubsystem::ReserveListeners(int32 NumListeners)
+{
+	if (NumListeners > 0)
+	{
+		ListenerPool.Reserve(ListenerPool.Num() + NumListeners);
+		HandleToListenerIndex.Reserve(HandleToListenerIndex.Num() + NumListeners);
+	}
+}
+
+int32 UGameplayWorldMessageSubsystem::SelectGridLevel(float ListenRadius) const
+{
+	int32 GridLevel = 0;
+	while (GridLevel < GridLevels.Num() - 1 && ListenRadius > GridLevels[GridLevel].MaxListenRadius)
+	{
+		++GridLevel;
+	}
+
+	return GridLevel;
+}
+
+int64 UGameplayWorldMessageSubsystem::GetCellID(const FGridLevel& Level, const FVector& Position)
+{
+	return Level.CellHeight > 0.0f
+		? UE::GameplayWorldMessageSubsystem::GetGridID3D(Position, Level.CellSize, Level.CellHeight)
+		: UE::GameplayWorldMessageSubsystem::GetGridID(Position, Level.CellSize);
+}
+
+int64 UGameplayWorldMessageSubsystem::PackCellID(const FGridLevel& Level, int32 X, int32 Y, int32 Z)
+{
+	return Level.CellHeight > 0.0f
+		? UE::GameplayWorldMessageSubsystem::PackGridID3D(X, Y, Z)
+		: (static_cast<int64>(X) << 32) | (static_cast<int64>(Y) & 0xFFFFFFFF);
+}
+
+void UGameplayWorldMessageSubsystem::UnpackCellID(const FGridLevel& Level, int64 GridID, int32& OutX, int32& OutY, int32& OutZ)
+{
+	if (Level.CellHeight > 0.0f)
+	{
+		OutX = UE::GameplayWorldMessageSubsystem::UnpackGridAxis(GridID, 2 * UE::GameplayWorldMessageSubsystem::GRID_AXIS_BITS);
+		OutY = UE::GameplayWorldMessageSubsystem::UnpackGridAxis(GridID, UE::GameplayWorldMessageSubsystem::GRID_AXIS_BITS);
+		OutZ = UE::GameplayWorldMessageSubsystem::UnpackGridAxis(GridID, 0);
+	}
+	else
+	{
+		OutX = static_cast<int32>(GridID >> 32);
+		OutY = static_cast<int32>(GridID & 0xFFFFFFFF);
+		OutZ = 0;
+	}
+}
+
+UE::GameplayWorldMessageSubsystem::FGridCellRect UGameplayWorldMessageSubsystem::GetAreaCellRect(const FGridLevel& Level, const FBox& Bounds)
+{
+	UE::GameplayWorldMessageSubsystem::FGridCellRect Rect;
+	Rect.MinX = FMath::FloorToInt(Bounds.Min.X / Level.CellSize);
+	Rect.MaxX = FMath::FloorToInt(Bounds.Max.X / Level.CellSize);
+	Rect.MinY = FMath::FloorToInt(Bounds.Min.Y / Level.CellSize);
+	Rect.MaxY = FMath::FloorToInt(Bounds.Max.Y / Level.CellSize);
+	if (Level.CellHeight > 0.0f)
+	{
+		Rect.MinZ = FMath::FloorToInt(Bounds.Min.Z / Level.CellHeight);
+		Rect.MaxZ = FMath::FloorToInt(Bounds.Max.Z / Level.CellHeight);
+	}
+	else
+	{
+		Rect.MinZ = 0;
+		Rect.MaxZ = 0;
+	}
+
+	return Rect;
+}
+
+UE::GameplayWorldMessageSubsystem::FGridCellRect UGameplayWorldMessageSubsystem::GetListenerCellRect(const FGridLevel& Level, const FVector& Position, float Radius)
+{
+	// The whole bounding box of the listen sphere, corner cells outside of it only cost a distance test.
+	// Keeping the cells a plain rectangle lets moving listeners compare and diff them without building any list.
+	const float ClampedRadius = FMath::Max(Radius, 0.0f);
+
+	UE::GameplayWorldMessageSubsystem::FGridCellRect Rect;
+	Rect.MinX = FMath::FloorToInt((Position.X - ClampedRadius) / Level.CellSize);
+	Rect.MaxX = FMath::FloorToInt((Position.X + ClampedRadius) / Level.CellSize);
+	Rect.MinY = FMath::FloorToInt((Position.Y - ClampedRadius) / Level.CellSize);
+	Rect.MaxY = FMath::FloorToInt((Position.Y + ClampedRadius) / Level.CellSize);
+	if (Level.CellHeight > 0.0f)
+	{
+		Rect.MinZ = FMath::FloorToInt((Position.Z - ClampedRadius) / Level.CellHeight);
+		Rect.MaxZ = FMath::FloorToInt((Position.Z + ClampedRadius) / Level.CellHeight);
+	}
+	else
+	{
+		Rect.MinZ = 0;
+		Rect.MaxZ = 0;
+	}
+
+	return Rect;
+}
+
+template <typename FuncType>
+void UGameplayWorldMessageSubsystem::DiffListenerCells(FGameplayWorldMessageListenerData& Listener, int32 NewLevel, const UE::GameplayWorldMessageSubsystem::FGridCellRect& NewRect, FuncType&& OnCellChange)
+{
+	const int32 OldLevel = Listener.GridLevel;
+	const UE::GameplayWorldMessageSubsystem::FGridCellRect OldRect = Listener.CellRect;
+	const bool bSameLevel = OldLevel == NewLevel;
+
+	// Remove from grids that are in old but not in new
+	for (int32 X = OldRect.MinX; X <= OldRect.MaxX; ++X)
+	{
+		for (int32 Y = OldRect.MinY; Y <= OldRect.MaxY; ++Y)
+		{
+			for (int32 Z = OldRect.MinZ; Z <= OldRect.MaxZ; ++Z)
+			{
+				if (!bSameLevel || !NewRect.Contains(X, Y, Z))
+				{
+					OnCellChange(OldLevel, PackCellID(GridLevels[OldLevel], X, Y, Z), /*bInsert=*/ false);
+				}
+			}
+		}
+	}
+
+	// Add to grids that are in new but not in old
+	for (int32 X = NewRect.MinX; X <= NewRect.MaxX; ++X)
+	{
+		for (int32 Y = NewRect.MinY; Y <= NewRect.MaxY; ++Y)
+		{
+			for (int32 Z = NewRect.MinZ; Z <= NewRect.MaxZ; ++Z)
+			{
+				if (!bSameLevel || !OldRect.Contains(X, Y, Z))
+				{
+					OnCellChange(NewLevel, PackCellID(GridLevels[NewLevel], X, Y, Z), /*bInsert=*/ true);
+				}
+			}
+		}
+	}
+
+	Listener.GridLevel = static_cast<uint8>(NewLevel);
+	Listener.CellRect = NewRect;
+}
+
+float UGameplayWorldMessageSubsystem::GetListenBoundRadius(const FVector& Center) const
+{
+	double BoundRadius = 0.0;
+	for (const FGameplayWorldMessageListenerData& Listener : ListenerPool)
+	{
+		BoundRadius = FMath::Max(BoundRadius, FVector::Dist(Center, Listener.ListenPosition) + Listener.ListenRadius);
+	}
+
+	return static_cast<float>(FMath::Min(BoundRadius, static_cast<double>(MAX_flt)));
+}
+
+void UGameplayWorldMessageSubsystem::CompactListenerStorage()
+{
+	if (BroadcastDepth > 0)
+	{
+		return;
+	}
+
+	using UE::GameplayWorldMessageSubsystem::CompactIfSparse;
+
+	RateLimiter.Prune();
+
+	// Broadcasts only hold on to cells while running, they can be moved freely here
+	for (FGridLevel& Level : GridLevels)
+	{
+		CompactIfSparse(Level.Cells);
+		for (TPair<int64, FGridListenerList>& CellPair : Level.Cells)
+		{
+			if (CellPair.Value.Listeners.GetSlack() > CellPair.Value.Num())
+			{
+				CellPair.Value.Shrink();
+			}
+		}
+	}
+
+	// Only trailing free listener slots can go, cells refer to listeners by index
+	ListenerPool.Shrink();
+	CompactIfSparse(HandleToListenerIndex);
+	CompactIfSparse(FollowedListeners);
+	CompactIfSparse(NumListenersByStructType);
+}
+
+void UGameplayWorldMessageSubsystem::DumpMemory(FOutputDevice& Ar) const
+{
+	struct FMemoryUsage
+	{
+		int32 NumListeners = 0;
+		SIZE_T Bytes = 0;
+	};
+
+	// A listener costs its record, plus one entry in every cell it is stored in
+	TMap<const UScriptStruct*, FMemoryUsage> UsageByStructType;
+	TMap<FGameplayTag, FMemoryUsage> UsageByChannel;
+	for (const FGameplayWorldMessageListenerData& Listener : ListenerPool)
+	{
+		const UE::GameplayWorldMessageSubsystem::FGridCellRect& Rect = Listener.CellRect;
+		const SIZE_T NumCells = SIZE_T(Rect.MaxX - Rect.MinX + 1) * (Rect.MaxY - Rect.MinY + 1) * (Rect.MaxZ - Rect.MinZ + 1);
+		const SIZE_T Bytes = sizeof(FGameplayWorldMessageListenerData) + NumCells * FGridListenerList::EntrySize;
+
+		for (FMemoryUsage* Usage : { &UsageByStructType.FindOrAdd(Listener.StructTypeKey), &UsageByChannel.FindOrAdd(Listener.Channel) })
+		{
+			++Usage->NumListeners;
+			Usage->Bytes += Bytes;
+		}
+	}
+
+	SIZE_T GridBytes = GridLevels.GetAllocatedSize();
+	for (const FGridLevel& Level : GridLevels)
+	{
+		GridBytes += Level.Cells.GetAllocatedSize();
+		for (const TPair<int64, FGridListenerList>& CellPair : Level.Cells)
+		{
+			GridBytes += CellPair.Value.GetAllocatedSize();
+		}
+	}
+
+	const SIZE_T ListenerBytes = ListenerPool.GetAllocatedSize() + HandleToListenerIndex.GetAllocatedSize();
+	const SIZE_T OtherBytes = FollowedListeners.GetAllocatedSize() + NumListenersByStructType.GetAllocatedSize() + CompatibleStructTypes.GetAllocatedSize()
+		+ PendingListenerChanges.GetAllocatedSize() + AreaGatheredListeners.GetAllocatedSize() + FollowedHandlesScratch.GetAllocatedSize() + FollowedLocationsScratch.GetAllocatedSize();
+
+	Ar.Logf(TEXT("%s: %.1f KB, %d listeners (%.1f KB), grid %.1f KB, other %.1f KB"),
+		*GetPathName(), (ListenerBytes + GridBytes + OtherBytes) / 1024.0, ListenerPool.Num(), ListenerBytes / 1024.0, GridBytes / 1024.0, OtherBytes / 1024.0);
+
+	Ar.Logf(TEXT("  By grid level:"));
+	for (int32 LevelIndex = 0; LevelIndex < GridLevels.Num(); ++LevelIndex)
+	{
+		const FGridLevel& Level = GridLevels[LevelIndex];
+
+		int32 NumEntries = 0;
+		SIZE_T LevelBytes = Level.Cells.GetAllocatedSize();
+		for (const TPair<int64, FGridListenerList>& CellPair : Level.Cells)
+		{
+			NumEntries += CellPair.Value.Num();
+			LevelBytes += CellPair.Value.GetAllocatedSize();
+		}
+
+		Ar.Logf(TEXT("    %d (cell size %.0f): %d cells, %d entries, %.1f KB"), LevelIndex, Level.CellSize, Level.Cells.Num(), NumEntries, LevelBytes / 1024.0);
+	}
+
+	UsageByStructType.ValueSort([](const FMemoryUsage& A, const FMemoryUsage& B) { return A.Bytes > B.Bytes; });
+	Ar.Logf(TEXT("  By struct type:"));
+	for (const TPair<const UScriptStruct*, FMemoryUsage>& Pair : UsageByStructType)
+	{
+		Ar.Logf(TEXT("    %s: %d listeners, %.1f KB"), *GetNameSafe(Pair.Key), Pair.Value.NumListeners, Pair.Value.Bytes / 1024.0);
+	}
+
+	UsageByChannel.ValueSort([](const FMemoryUsage& A, const FMemoryUsage& B) { return A.Bytes > B.Bytes; });
+	Ar.Logf(TEXT("  By channel:"));
+	for (const TPair<FGameplayTag, FMemoryUsage>& Pair : UsageByChannel)
+	{
+		Ar.Logf(TEXT("    %s: %d listeners, %.1f KB"), *Pair.Key.ToString(), Pair.Value.NumListeners, Pair.Value.Bytes / 1024.0);
+	}
+}
+
+void UGameplayWorldMessageSubsystem::SetGridSettings(const FGameplayWorldMessageGridSettings& InGridSettings)
+{
+	if (!ensureMsgf(BroadcastDepth == 0, TEXT("The spatial index cannot be reconfigured from a listener callback")))
+	{
+		return;
+	}
+
+	GridSettings = InGridSettings;
+	RebuildGridLevels();
+}
+
+void UGameplayWorldMessageSubsystem::RebuildGridLevels()
+{
+	GridLevels.Reset();
+
+	const bool bHierarchical = GridSettings.Mode == EGameplayWorldMessageGridMode::Hierarchical;
+	const int32 NumLevels = bHierarchical ? FMath::Clamp(GridSettings.NumLevels, 1, 8) : 1;
+	const float LevelScale = FMath::Max(GridSettings.LevelScale, 2);
+
+	float CellSize = FMath::Max(GridSettings.CellSize, 1.0f);
+	float CellHeight = GridSettings.bPartitionZ ? (GridSettings.CellHeight > 0.0f ? FMath::Max(GridSettings.CellHeight, 1.0f) : CellSize) : 0.0f;
+	for (int32 LevelIndex = 0; LevelIndex < NumLevels; ++LevelIndex)
+	{
+		FGridLevel& Level = GridLevels.AddDefaulted_GetRef();
+		Level.CellSize = CellSize;
+		Level.CellHeight = CellHeight;
+
+		// A disk no wider than a cell overlaps at most 2x2 cells, the last level takes whatever is left
+		Level.MaxListenRadius = LevelIndex < NumLevels - 1 ? 0.5f * (CellHeight > 0.0f ? FMath::Min(CellSize, CellHeight) : CellSize) : MAX_flt;
+		CellSize *= LevelScale;
+		CellHeight *= LevelScale;
+	}
+
+	for (auto It = ListenerPool.CreateIterator(); It; ++It)
+	{
+		FGameplayWorldMessageListenerData& Listener = *It;
+		Listener.GridLevel = static_cast<uint8>(SelectGridLevel(Listener.ListenRadius));
+		FGridLevel& Level = GridLevels[Listener.GridLevel];
+		Listener.CellRect = GetListenerCellRect(Level, Listener.ListenPosition, Listener.ListenRadius);
+
+		const UE::GameplayWorldMessageSubsystem::FGridCellRect& Rect = Listener.CellRect;
+		for (int32 X = Rect.MinX; X <= Rect.MaxX; ++X)
+		{
+			for (int32 Y = Rect.MinY; Y <= Rect.MaxY; ++Y)
+			{
+				for (int32 Z = Rect.MinZ; Z <= Rect.MaxZ; ++Z)
+				{
+					InsertGridEntry(Level.Cells.FindOrAdd(PackCellID(Level, X, Y, Z)), It.GetIndex(), Listener);
+				}
+			}
+		}
+	}
+}
+
+int32 UGameplayWorldMessageSubsystem::FGridListenerList::FindEntry(int32 ListenerIndex, int32 Priority) const
+{
+	// Entries are sorted by priority, only the run of the listener's priority has to be searched
+	for (int32 EntryIndex = Algo::LowerBoundBy(Listeners, Priority, &FGridListenerEntry::Priority); EntryIndex < Listeners.Num() && Listeners[EntryIndex].Priority == Priority; ++EntryIndex)
+	{
+		if (Listeners[EntryIndex].ListenerIndex == ListenerIndex)
+		{
+			return EntryIndex;
+		}
+	}
+
+	return INDEX_NONE;
+}
+
+void UGameplayWorldMessageSubsystem::FGridListenerList::InsertEntry(int32 EntryIndex, int32 ListenerIndex, const FGameplayWorldMessageListenerData& Listener)
+{
+	if (Listeners.Num() == 0)
+	{
+		Origin = Listener.ListenPosition;
+	}
+
+	Listeners.Insert({ ListenerIndex, Listener.Priority }, EntryIndex);
+	PositionX.Insert(0.0f, EntryIndex);
+	PositionY.Insert(0.0f, EntryIndex);
+	PositionZ.Insert(0.0f, EntryIndex);
+	RadiusSquared.Insert(0.0f, EntryIndex);
+	StructTypes.Insert(Listener.ListenerStructType.Get(), EntryIndex);
+	SetEntryLocation(EntryIndex, Listener.ListenPosition, Listener.ListenRadius);
+}
+
+void UGameplayWorldMessageSubsystem::FGridListenerList::SetEntryLocation(int32 EntryIndex, const FVector& Position, float Radius)
+{
+	const FVector3f Offset(Position - Origin);
+	PositionX[EntryIndex] = Offset.X;
+	PositionY[EntryIndex] = Offset.Y;
+	PositionZ[EntryIndex] = Offset.Z;
+	RadiusSquared[EntryIndex] = Radius * Radius;
+}
+
+void UGameplayWorldMessageSubsystem::FGridListenerList::RemoveEntry(int32 EntryIndex)
+{
+	// Keep the cell sorted by priority
+	Listeners.RemoveAt(EntryIndex, 1, EAllowShrinking::No);
+	PositionX.RemoveAt(EntryIndex, 1, EAllowShrinking::No);
+	PositionY.RemoveAt(EntryIndex, 1, EAllowShrinking::No);
+	PositionZ.RemoveAt(EntryIndex, 1, EAllowShrinking::No);
+	RadiusSquared.RemoveAt(EntryIndex, 1, EAllowShrinking::No);
+	StructTypes.RemoveAt(EntryIndex, 1, EAllowShrinking::No);
+}
+
+template <typename PredicateType>
+void UGameplayWorldMessageSubsystem::FGridListenerList::RemoveEntries(PredicateType Predicate)
+{
+	int32 NumKept = 0;
+	for (int32 EntryIndex = 0; EntryIndex < Listeners.Num(); ++EntryIndex)
+	{
+		if (Predicate(Listeners[EntryIndex].ListenerIndex))
+		{
+			continue;
+		}
+
+		if (NumKept != EntryIndex)
+		{
+			Listeners[NumKept] = Listeners[EntryIndex];
+			PositionX[NumKept] = PositionX[EntryIndex];
+			PositionY[NumKept] = PositionY[EntryIndex];
+			PositionZ[NumKept] = PositionZ[EntryIndex];
+			RadiusSquared[NumKept] = RadiusSquared[EntryIndex];
+			StructTypes[NumKept] = StructTypes[EntryIndex];
+		}
+		++NumKept;
+	}
+
+	Listeners.SetNum(NumKept, EAllowShrinking::No);
+	PositionX.SetNum(NumKept, EAllowShrinking::No);
+	PositionY.SetNum(NumKept, EAllowShrinking::No);
+	PositionZ.SetNum(NumKept, EAllowShrinking::No);
+	RadiusSquared.SetNum(NumKept, EAllowShrinking::No);
+	StructTypes.SetNum(NumKept, EAllowShrinking::No);
+}
+
+void UGameplayWorldMessageSubsystem::FGridListenerList::SortEntries()
+{
+	TArray<int32, TInlineAllocator<256>> Order;
+	Order.SetNumUninitialized(Listeners.Num());
+	for (int32 EntryIndex = 0; EntryIndex < Order.Num(); ++EntryIndex)
+	{
+		Order[EntryIndex] = EntryIndex;
+	}
+
+	Algo::StableSort(Order, [this](int32 A, int32 B) { return Listeners[A].Priority < Listeners[B].Priority; });
+
+	// Apply the same permutation to every parallel array
+	auto Permute = [&Order](auto& Array)
+	{
+		auto Sorted = Array;
+		for (int32 EntryIndex = 0; EntryIndex < Order.Num(); ++EntryIndex)
+		{
+			Sorted[EntryIndex] = Array[Order[EntryIndex]];
+		}
+		Array = MoveTemp(Sorted);
+	};
+	Permute(Listeners);
+	Permute(PositionX);
+	Permute(PositionY);
+	Permute(PositionZ);
+	Permute(RadiusSquared);
+	Permute(StructTypes);
+}
+
+void UGameplayWorldMessageSubsystem::FGridListenerList::Shrink()
+{
+	Listeners.Shrink();
+	PositionX.Shrink();
+	PositionY.Shrink();
+	PositionZ.Shrink();
+	RadiusSquared.Shrink();
+	StructTypes.Shrink();
+}
+
+SIZE_T UGameplayWorldMessageSubsystem::FGridListenerList::GetAllocatedSize() const
+{
+	return Listeners.GetAllocatedSize() + PositionX.GetAllocatedSize() + PositionY.GetAllocatedSize() + PositionZ.GetAllocatedSize()
+		+ RadiusSquared.GetAllocatedSize() + StructTypes.GetAllocatedSize();
+}
+
+void UGameplayWorldMessageSubsystem::FGridListenerList::CullEntries(const FVector& Position, TConstArrayView<const UScriptStruct*> ListenerStructTypes, TArray<int32, TInlineAllocator<256>>& OutEntries, TArray<float, TInlineAllocator<256>>& OutDistancesSquared) const
 {
-	// Get all grids that this listener could potentially receive messages from
-	TArray<int64> RelevantGrids = UE::GameplayWorldMessageSubsystem::GetGridsInRadius(ListenPosition, ListenRadius);
+	const FVector3f Offset(Position - Origin);
+	const int32 NumEntries = Listeners.Num();
+
+	// Four listeners per iteration, lanes that pass the radius test are then filtered by struct type
+	const VectorRegister4Float BroadcastX = VectorSetFloat1(Offset.X);
+	const VectorRegister4Float BroadcastY = VectorSetFloat1(Offset.Y);
+	const VectorRegister4Float BroadcastZ = VectorSetFloat1(Offset.Z);
 
-	// If no grids are found, add at least the grid containing the listen position
-	if (RelevantGrids.Num() == 0)
+	int32 EntryIndex = 0;
+	for (; EntryIndex + 4 <= NumEntries; EntryIndex += 4)
 	{
-		RelevantGrids.Add(UE::GameplayWorldMessageSubsystem::GetGridID(ListenPosition));
+		const VectorRegister4Float DeltaX = VectorSubtract(VectorLoad(PositionX.GetData() + EntryIndex), BroadcastX);
+		const VectorRegister4Float DeltaY = VectorSubtract(VectorLoad(PositionY.GetData() + EntryIndex), BroadcastY);
+		const VectorRegister4Float DeltaZ = VectorSubtract(VectorLoad(PositionZ.GetData() + EntryIndex), BroadcastZ);
+		const VectorRegister4Float DistanceSquared = VectorMultiplyAdd(DeltaX, DeltaX, VectorMultiplyAdd(DeltaY, DeltaY, VectorMultiply(DeltaZ, DeltaZ)));
+
+		uint32 InsideMask = static_cast<uint32>(VectorMaskBits(VectorCompareLE(DistanceSquared, VectorLoad(RadiusSquared.GetData() + EntryIndex))));
+		if (InsideMask == 0)
+		{
+			continue;
+		}
+
+		alignas(16) float LaneDistancesSquared[4];
+		VectorStoreAligned(DistanceSquared, LaneDistancesSquared);
+		while (InsideMask != 0)
+		{
+			const int32 Lane = static_cast<int32>(FMath::CountTrailingZeros(InsideMask));
+			InsideMask &= InsideMask - 1;
+			if (ListenerStructTypes.Contains(StructTypes[EntryIndex + Lane]))
+			{
+				OutEntries.Add(EntryIndex + Lane);
+				OutDistancesSquared.Add(LaneDistancesSquared[Lane]);
+			}
+		}
 	}
 
-	// Create listener data
-	FGameplayWorldMessageListenerData ListenerData;
-	ListenerData.ReceivedCallback = MoveTemp(Callback);
-	ListenerData.ListenerStructType = StructType;
-	ListenerData.Channel = Channel;
-	ListenerData.MatchType = MatchType;
-	ListenerData.Priority = Priority;
-	ListenerData.ListenPosition = ListenPosition;
-	ListenerData.ListenRadius = ListenRadius;
+	for (; EntryIndex < NumEntries; ++EntryIndex)
+	{
+		const float DeltaX = PositionX[EntryIndex] - Offset.X;
+		const float DeltaY = PositionY[EntryIndex] - Offset.Y;
+		const float DeltaZ = PositionZ[EntryIndex] - Offset.Z;
+		const float DistanceSquared = DeltaX * DeltaX + DeltaY * DeltaY + DeltaZ * DeltaZ;
+		if (DistanceSquared <= RadiusSquared[EntryIndex] && ListenerStructTypes.Contains(StructTypes[EntryIndex]))
+		{
+			OutEntries.Add(EntryIndex);
+			OutDistancesSquared.Add(DistanceSquared);
+		}
+	}
+}
 
-	// Generate unique handle ID
-	static int32 GlobalHandleID = 0;
-	ListenerData.HandleID = ++GlobalHandleID;
+void UGameplayWorldMessageSubsystem::InsertGridEntry(FGridListenerList& GridList, int32 ListenerIndex, const FGameplayWorldMessageListenerData& Listener)
+{
+	// Insert at the correct position based on priority
+	int32 InsertIndex = GridList.Listeners.Num();
+	for (int32 i = GridList.Listeners.Num() - 1; i >= 0; --i)
+	{
+		if (GridList.Listeners[i].Priority > Listener.Priority)
+		{
+			InsertIndex = i;
+		}
+		else
+		{
+			break;
+		}
+	}
 
-	// Add listener to all relevant grids
-	for (int64 GridID : RelevantGrids)
+	GridList.InsertEntry(InsertIndex, ListenerIndex, Listener);
+}
+
+bool UGameplayWorldMessageSubsystem::RemoveGridEntry(FGridLevel& Level, int64 GridID, int32 ListenerIndex, int32 Priority)
+{
+	FGridListenerList* GridList = Level.Cells.Find(GridID);
+	if (!GridList)
 	{
-		FGridListenerList& GridList = GridListenerMap.FindOrAdd(GridID);
-		
-		// Insert at the correct position based on priority
-		int32 InsertIndex = GridList.Listeners.Num();
-		for (int32 i = GridList.Listeners.Num() - 1; i >= 0; --i)
+		return false;
+	}
+
+	const int32 EntryIndex = GridList->FindEntry(ListenerIndex, Priority);
+	if (EntryIndex != INDEX_NONE)
+	{
+		GridList->RemoveEntry(EntryIndex);
+	}
+
+	// Clean up empty grids
+	if (GridList->Num() == 0)
+	{
+		Level.Cells.Remove(GridID);
+	}
+
+	return EntryIndex != INDEX_NONE;
+}
+
+void UGameplayWorldMessageSubsystem::RefreshGridEntries(int32 ListenerIndex)
+{
+	const FGameplayWorldMessageListenerData& Listener = ListenerPool[ListenerIndex];
+	FGridLevel& Level = GridLevels[Listener.GridLevel];
+
+	const UE::GameplayWorldMessageSubsystem::FGridCellRect& Rect = Listener.CellRect;
+	for (int32 X = Rect.MinX; X <= Rect.MaxX; ++X)
+	{
+		for (int32 Y = Rect.MinY; Y <= Rect.MaxY; ++Y)
 		{
-			if (GridList.Listeners[i].Priority > Priority)
+			for (int32 Z = Rect.MinZ; Z <= Rect.MaxZ; ++Z)
 			{
-				InsertIndex = i;
-			}
-			else
-			{
-				break;
+				if (FGridListenerList* GridList = Level.Cells.Find(PackCellID(Level, X, Y, Z)))
+				{
+					const int32 EntryIndex = GridList->FindEntry(ListenerIndex, Listener.Priority);
+					if (EntryIndex != INDEX_NONE)
+					{
+						GridList->SetEntryLocation(EntryIndex, Listener.ListenPosition, Listener.ListenRadius);
+					}
+				}
 			}
 		}
-		
-		GridList.Listeners.Insert(ListenerData, InsertIndex);
 	}
-
-	// Track the listener's spatial info for efficient cleanup
-	FListenerSpatialInfo SpatialInfo;
-	SpatialInfo.ListenPosition = ListenPosition;
-	SpatialInfo.ListenRadius = ListenRadius;
-	HandleToSpatialMap.Add(ListenerData.HandleID, SpatialInfo);
-
-	return FGameplayWorldMessageListenerHandle(this, StructType, ListenerData.HandleID);
 }
 
 void UGameplayWorldMessageSubsystem::UnregisterListener(FGameplayWorldMessageListenerHandle Handle)
@@ -349,157 +1523,349 @@ bool UGameplayWorldMessageSubsystem::UpdateRegisterListenerLocation(FGameplayWor
 		return false;
 	}
 
-	// Find the existing spatial info
-	FListenerSpatialInfo* SpatialInfoPtr = HandleToSpatialMap.Find(Handle.ID);
-	if (!SpatialInfoPtr)
+	if (BroadcastDepth > 0)
+	{
+		// Moving the listener would reshuffle the cell a broadcast is iterating, apply it once the broadcast returns
+		FPendingListenerChange& Change = PendingListenerChanges.AddDefaulted_GetRef();
+		Change.Type = EPendingListenerChange::Relocate;
+		Change.HandleID = Handle.ID;
+		Change.ListenPosition = NewListenPosition;
+		Change.ListenRadius = NewListenRadius;
+		return true;
+	}
+
+	return RelocateListenerInGrids(Handle.ID, NewListenPosition, NewListenRadius);
+}
+
+bool UGameplayWorldMessageSubsystem::RelocateListenerInGrids(int32 HandleID, const FVector& NewListenPosition, float NewListenRadius)
+{
+	// Find the existing listener
+	const int32* ListenerIndexPtr = HandleToListenerIndex.Find(HandleID);
+	if (!ListenerIndexPtr)
 	{
-		UE_LOG(LogGameplayWorldMessageSubsystem, Warning, TEXT("Trying to update location for listener with unknown HandleID %d"), Handle.ID);
+		UE_LOG(LogGameplayWorldMessageSubsystem, Warning, TEXT("Trying to update location for listener with unknown HandleID %d"), HandleID);
 		return false;
 	}
 
+	const int32 ListenerIndex = *ListenerIndexPtr;
+	FGameplayWorldMessageListenerData& Listener = ListenerPool[ListenerIndex];
+
 	// Use existing radius if new radius is not specified (negative value)
-	float ActualNewRadius = NewListenRadius >= 0.0f ? NewListenRadius : SpatialInfoPtr->ListenRadius;
+	float ActualNewRadius = NewListenRadius >= 0.0f ? NewListenRadius : Listener.ListenRadius;
 
-	// Calculate old and new grid sets
-	TArray<int64> OldGrids = UE::GameplayWorldMessageSubsystem::GetGridsInRadius(SpatialInfoPtr->ListenPosition, SpatialInfoPtr->ListenRadius);
-	TArray<int64> NewGrids = UE::GameplayWorldMessageSubsystem::GetGridsInRadius(NewListenPosition, ActualNewRadius);
+	// A new radius may move the listener to another level
+	const int32 NewLevel = SelectGridLevel(ActualNewRadius);
+	const UE::GameplayWorldMessageSubsystem::FGridCellRect NewRect = GetListenerCellRect(GridLevels[NewLevel], NewListenPosition, ActualNewRadius);
+	const bool bCellsChanged = NewLevel != Listener.GridLevel || NewRect != Listener.CellRect;
 
-	// Ensure we have at least the grid containing the position
-	if (OldGrids.Num() == 0)
+	Listener.ListenPosition = NewListenPosition;
+	Listener.ListenRadius = ActualNewRadius;
+
+	if (bCellsChanged)
 	{
-		OldGrids.Add(UE::GameplayWorldMessageSubsystem::GetGridID(SpatialInfoPtr->ListenPosition));
+		DiffListenerCells(Listener, NewLevel, NewRect, [this, ListenerIndex, &Listener](int32 Level, int64 GridID, bool bInsert)
+		{
+			if (bInsert)
+			{
+				InsertGridEntry(GridLevels[Level].Cells.FindOrAdd(GridID), ListenerIndex, Listener);
+			}
+			else
+			{
+				RemoveGridEntry(GridLevels[Level], GridID, ListenerIndex, Listener.Priority);
+			}
+		});
 	}
-	if (NewGrids.Num() == 0)
+
+	// Cells kept by the move still hold the old culling data
+	RefreshGridEntries(ListenerIndex);
+
+	return true;
+}
+
+int32 UGameplayWorldMessageSubsystem::UpdateRegisterListenerLocations(TConstArrayView<FGameplayWorldMessageListenerHandle> Handles, TConstArrayView<FVector> NewListenPositions)
+{
+	if (!ensureMsgf(Handles.Num() == NewListenPositions.Num(), TEXT("UpdateRegisterListenerLocations needs one position per handle")))
 	{
-		NewGrids.Add(UE::GameplayWorldMessageSubsystem::GetGridID(NewListenPosition));
+		return 0;
 	}
 
-	// Find grids to remove from and grids to add to
-	TArray<int64> GridsToRemoveFrom;
-	TArray<int64> GridsToAddTo;
-
-	// Find grids that are in old but not in new (remove from these)
-	for (int64 OldGrid : OldGrids)
+	if (BroadcastDepth > 0)
 	{
-		if (!NewGrids.Contains(OldGrid))
+		// Moving the listeners would reshuffle the cells a broadcast is iterating, apply the moves once it returns
+		int32 NumQueued = 0;
+		for (int32 Index = 0; Index < Handles.Num(); ++Index)
 		{
-			GridsToRemoveFrom.Add(OldGrid);
+			if (Handles[Index].IsValid() && Handles[Index].Subsystem == this)
+			{
+				FPendingListenerChange& Change = PendingListenerChanges.AddDefaulted_GetRef();
+				Change.Type = EPendingListenerChange::Relocate;
+				Change.HandleID = Handles[Index].ID;
+				Change.ListenPosition = NewListenPositions[Index];
+				++NumQueued;
+			}
 		}
+		return NumQueued;
 	}
 
-	// Find grids that are in new but not in old (add to these)
-	for (int64 NewGrid : NewGrids)
+	struct FCellChange
 	{
-		if (!OldGrids.Contains(NewGrid))
+		int64 GridID;
+		int32 Level;
+		int32 ListenerIndex;
+		bool bInsert;
+	};
+
+	// Listeners staying within their cells only need new positions, the others record the cells they leave and enter
+	TArray<FCellChange> CellChanges;
+	TArray<int32> MovedListeners;
+	MovedListeners.Reserve(Handles.Num());
+	for (int32 Index = 0; Index < Handles.Num(); ++Index)
+	{
+		const FGameplayWorldMessageListenerHandle& Handle = Handles[Index];
+		const int32* ListenerIndexPtr = Handle.IsValid() && Handle.Subsystem == this ? HandleToListenerIndex.Find(Handle.ID) : nullptr;
+		if (!ListenerIndexPtr)
 		{
-			GridsToAddTo.Add(NewGrid);
+			continue;
 		}
-	}
 
-	// Find the listener data to copy (from any grid where it exists)
-	FGameplayWorldMessageListenerData* ListenerDataPtr = nullptr;
-	for (int64 GridID : OldGrids)
-	{
-		if (FGridListenerList* GridList = GridListenerMap.Find(GridID))
+		const int32 ListenerIndex = *ListenerIndexPtr;
+		FGameplayWorldMessageListenerData& Listener = ListenerPool[ListenerIndex];
+		const FVector& NewListenPosition = NewListenPositions[Index];
+
+		const UE::GameplayWorldMessageSubsystem::FGridCellRect NewRect = GetListenerCellRect(GridLevels[Listener.GridLevel], NewListenPosition, Listener.ListenRadius);
+		if (NewRect != Listener.CellRect)
 		{
-			for (FGameplayWorldMessageListenerData& Listener : GridList->Listeners)
-			{
-				if (Listener.HandleID == Handle.ID)
-				{
-					ListenerDataPtr = &Listener;
-					break;
-				}
-			}
-			if (ListenerDataPtr)
+			DiffListenerCells(Listener, Listener.GridLevel, NewRect, [&CellChanges, ListenerIndex](int32 Level, int64 GridID, bool bInsert)
 			{
-				break;
-			}
+				CellChanges.Add({ GridID, Level, ListenerIndex, bInsert });
+			});
 		}
-	}
 
-	if (!ListenerDataPtr)
-	{
-		UE_LOG(LogGameplayWorldMessageSubsystem, Warning, TEXT("Could not find listener data for HandleID %d during location update"), Handle.ID);
-		return false;
+		Listener.ListenPosition = NewListenPosition;
+		MovedListeners.Add(ListenerIndex);
 	}
 
-	// Create updated listener data
-	FGameplayWorldMessageListenerData UpdatedListenerData = *ListenerDataPtr;
-	UpdatedListenerData.ListenPosition = NewListenPosition;
-	UpdatedListenerData.ListenRadius = ActualNewRadius;
+	// Apply the changes cell by cell: one lookup per cell, removals before insertions so a cell emptied and refilled by
+	// the batch is not dropped in between
+	Algo::Sort(CellChanges, [](const FCellChange& A, const FCellChange& B)
+	{
+		if (A.Level != B.Level)
+		{
+			return A.Level < B.Level;
+		}
+		if (A.GridID != B.GridID)
+		{
+			return A.GridID < B.GridID;
+		}
+		return A.bInsert < B.bInsert;
+	});
 
-	// Remove from old grids
-	TArray<int64> GridIDsToClean;
-	for (int64 GridID : GridsToRemoveFrom)
+	for (int32 First = 0; First < CellChanges.Num();)
 	{
-		if (FGridListenerList* GridList = GridListenerMap.Find(GridID))
+		const FCellChange& FirstChange = CellChanges[First];
+		int32 End = First + 1;
+		while (End < CellChanges.Num() && CellChanges[End].Level == FirstChange.Level && CellChanges[End].GridID == FirstChange.GridID)
+		{
+			++End;
+		}
+
+		FGridLevel& Level = GridLevels[FirstChange.Level];
+		FGridListenerList& Cell = Level.Cells.FindOrAdd(FirstChange.GridID);
+
+		int32 FirstInsert = First;
+		while (FirstInsert < End && !CellChanges[FirstInsert].bInsert)
+		{
+			++FirstInsert;
+		}
+
+		if (FirstInsert > First)
 		{
-			int32 RemovedCount = GridList->Listeners.RemoveAll([HandleID = Handle.ID](const FGameplayWorldMessageListenerData& Listener)
+			// Single stable pass over the cell for all of its removals
+			const TConstArrayView<FCellChange> Removals(CellChanges.GetData() + First, FirstInsert - First);
+			Cell.RemoveEntries([&Removals](int32 ListenerIndex)
 			{
-				return Listener.HandleID == HandleID;
+				return Removals.ContainsByPredicate([ListenerIndex](const FCellChange& Change) { return Change.ListenerIndex == ListenerIndex; });
 			});
+		}
 
-			// If the grid is now empty, mark for cleanup
-			if (GridList->Listeners.Num() == 0)
-			{
-				GridIDsToClean.Add(GridID);
-			}
+		for (int32 ChangeIndex = FirstInsert; ChangeIndex < End; ++ChangeIndex)
+		{
+			InsertGridEntry(Cell, CellChanges[ChangeIndex].ListenerIndex, ListenerPool[CellChanges[ChangeIndex].ListenerIndex]);
+		}
+
+		if (Cell.Num() == 0)
+		{
+			Level.Cells.Remove(FirstChange.GridID);
 		}
+
+		First = End;
 	}
 
-	// Clean up empty grids
-	for (int64 GridID : GridIDsToClean)
+	// Cells the listeners stayed in still hold their old positions
+	for (int32 ListenerIndex : MovedListeners)
 	{
-		GridListenerMap.Remove(GridID);
+		RefreshGridEntries(ListenerIndex);
 	}
 
-	// Add to new grids
-	for (int64 GridID : GridsToAddTo)
+	return MovedListeners.Num();
+}
+
+void UGameplayWorldMessageSubsystem::UnregisterListeners(TConstArrayView<FGameplayWorldMessageListenerHandle> Handles)
+{
+	if (BroadcastDepth > 0)
 	{
-		FGridListenerList& GridList = GridListenerMap.FindOrAdd(GridID);
-		
-		// Insert at the correct position based on priority
-		int32 InsertIndex = GridList.Listeners.Num();
-		for (int32 i = GridList.Listeners.Num() - 1; i >= 0; --i)
+		// Removals are deferred until the broadcast returns either way
+		for (const FGameplayWorldMessageListenerHandle& Handle : Handles)
 		{
-			if (GridList.Listeners[i].Priority > UpdatedListenerData.Priority)
-			{
-				InsertIndex = i;
-			}
-			else
+			if (Handle.IsValid() && Handle.Subsystem == this)
 			{
-				break;
+				UnregisterListenerInternal(Handle.StructType, Handle.ID);
 			}
 		}
-		
-		GridList.Listeners.Insert(UpdatedListenerData, InsertIndex);
+		return;
 	}
 
-	// Update existing listeners in grids that remain the same
-	for (int64 GridID : OldGrids)
+	// Mark the leaving listeners and the cells they are stored in
+	TBitArray<> RemovedListeners(false, ListenerPool.GetMaxIndex());
+	TArray<TPair<int32, int64>> Cells;
+	TArray<int32> ListenerIndices;
+	ListenerIndices.Reserve(Handles.Num());
+	for (const FGameplayWorldMessageListenerHandle& Handle : Handles)
 	{
-		if (NewGrids.Contains(GridID))
+		int32 ListenerIndex = INDEX_NONE;
+		if (!Handle.IsValid() || Handle.Subsystem != this || !HandleToListenerIndex.RemoveAndCopyValue(Handle.ID, ListenerIndex))
 		{
-			if (FGridListenerList* GridList = GridListenerMap.Find(GridID))
+			continue;
+		}
+
+		FollowedListeners.Remove(Handle.ID);
+		RemovedListeners[ListenerIndex] = true;
+		ListenerIndices.Add(ListenerIndex);
+
+		const FGameplayWorldMessageListenerData& Listener = ListenerPool[ListenerIndex];
+		const FGridLevel& Level = GridLevels[Listener.GridLevel];
+		const UE::GameplayWorldMessageSubsystem::FGridCellRect& Rect = Listener.CellRect;
+		for (int32 X = Rect.MinX; X <= Rect.MaxX; ++X)
+		{
+			for (int32 Y = Rect.MinY; Y <= Rect.MaxY; ++Y)
 			{
-				for (FGameplayWorldMessageListenerData& Listener : GridList->Listeners)
+				for (int32 Z = Rect.MinZ; Z <= Rect.MaxZ; ++Z)
 				{
-					if (Listener.HandleID == Handle.ID)
-					{
-						Listener.ListenPosition = NewListenPosition;
-						Listener.ListenRadius = ActualNewRadius;
-						break;
-					}
+					Cells.Emplace(Listener.GridLevel, PackCellID(Level, X, Y, Z));
 				}
 			}
 		}
 	}
 
-	// Update the spatial mapping
-	SpatialInfoPtr->ListenPosition = NewListenPosition;
-	SpatialInfoPtr->ListenRadius = ActualNewRadius;
+	// Single stable pass over each cell for all of its removals
+	Algo::Sort(Cells);
+	for (int32 Index = 0; Index < Cells.Num(); ++Index)
+	{
+		if (Index > 0 && Cells[Index] == Cells[Index - 1])
+		{
+			continue;
+		}
+
+		FGridLevel& Level = GridLevels[Cells[Index].Key];
+		if (FGridListenerList* Cell = Level.Cells.Find(Cells[Index].Value))
+		{
+			Cell->RemoveEntries([&RemovedListeners](int32 ListenerIndex) { return RemovedListeners[ListenerIndex]; });
+			if (Cell->Num() == 0)
+			{
+				Level.Cells.Remove(Cells[Index].Value);
+			}
+		}
+	}
+
+	for (int32 ListenerIndex : ListenerIndices)
+	{
+		const UScriptStruct* StructTypeKey = ListenerPool[ListenerIndex].StructTypeKey;
+		int32& NumStructListeners = NumListenersByStructType.FindChecked(StructTypeKey);
+		if (--NumStructListeners == 0)
+		{
+			NumListenersByStructType.Remove(StructTypeKey);
+			CompatibleStructTypes.Reset();
+		}
 
-	return true;
+		ListenerPool.RemoveAt(ListenerIndex);
+	}
+}
+
+bool UGameplayWorldMessageSubsystem::SetListenerFollowComponent(FGameplayWorldMessageListenerHandle Handle, const USceneComponent* Component, float MoveThreshold)
+{
+	if (!Handle.IsValid() || Handle.Subsystem != this)
+	{
+		return false;
+	}
+
+	if (!Component)
+	{
+		FollowedListeners.Remove(Handle.ID);
+		return true;
+	}
+
+	// Registrations deferred by a broadcast are not in the pool yet, the relocation below is deferred the same way
+	if (!HandleToListenerIndex.Contains(Handle.ID) && BroadcastDepth == 0)
+	{
+		UE_LOG(LogGameplayWorldMessageSubsystem, Warning, TEXT("Trying to follow a component with unknown HandleID %d"), Handle.ID);
+		return false;
+	}
+
+	FFollowedListener& Followed = FollowedListeners.FindOrAdd(Handle.ID);
+	Followed.Component = Component;
+	Followed.LastLocation = Component->GetComponentLocation();
+	Followed.MoveThresholdSquared = FMath::Square(FMath::Max(MoveThreshold, 0.0f));
+
+	return UpdateRegisterListenerLocation(Handle, Followed.LastLocation);
+}
+
+bool UGameplayWorldMessageSubsystem::SetListenerFollowActor(FGameplayWorldMessageListenerHandle Handle, const AActor* Actor, float MoveThreshold)
+{
+	return SetListenerFollowComponent(Handle, Actor ? Actor->GetRootComponent() : nullptr, MoveThreshold);
+}
+
+void UGameplayWorldMessageSubsystem::FollowComponentFromParams(FGameplayWorldMessageListenerHandle Handle, const TWeakObjectPtr<const USceneComponent>& Component, float MoveThreshold)
+{
+	if (const USceneComponent* FollowComponent = Component.Get())
+	{
+		SetListenerFollowComponent(Handle, FollowComponent, MoveThreshold);
+	}
+}
+
+void UGameplayWorldMessageSubsystem::UpdateFollowedListeners()
+{
+	if (FollowedListeners.Num() == 0)
+	{
+		return;
+	}
+
+	FollowedHandlesScratch.Reset();
+	FollowedLocationsScratch.Reset();
+	for (auto It = FollowedListeners.CreateIterator(); It; ++It)
+	{
+		FFollowedListener& Followed = It.Value();
+		const USceneComponent* Component = Followed.Component.Get();
+		if (!Component)
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+
+		// Small moves are absorbed by the threshold, the listener keeps its cells until the component went far enough
+		const FVector Location = Component->GetComponentLocation();
+		if (FVector::DistSquared(Location, Followed.LastLocation) > Followed.MoveThresholdSquared)
+		{
+			Followed.LastLocation = Location;
+			FollowedHandlesScratch.Add(FGameplayWorldMessageListenerHandle(this, nullptr, It.Key()));
+			FollowedLocationsScratch.Add(Location);
+		}
+	}
+
+	if (FollowedHandlesScratch.Num() > 0)
+	{
+		INC_DWORD_STAT_BY(STAT_GameplayMessages_FollowedListenersMoved, FollowedHandlesScratch.Num());
+		UpdateRegisterListenerLocations(FollowedHandlesScratch, FollowedLocationsScratch);
+	}
 }
 
 void UGameplayWorldMessageSubsystem::CancelCurrentMessage(UObject* WorldContext, bool bCancel, bool bInterrupted)
@@ -521,58 +1887,105 @@ void UGameplayWorldMessageSubsystem::CancelMessage(bool bCancel, bool bInterrupt
 
 void UGameplayWorldMessageSubsystem::UnregisterListenerInternal(const UScriptStruct* StructType, int32 HandleID)
 {
-	// Direct lookup of spatial info by HandleID
-	FListenerSpatialInfo* SpatialInfoPtr = HandleToSpatialMap.Find(HandleID);
-	if (!SpatialInfoPtr)
+	FollowedListeners.Remove(HandleID);
+
+	if (BroadcastDepth == 0)
 	{
-		UE_LOG(LogGameplayWorldMessageSubsystem, Warning, TEXT("Trying to unregister listener with unknown HandleID %d"), HandleID);
+		RemoveListenerFromGrids(HandleID);
 		return;
 	}
-	
-	// Recalculate which grids this listener was registered in
-	TArray<int64> RelevantGrids = UE::GameplayWorldMessageSubsystem::GetGridsInRadius(SpatialInfoPtr->ListenPosition, SpatialInfoPtr->ListenRadius);
-	
-	// If no grids are found, add at least the grid containing the listen position
-	if (RelevantGrids.Num() == 0)
+
+	// Stop delivering to the listener right away, but leave the cell entries in place for the broadcast iterating them
+	if (const int32* ListenerIndexPtr = HandleToListenerIndex.Find(HandleID))
 	{
-		RelevantGrids.Add(UE::GameplayWorldMessageSubsystem::GetGridID(SpatialInfoPtr->ListenPosition));
+		ListenerPool[*ListenerIndexPtr].bPendingRemoval = true;
 	}
-	
-	TArray<int64> GridIDsToClean;
-	
+
+	FPendingListenerChange& Change = PendingListenerChanges.AddDefaulted_GetRef();
+	Change.Type = EPendingListenerChange::Unregister;
+	Change.HandleID = HandleID;
+}
+
+void UGameplayWorldMessageSubsystem::ApplyPendingListenerChanges()
+{
+	check(BroadcastDepth == 0);
+
+	// Changes are replayed in the order they were requested, so register/move/unregister sequences made
+	// from callbacks end in the same state as if they had been applied immediately
+	for (FPendingListenerChange& Change : PendingListenerChanges)
+	{
+		switch (Change.Type)
+		{
+		case EPendingListenerChange::Register:
+			AddListenerToGrids(MoveTemp(Change.Listener.GetValue()));
+			break;
+		case EPendingListenerChange::Unregister:
+			RemoveListenerFromGrids(Change.HandleID);
+			break;
+		case EPendingListenerChange::Relocate:
+			RelocateListenerInGrids(Change.HandleID, Change.ListenPosition, Change.ListenRadius);
+			break;
+		}
+	}
+
+	// Keep the allocation around, listener changes from callbacks tend to happen every frame
+	PendingListenerChanges.Reset();
+}
+
+void UGameplayWorldMessageSubsystem::RemoveListenerFromGrids(int32 HandleID)
+{
+	// Direct lookup of the listener by HandleID
+	int32 ListenerIndex = INDEX_NONE;
+	if (!HandleToListenerIndex.RemoveAndCopyValue(HandleID, ListenerIndex))
+	{
+		UE_LOG(LogGameplayWorldMessageSubsystem, Warning, TEXT("Trying to unregister listener with unknown HandleID %d"), HandleID);
+		return;
+	}
+
+	const FGameplayWorldMessageListenerData& Listener = ListenerPool[ListenerIndex];
+	FGridLevel& Level = GridLevels[Listener.GridLevel];
+
 	// Remove the listener from all grids where it was registered
-	for (int64 GridID : RelevantGrids)
+	const UE::GameplayWorldMessageSubsystem::FGridCellRect& Rect = Listener.CellRect;
+	for (int32 X = Rect.MinX; X <= Rect.MaxX; ++X)
 	{
-		if (FGridListenerList* GridList = GridListenerMap.Find(GridID))
+		for (int32 Y = Rect.MinY; Y <= Rect.MaxY; ++Y)
 		{
-			int32 RemovedCount = GridList->Listeners.RemoveAll([HandleID](const FGameplayWorldMessageListenerData& Listener)
-			{
-				return Listener.HandleID == HandleID;
-			});
-			
-			if (RemovedCount == 0)
-			{
-				UE_LOG(LogGameplayWorldMessageSubsystem, Warning, TEXT("Listener with HandleID %d should be in grid %lld but not found in grid's listener list"), HandleID, GridID);
-			}
-			
-			// If the grid is now empty, mark for cleanup
-			if (GridList->Listeners.Num() == 0)
+			for (int32 Z = Rect.MinZ; Z <= Rect.MaxZ; ++Z)
 			{
-				GridIDsToClean.Add(GridID);
+				const int64 GridID = PackCellID(Level, X, Y, Z);
+				if (!RemoveGridEntry(Level, GridID, ListenerIndex, Listener.Priority))
+				{
+					UE_LOG(LogGameplayWorldMessageSubsystem, Warning, TEXT("Listener with HandleID %d should be in grid %lld but not found in grid's listener list"), HandleID, GridID);
+				}
 			}
 		}
-		else
-		{
-			UE_LOG(LogGameplayWorldMessageSubsystem, Warning, TEXT("Listener with HandleID %d should be in grid %lld but grid not found"), HandleID, GridID);
-		}
 	}
-	
-	// Clean up empty grids
-	for (int64 GridID : GridIDsToClean)
+
+	int32& NumStructListeners = NumListenersByStructType.FindChecked(Listener.StructTypeKey);
+	if (--NumStructListeners == 0)
 	{
-		GridListenerMap.Remove(GridID);
+		NumListenersByStructType.Remove(Listener.StructTypeKey);
+		CompatibleStructTypes.Reset();
 	}
-	
-	// Clean up the spatial mapping
-	HandleToSpatialMap.Remove(HandleID);
+
+	ListenerPool.RemoveAt(ListenerIndex);
+}
+
+TConstArrayView<const UScriptStruct*> UGameplayWorldMessageSubsystem::GetCompatibleStructTypes(const UScriptStruct* StructType)
+{
+	if (const TArray<const UScriptStruct*, TInlineAllocator<4>>* pTypes = CompatibleStructTypes.Find(StructType))
+	{
+		return *pTypes;
+	}
+
+	TArray<const UScriptStruct*, TInlineAllocator<4>>& Types = CompatibleStructTypes.Add(StructType);
+	for (const UStruct* Type = StructType; Type != nullptr; Type = Type->GetSuperStruct())
+	{
+		if (NumListenersByStructType.Contains(static_cast<const UScriptStruct*>(Type)))
+		{
+			Types.Add(static_cast<const UScriptStruct*>(Type));
+		}
+	}
+	return Types;
 }
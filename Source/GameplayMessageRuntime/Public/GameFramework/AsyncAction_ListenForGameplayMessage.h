@@ -81,6 +81,32 @@ public:
 	void OverridePayload(const int32& InPayload);
 	DECLARE_FUNCTION(execOverridePayload);
 
+	/**
+	 * Copy a single member of the payload being received into OutValue, leaving the rest of the payload uncopied.
+	 * Used by the listen node when its payload pin is split, only valid while OnMessageReceived is broadcast.
+	 *
+	 * @param PropertyName	Name of the payload member
+	 * @param OutValue		The wildcard reference the member should be copied into, must match the member's type
+	 * @return				If the copy was a success
+	 */
+	UFUNCTION(BlueprintCallable, CustomThunk, Category = "Messaging", meta = (CustomStructureParam = "OutValue", BlueprintInternalUseOnly = "true"))
+	bool GetPayloadProperty(FName PropertyName, UPARAM(ref) int32& OutValue);
+	DECLARE_FUNCTION(execGetPayloadProperty);
+
+	/**
+	 * Write a single member straight into the payload being received, the listeners called next see the new value.
+	 * Used by the override payload node when its payload pin is split, only valid while OnMessageReceived is broadcast.
+	 * Nothing is written unless ContextType is the listened payload type. The node writes every member pin it shows,
+	 * default values included, members skipped from its context menu are left untouched.
+	 *
+	 * @param ContextType	Struct of the split pin, InValue was compiled against its member
+	 * @param PropertyName	Name of the payload member
+	 * @param InValue		The wildcard value to write, must match the member's type
+	 */
+	UFUNCTION(BlueprintCallable, CustomThunk, Category = "Messaging", meta = (CustomStructureParam = "InValue", BlueprintInternalUseOnly = "true"))
+	void SetPayloadProperty(const UScriptStruct* ContextType, FName PropertyName, const int32& InValue);
+	DECLARE_FUNCTION(execSetPayloadProperty);
+
 	virtual void Activate() override;
 	virtual void SetReadyToDestroy() override;
 
@@ -90,8 +116,14 @@ public:
 	FAsyncGameplayMessageDelegate OnMessageReceived;
 
 private:
+	// Take an action from the game instance's pool if enabled, or create one
+	static UAsyncAction_ListenForGameplayMessage* CreateAction(UWorld* World, FGameplayTag Channel, UScriptStruct* PayloadType, EGameplayMessageMatch MatchType, EGameplayMessagePriority Priority, UObject* TargetObject);
+
 	void HandleMessageReceived(FGameplayTag Channel, const UScriptStruct* StructType, void* Payload);
 
+	// Member PropertyName of the payload type, nullptr if it does not exist or does not match ValueProperty's type
+	const FProperty* FindPayloadProperty(FName PropertyName, const FProperty* ValueProperty) const;
+
 private:
 	void* ReceivedMessagePayloadPtr = nullptr;
 
@@ -105,4 +137,7 @@ private:
 	EGameplayMessagePriority Priority;
 
 	FGameplayMessageListenerHandle ListenerHandle;
+
+	// Waiting in UGameplayMessageAsyncActionPool, messages reaching the parked registration are ignored
+	bool bPooled = false;
 };
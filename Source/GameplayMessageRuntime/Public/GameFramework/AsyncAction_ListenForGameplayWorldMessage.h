@@ -8,6 +8,7 @@
 
 #include "AsyncAction_ListenForGameplayWorldMessage.generated.h"
 
+class AActor;
 class UScriptStruct;
 class UWorld;
 struct FFrame;
@@ -38,6 +39,21 @@ public:
 	UFUNCTION(BlueprintCallable, Category = Messaging, meta = (WorldContext = "WorldContextObject", DefaultToSelf="WorldContextObject", BlueprintInternalUseOnly = "true"))
 	static UAsyncAction_ListenForGameplayWorldMessage* ListenForGameplayWorldMessages(UObject* WorldContextObject, FGameplayTag Channel, UScriptStruct* PayloadType, FVector ListenPosition, float ListenRadius, EGameplayMessageMatch MatchType = EGameplayMessageMatch::ExactMatch, EGameplayMessagePriority Priority = EGameplayMessagePriority::DEFAULT);
 
+	/**
+	 * Asynchronously waits for a spatial gameplay message to be broadcast on the specified channel within a radius of an actor.
+	 * The listen position follows the actor, it is relocated each time the actor has moved more than MoveThreshold.
+	 *
+	 * @param Channel			The message channel to listen for
+	 * @param PayloadType		The kind of message structure to use (this must match the same type that the sender is broadcasting)
+	 * @param FollowActor		The actor to listen around
+	 * @param ListenRadius		The radius within which to receive messages
+	 * @param MoveThreshold		Distance the actor has to move before the listener is relocated
+	 * @param MatchType			The rule used for matching the channel with broadcasted messages
+	 * @param Priority			Priority of the listener
+	 */
+	UFUNCTION(BlueprintCallable, Category = Messaging, meta = (WorldContext = "WorldContextObject", DefaultToSelf="WorldContextObject", BlueprintInternalUseOnly = "true"))
+	static UAsyncAction_ListenForGameplayWorldMessage* ListenForGameplayWorldMessagesAroundActor(UObject* WorldContextObject, FGameplayTag Channel, UScriptStruct* PayloadType, AActor* FollowActor, float ListenRadius, float MoveThreshold = 50.0f, EGameplayMessageMatch MatchType = EGameplayMessageMatch::ExactMatch, EGameplayMessagePriority Priority = EGameplayMessagePriority::DEFAULT);
+
 	/**
 	 * Asynchronously waits for a simple spatial gameplay message to be broadcast within a radius.
 	 *
@@ -73,6 +89,9 @@ public:
 	FAsyncGameplayWorldMessageDelegate OnMessageReceived;
 
 private:
+	// Take an action from the game instance's pool if enabled, or create one
+	static UAsyncAction_ListenForGameplayWorldMessage* CreateAction(UWorld* World, FGameplayTag Channel, UScriptStruct* PayloadType, EGameplayMessageMatch MatchType, EGameplayMessagePriority Priority, const FVector& ListenPosition, float ListenRadius, AActor* FollowActor, float MoveThreshold);
+
 	void HandleMessageReceived(FGameplayTag Channel, const UScriptStruct* StructType, void* Payload);
 
 private:
@@ -88,5 +107,12 @@ private:
 	FVector ListenPosition = FVector::ZeroVector;
 	float ListenRadius = 0.0f;
 
+	// Actor the listen position follows, if any
+	TWeakObjectPtr<AActor> FollowActor;
+	float FollowMoveThreshold = 0.0f;
+
 	FGameplayWorldMessageListenerHandle ListenerHandle;
+
+	// Waiting in UGameplayMessageAsyncActionPool, messages reaching the parked registration are ignored
+	bool bPooled = false;
 };
@@ -0,0 +1,88 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Engine/CancellableAsyncAction.h"
+#include "GameFramework/GameplayMessageStats.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+
+#include "GameplayMessageAsyncActionPool.generated.h"
+
+class UWorld;
+
+/**
+ * Keeps the listen async actions of a game instance for reuse once they are cancelled, instead of letting them be
+ * garbage collected and creating a new one for every node call.
+ *
+ * Enabled with GameplayMessages.AsyncActionPool.Enabled. A pooled action keeps its router registration, parked and
+ * ignoring messages, so listening again with the same parameters reuses it without registering again.
+ * Blueprints must not keep using a proxy object after cancelling it, it may already serve another node.
+ */
+UCLASS()
+class GAMEPLAYMESSAGERUNTIME_API UGameplayMessageAsyncActionPool : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	//~USubsystem interface
+	virtual void Deinitialize() override;
+	//~End of USubsystem interface
+
+	/** @return the pool of World's game instance, nullptr if pooling is disabled */
+	static UGameplayMessageAsyncActionPool* Get(const UWorld* World);
+
+	static bool IsEnabled();
+
+	/**
+	 * Take a pooled action of type ActionType, preferring one for which IsSameRegistration returns true.
+	 * Counts a pool hit, or a miss when nullptr is returned and the caller has to create the action.
+	 *
+	 * @param bOutSameRegistration	Set to true if the returned action passed IsSameRegistration
+	 */
+	template <typename ActionType, typename PredicateType>
+	ActionType* Acquire(PredicateType IsSameRegistration, bool& bOutSameRegistration)
+	{
+		bOutSameRegistration = false;
+
+		int32 FoundIndex = INDEX_NONE;
+		for (int32 Index = FreeActions.Num() - 1; Index >= 0; --Index)
+		{
+			if (ActionType* Action = Cast<ActionType>(FreeActions[Index]))
+			{
+				if (IsSameRegistration(*Action))
+				{
+					FoundIndex = Index;
+					bOutSameRegistration = true;
+					break;
+				}
+
+				if (FoundIndex == INDEX_NONE)
+				{
+					FoundIndex = Index;
+				}
+			}
+		}
+
+		if (FoundIndex == INDEX_NONE)
+		{
+			INC_DWORD_STAT(STAT_GameplayMessages_AsyncActionPoolMisses);
+			return nullptr;
+		}
+
+		INC_DWORD_STAT(STAT_GameplayMessages_AsyncActionPoolHits);
+		DEC_DWORD_STAT(STAT_GameplayMessages_AsyncActionsPooled);
+
+		ActionType* Action = CastChecked<ActionType>(FreeActions[FoundIndex]);
+		FreeActions.RemoveAtSwap(FoundIndex);
+		return Action;
+	}
+
+	/** Hand back a cancelled action. @return false if the pool is full, the caller then cleans the action up */
+	bool Release(UCancellableAsyncAction* Action);
+
+	int32 Num() const { return FreeActions.Num(); }
+
+private:
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UCancellableAsyncAction>> FreeActions;
+};
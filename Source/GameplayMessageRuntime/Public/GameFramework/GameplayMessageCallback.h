@@ -0,0 +1,219 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "GameplayTagContainer.h"
+#include "Templates/IsInvocable.h"
+#include "UObject/WeakObjectPtr.h"
+
+class UScriptStruct;
+
+/**
+ * Type erased listener callback, void(FGameplayTag Channel, const UScriptStruct* StructType, void* Payload).
+ *
+ * Works like a TFunction, except that callables up to InlineSize bytes (a typed thunk around a small lambda, or a weak
+ * object + member function pointer binding) are stored inside the object instead of on the heap. Larger callables
+ * fall back to a heap allocation. Invoking costs a single indirect call into a function that calls the stored callable
+ * directly, so a typed thunk does not forward through a second type-erased function.
+ */
+class FGameplayMessageCallback
+{
+public:
+	static constexpr SIZE_T InlineSize = 6 * sizeof(void*);
+
+	FGameplayMessageCallback() = default;
+	FGameplayMessageCallback(TYPE_OF_NULLPTR) {}
+
+	template <
+		typename FuncType,
+		typename = typename TEnableIf<
+			!TIsSame<typename TDecay<FuncType>::Type, FGameplayMessageCallback>::Value &&
+			TIsInvocable<typename TDecay<FuncType>::Type&, FGameplayTag, const UScriptStruct*, void*>::Value>::Type>
+	FGameplayMessageCallback(FuncType&& Func)
+	{
+		using FStoredType = typename TDecay<FuncType>::Type;
+		if constexpr (TOps<FStoredType>::bInline)
+		{
+			new (Storage) FStoredType(Forward<FuncType>(Func));
+		}
+		else
+		{
+			*reinterpret_cast<void**>(Storage) = new FStoredType(Forward<FuncType>(Func));
+		}
+		Ops = &TOps<FStoredType>::Table;
+	}
+
+	FGameplayMessageCallback(const FGameplayMessageCallback& Other)
+	{
+		if (Other.Ops)
+		{
+			Other.Ops->CopyConstruct(Storage, Other.GetObject());
+			Ops = Other.Ops;
+		}
+	}
+
+	FGameplayMessageCallback(FGameplayMessageCallback&& Other)
+	{
+		MoveFrom(Other);
+	}
+
+	~FGameplayMessageCallback()
+	{
+		Reset();
+	}
+
+	FGameplayMessageCallback& operator=(const FGameplayMessageCallback& Other)
+	{
+		if (this != &Other)
+		{
+			FGameplayMessageCallback Copy(Other);
+			Reset();
+			MoveFrom(Copy);
+		}
+		return *this;
+	}
+
+	FGameplayMessageCallback& operator=(FGameplayMessageCallback&& Other)
+	{
+		if (this != &Other)
+		{
+			Reset();
+			MoveFrom(Other);
+		}
+		return *this;
+	}
+
+	void operator()(FGameplayTag Channel, const UScriptStruct* StructType, void* Payload) const
+	{
+		checkSlow(Ops);
+		Ops->Invoke(GetObject(), Channel, StructType, Payload);
+	}
+
+	explicit operator bool() const { return Ops != nullptr; }
+
+	/** @return true if the callable lives inside this object rather than on the heap */
+	bool IsInline() const { return Ops != nullptr && Ops->bInline; }
+
+	void Reset()
+	{
+		if (Ops)
+		{
+			Ops->Destruct(GetObject());
+			Ops = nullptr;
+		}
+	}
+
+private:
+	struct FOps
+	{
+		void (*Invoke)(void* Object, FGameplayTag Channel, const UScriptStruct* StructType, void* Payload);
+
+		// Constructs a copy in DestStorage, inline or on the heap depending on the callable
+		void (*CopyConstruct)(void* DestStorage, const void* SourceObject);
+
+		// Only used for inline callables, heap callables are moved by stealing the pointer
+		void (*MoveConstruct)(void* DestStorage, void* SourceObject);
+
+		// Destroys the callable, and frees it if it lives on the heap
+		void (*Destruct)(void* Object);
+
+		bool bInline;
+	};
+
+	template <typename FStoredType>
+	struct TOps
+	{
+		static constexpr bool bInline = sizeof(FStoredType) <= InlineSize && alignof(FStoredType) <= 16;
+
+		static void Invoke(void* Object, FGameplayTag Channel, const UScriptStruct* StructType, void* Payload)
+		{
+			(*static_cast<FStoredType*>(Object))(Channel, StructType, Payload);
+		}
+
+		static void CopyConstruct(void* DestStorage, const void* SourceObject)
+		{
+			if constexpr (bInline)
+			{
+				new (DestStorage) FStoredType(*static_cast<const FStoredType*>(SourceObject));
+			}
+			else
+			{
+				*static_cast<void**>(DestStorage) = new FStoredType(*static_cast<const FStoredType*>(SourceObject));
+			}
+		}
+
+		static void MoveConstruct(void* DestStorage, void* SourceObject)
+		{
+			new (DestStorage) FStoredType(MoveTemp(*static_cast<FStoredType*>(SourceObject)));
+		}
+
+		static void Destruct(void* Object)
+		{
+			if constexpr (bInline)
+			{
+				static_cast<FStoredType*>(Object)->~FStoredType();
+			}
+			else
+			{
+				delete static_cast<FStoredType*>(Object);
+			}
+		}
+
+		static constexpr FOps Table = { &Invoke, &CopyConstruct, &MoveConstruct, &Destruct, bInline };
+	};
+
+	void* GetObject() const
+	{
+		return Ops->bInline ? const_cast<uint8*>(Storage) : *reinterpret_cast<void* const*>(Storage);
+	}
+
+	void MoveFrom(FGameplayMessageCallback& Other)
+	{
+		if (!Other.Ops)
+		{
+			return;
+		}
+
+		if (Other.Ops->bInline)
+		{
+			Other.Ops->MoveConstruct(Storage, Other.Storage);
+			Other.Ops->Destruct(Other.Storage);
+		}
+		else
+		{
+			*reinterpret_cast<void**>(Storage) = *reinterpret_cast<void**>(Other.Storage);
+		}
+
+		Ops = Other.Ops;
+		Other.Ops = nullptr;
+	}
+
+	alignas(16) uint8 Storage[InlineSize];
+	const FOps* Ops = nullptr;
+};
+
+namespace UE::GameplayMessage::Private
+{
+	/** Wrap a callable taking the message struct into a listener callback, the callable is stored and called directly */
+	template <typename FMessageStructType, typename FuncType>
+	FGameplayMessageCallback MakeTypedMessageCallback(FuncType&& Func)
+	{
+		return FGameplayMessageCallback([InnerCallback = Forward<FuncType>(Func)](FGameplayTag ActualTag, const UScriptStruct* SenderStructType, void* SenderPayload)
+		{
+			InnerCallback(ActualTag, *static_cast<const FMessageStructType*>(SenderPayload));
+		});
+	}
+
+	/** Listener callback calling a member function, skipped once the object is gone */
+	template <typename FMessageStructType, typename TOwner>
+	FGameplayMessageCallback MakeWeakMemberMessageCallback(TOwner* Object, void(TOwner::* Function)(FGameplayTag, const FMessageStructType&))
+	{
+		return FGameplayMessageCallback([WeakObject = TWeakObjectPtr<TOwner>(Object), Function](FGameplayTag ActualTag, const UScriptStruct* SenderStructType, void* SenderPayload)
+		{
+			if (TOwner* StrongObject = WeakObject.Get())
+			{
+				(StrongObject->*Function)(ActualTag, *static_cast<const FMessageStructType*>(SenderPayload));
+			}
+		});
+	}
+}
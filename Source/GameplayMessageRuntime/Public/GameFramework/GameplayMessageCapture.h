@@ -0,0 +1,144 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "GameplayTagContainer.h"
+#include "HAL/CriticalSection.h"
+#include "UObject/ObjectKey.h"
+
+class FAutoConsoleVariableRef;
+class UGameplayMessageSubsystem;
+class UGameplayWorldMessageSubsystem;
+class UScriptStruct;
+class UWorld;
+
+/** Router a captured message was broadcast through */
+enum class EGameplayMessageCaptureRouter : uint8
+{
+	Global,
+	World,
+};
+
+/** Shape a captured world message was broadcast in */
+enum class EGameplayMessageCaptureShape : uint8
+{
+	// Broadcast at WorldPosition
+	Point,
+	// Broadcast in a sphere centered on WorldPosition, of radius AreaExtent.X
+	Sphere,
+	// Broadcast in a box centered on WorldPosition, of half size AreaExtent
+	Box,
+};
+
+/** One broadcast as read back from a capture file */
+struct FGameplayMessageCaptureRecord
+{
+	// Seconds since engine start when the message was broadcast
+	double Time = 0.0;
+
+	EGameplayMessageCaptureRouter Router = EGameplayMessageCaptureRouter::Global;
+
+	FGameplayTag Channel;
+
+	FString StructPath;
+
+	// Path of the target object, empty for untargeted messages
+	FString TargetPath;
+
+	// Broadcast position of world messages, the center of area broadcasts
+	FVector WorldPosition = FVector::ZeroVector;
+
+	EGameplayMessageCaptureShape Shape = EGameplayMessageCaptureShape::Point;
+	FVector AreaExtent = FVector::ZeroVector;
+
+	// Payload as written by the struct's serializer, object references are stored as paths
+	TArray<uint8> Payload;
+};
+
+/**
+ * Records every broadcast of both routers into a fixed-size binary ring buffer, oldest messages are dropped first.
+ *
+ * Enabled with GameplayMessages.Capture.Enabled. The buffer is dumped to Saved/Profiling/GameplayMessages on demand
+ * with GameplayMessages.Capture.Dump, or automatically when an ensure fires (GameplayMessages.Capture.DumpOnEnsure).
+ * Unlike the LogMessages cvars a recorded message costs one serialization into a reused scratch buffer and a copy.
+ */
+class GAMEPLAYMESSAGERUNTIME_API FGameplayMessageCapture
+{
+public:
+	static FGameplayMessageCapture& Get();
+
+	/** @return true if broadcasts should be recorded, checked by the routers before calling Record */
+	static bool IsEnabled() { return bEnabled && !bSuppressed; }
+
+	void Record(EGameplayMessageCaptureRouter Router, FGameplayTag Channel, const UScriptStruct* StructType, const void* MessageBytes, const UObject* TargetObject, const FVector& WorldPosition,
+		EGameplayMessageCaptureShape Shape = EGameplayMessageCaptureShape::Point, const FVector& AreaExtent = FVector::ZeroVector);
+
+	/**
+	 * Write the buffered messages to Filename, or to a timestamped file in Saved/Profiling/GameplayMessages
+	 *
+	 * @return the path of the written file, empty on failure or if nothing has been recorded
+	 */
+	FString Dump(const FString& Filename = FString());
+
+	/** Drop every buffered message */
+	void Reset();
+
+	int32 Num() const;
+
+	/** Read the records of a capture file written by Dump */
+	static bool Load(const FString& Filename, TArray<FGameplayMessageCaptureRecord>& OutRecords);
+
+private:
+	FGameplayMessageCapture();
+
+	void HandleSystemEnsure();
+
+	void WriteBytes(int32 Offset, const void* Data, int32 NumBytes);
+	void ReadBytes(int32 Offset, void* Data, int32 NumBytes) const;
+	void DropOldestRecord();
+
+	static bool bEnabled;
+	static bool bSuppressed;
+	static FAutoConsoleVariableRef CVarEnabled;
+
+	mutable FCriticalSection CriticalSection;
+
+	// Records stored back to back as [uint32 Size][Size bytes], wrapping around the end of the buffer
+	TArray<uint8> Buffer;
+	int32 ReadOffset = 0;
+	int32 UsedBytes = 0;
+	int32 NumRecords = 0;
+
+	// Reused serialization buffer of the record being written
+	TArray<uint8> Scratch;
+
+	TMap<FObjectKey, FString> StructPaths;
+
+	friend class FGameplayMessageReplay;
+};
+
+/**
+ * Re-broadcasts capture records through the routers of a world, to reproduce and profile message storms.
+ * Replayed messages are not recorded again.
+ *
+ * Console: GameplayMessages.Replay <File> [Rate=1.0] [Immediate], GameplayMessages.Replay.Stop
+ */
+class GAMEPLAYMESSAGERUNTIME_API FGameplayMessageReplay
+{
+public:
+	/** Broadcast a single record. @return false if its struct or router could not be found */
+	static bool Broadcast(UWorld* World, const FGameplayMessageCaptureRecord& Record);
+
+	/** Broadcast a single record through the given routers, either may be null. @return false if its struct or router could not be found */
+	static bool Broadcast(UGameplayMessageSubsystem* GlobalRouter, UGameplayWorldMessageSubsystem* WorldRouter, const FGameplayMessageCaptureRecord& Record);
+
+	/** Broadcast every record right away, in capture order. @return the number of records broadcast */
+	static int32 ReplayImmediate(UWorld* World, TConstArrayView<FGameplayMessageCaptureRecord> Records);
+
+	/** Replay the records over time following their timestamps, Rate scales the playback speed. Stops any running replay. */
+	static void StartTimed(UWorld* World, TArray<FGameplayMessageCaptureRecord>&& Records, float Rate = 1.0f);
+
+	static void Stop();
+
+	static bool IsReplaying();
+};
@@ -0,0 +1,93 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "GameFramework/GameplayMessageSubsystem.h"
+#include "NativeGameplayTags.h"
+
+/**
+ * A statically typed message channel, declared once next to the message struct for hot fixed channels:
+ *
+ *    static TGameplayMessageChannel<FHitMessage> HitChannel(TAG_Gameplay_Hit);
+ *
+ *    HitChannel.RegisterListener(Router, [](FGameplayTag Channel, const FHitMessage& Hit) { ... });
+ *    HitChannel.Broadcast(Router, Hit);
+ *
+ * Broadcasting through the channel skips the struct lookup and tag matching: the matching buckets are cached for one
+ * router at a time, the last one broadcast through, and gathered again once buckets have been added or removed or
+ * when another router is used. A channel shared by the routers of several game instances (PIE) gathers on every
+ * switch. Listeners registered through the channel keep their typed callable inline in the listener record, invoked
+ * by a thunk generated for it, with no allocation.
+ * Such listeners still receive regular broadcasts, and channel broadcasts reach listeners registered through the
+ * router as usual.
+ *
+ * Channel broadcasts are untargeted, use UGameplayMessageSubsystem::BroadcastMessage to send to a TargetObject.
+ * Game thread only, like the router itself.
+ */
+template <typename FMessageStructType>
+class TGameplayMessageChannel
+{
+public:
+	explicit TGameplayMessageChannel(FGameplayTag InChannel)
+		: Channel(InChannel)
+	{
+	}
+
+	/** Native tags are only valid once the tag manager is up, so they are resolved on use */
+	explicit TGameplayMessageChannel(const FNativeGameplayTag& InNativeChannel)
+		: NativeChannel(&InNativeChannel)
+	{
+	}
+
+	UE_NONCOPYABLE(TGameplayMessageChannel);
+
+	FGameplayTag GetChannel() const
+	{
+		return NativeChannel ? NativeChannel->GetTag() : Channel;
+	}
+
+	/**
+	 * Broadcast a message on this channel
+	 *
+	 * @param Router			The router to broadcast through
+	 * @param Message			The message to send
+	 */
+	FGameplayMessageBroadcastResult Broadcast(UGameplayMessageSubsystem& Router, FMessageStructType& Message) const
+	{
+		const UScriptStruct* StructType = TBaseStructure<FMessageStructType>::Get();
+		return Router.BroadcastMessageInternal(GetChannel(), StructType, &Message, nullptr, &RoutingCache);
+	}
+
+	/**
+	 * Register to receive messages on this channel
+	 *
+	 * @param Router			The router to register with
+	 * @param Callback			Function to call with the message when someone broadcasts it
+	 *
+	 * @return a handle that can be used to unregister this listener (either by calling Unregister() on the handle or calling UnregisterListener on the router)
+	 */
+	template <typename FuncType, typename = typename TEnableIf<TIsInvocable<typename TDecay<FuncType>::Type&, FGameplayTag, const FMessageStructType&>::Value>::Type>
+	FGameplayMessageListenerHandle RegisterListener(UGameplayMessageSubsystem& Router, FuncType&& Callback, EGameplayMessageMatch MatchType = EGameplayMessageMatch::ExactMatch, EGameplayMessagePriority Priority = EGameplayMessagePriority::DEFAULT, TWeakObjectPtr<UObject> TargetObject = nullptr, EGameplayMessageListenerFlags Flags = EGameplayMessageListenerFlags::None) const
+	{
+		const UScriptStruct* StructType = TBaseStructure<FMessageStructType>::Get();
+		return Router.RegisterListenerInternal(GetChannel(), UE::GameplayMessage::Private::MakeTypedMessageCallback<FMessageStructType>(Forward<FuncType>(Callback)), StructType, MatchType, static_cast<int32>(Priority), TargetObject, Flags);
+	}
+
+	/**
+	 * Register to receive messages on this channel and handle them with a member function.
+	 * Executes a weak object validity check to ensure the object registering the function still exists before triggering the callback
+	 */
+	template <typename TOwner = UObject>
+	FGameplayMessageListenerHandle RegisterListener(UGameplayMessageSubsystem& Router, TOwner* Object, void(TOwner::* Function)(FGameplayTag, const FMessageStructType&)) const
+	{
+		const UScriptStruct* StructType = TBaseStructure<FMessageStructType>::Get();
+		return Router.RegisterListenerInternal(GetChannel(), UE::GameplayMessage::Private::MakeWeakMemberMessageCallback<FMessageStructType>(Object, Function), StructType, EGameplayMessageMatch::ExactMatch);
+	}
+
+private:
+	FGameplayTag Channel;
+	const FNativeGameplayTag* NativeChannel = nullptr;
+
+	// Buckets of a single router, the last one broadcast through
+	mutable FGameplayMessageRouter::FChannelRoutingCache RoutingCache;
+};
@@ -0,0 +1,177 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Containers/Queue.h"
+#include "GameFramework/GameplayMessageTypes2.h"
+#include "GameplayTagContainer.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Misc/MemStack.h"
+#include "UObject/WeakObjectPtr.h"
+
+class UScriptStruct;
+
+// Called once a queued message has been dispatched, with the result of that dispatch
+using FGameplayMessageQueuedCallback = TFunction<void(const FGameplayMessageBroadcastResult&)>;
+
+/**
+ * A message waiting in a router queue. The payload is a copy of the broadcaster's struct owned by the queue's arena.
+ */
+struct FQueuedGameplayMessage
+{
+	const UScriptStruct* StructType = nullptr;
+	void* Payload = nullptr;
+	FGameplayTag Channel;
+
+	// Only used by UGameplayMessageSubsystem
+	TWeakObjectPtr<UObject> TargetObject;
+
+	// Only used by UGameplayWorldMessageSubsystem
+	FVector WorldPosition = FVector::ZeroVector;
+
+	FGameplayMessageQueuedCallback OnComplete;
+
+	// Number of later messages folded into this one by coalescing
+	int32 NumCoalesced = 0;
+};
+
+/**
+ * Running totals of a router's message queue
+ */
+struct FGameplayMessageQueueStats
+{
+	// Messages handed to QueueMessage
+	int64 NumQueued = 0;
+
+	// Queued messages merged into an earlier message for the same key instead of being dispatched
+	int64 NumCoalesced = 0;
+
+	// Dispatches actually performed when flushing
+	int64 NumDispatched = 0;
+
+	// Size of the last flushed batch, before and after coalescing
+	int32 LastFlushQueued = 0;
+	int32 LastFlushDispatched = 0;
+};
+
+/**
+ * Messages queued for deferred dispatch by one of the routers.
+ *
+ * Payloads are copied once into a page arena (InitializeStruct + CopyScriptStruct) and destroyed in bulk once the
+ * queue has been dispatched. Both the arena pages and the message array are kept between frames, so a steady
+ * message rate does not allocate.
+ */
+class GAMEPLAYMESSAGERUNTIME_API FGameplayMessageQueue
+{
+public:
+	FGameplayMessageQueue() = default;
+	~FGameplayMessageQueue();
+
+	UE_NONCOPYABLE(FGameplayMessageQueue);
+
+	/** Copy a message into the queue, the returned entry can be used to fill in the router specific fields */
+	FQueuedGameplayMessage& Enqueue(const UScriptStruct* StructType, const void* MessageBytes, FGameplayTag Channel);
+
+	/**
+	 * Copy a message into the queue, or overwrite the payload of the message already queued for the same
+	 * (StructType, Channel, TargetObject) key. The completion callbacks of merged messages are all invoked with the
+	 * result of the single dispatch.
+	 */
+	FQueuedGameplayMessage& EnqueueCoalesced(const UScriptStruct* StructType, const void* MessageBytes, FGameplayTag Channel, TWeakObjectPtr<UObject> TargetObject, FGameplayMessageQueuedCallback&& OnComplete);
+
+	/** Group messages by struct type and then channel, so consecutive dispatches hit the same listener lists. Queue order is kept within a group. */
+	void SortForDispatch();
+
+	TArrayView<FQueuedGameplayMessage> GetMessages() { return Messages; }
+
+	int32 Num() const { return Messages.Num(); }
+	bool IsEmpty() const { return Messages.Num() == 0; }
+
+	/** Messages received by this queue since the last reset, including coalesced ones */
+	int32 NumReceived() const { return NumEnqueued; }
+
+	/** Destroy every queued payload and empty the queue, keeping its memory for the next frame */
+	void Reset();
+
+private:
+	struct FCoalesceKey
+	{
+		const UScriptStruct* StructType = nullptr;
+		FGameplayTag Channel;
+		TWeakObjectPtr<UObject> TargetObject;
+
+		bool operator==(const FCoalesceKey& Other) const
+		{
+			return StructType == Other.StructType && Channel == Other.Channel && TargetObject == Other.TargetObject;
+		}
+
+		friend uint32 GetTypeHash(const FCoalesceKey& Key)
+		{
+			return HashCombine(HashCombine(::GetTypeHash(Key.StructType), GetTypeHash(Key.Channel)), GetTypeHash(Key.TargetObject));
+		}
+	};
+
+	TArray<FQueuedGameplayMessage> Messages;
+
+	// Index into Messages of the coalescing message for each key, only holds coalesced channels
+	TMap<FCoalesceKey, int32> CoalescedMessages;
+
+	int32 NumEnqueued = 0;
+
+	FMemStackBase Arena;
+};
+
+/**
+ * Messages posted from any thread, waiting to be broadcast by a router on the game thread.
+ *
+ * Producers never take a lock: the payload is copied on the calling thread into the node pushed onto a lock-free
+ * multi-producer / single-consumer queue, so posting a message makes a single allocation. Only payloads larger than
+ * InlinePayloadSize get an allocation of their own. The game thread drains the whole inbox in one batch.
+ * Messages posted by one thread are dispatched in the order that thread posted them. Messages from different threads
+ * are dispatched in the order their pushes landed, which is not otherwise defined.
+ */
+class GAMEPLAYMESSAGERUNTIME_API FGameplayMessageInbox
+{
+public:
+	static constexpr SIZE_T InlinePayloadSize = 128;
+
+	FGameplayMessageInbox() = default;
+	~FGameplayMessageInbox();
+
+	UE_NONCOPYABLE(FGameplayMessageInbox);
+
+	/** Copy a message into the inbox. Safe to call from any thread, the payload struct must be safe to copy off the game thread. */
+	void Enqueue(const UScriptStruct* StructType, const void* MessageBytes, FGameplayTag Channel, TWeakObjectPtr<UObject> TargetObject, const FVector& WorldPosition);
+
+	/**
+	 * Hand every message posted before this call to Dispatch, then destroy it. Game thread only.
+	 * Messages posted while draining, including those posted by Dispatch itself, wait for the next drain.
+	 *
+	 * @return the number of messages dispatched
+	 */
+	int32 Drain(TFunctionRef<void(FQueuedGameplayMessage&)> Dispatch);
+
+	bool IsEmpty() const { return NumPending.GetValue() == 0; }
+
+	/** Destroy every pending message without dispatching it. Game thread only. */
+	void Reset();
+
+private:
+	// A message as stored in its queue node. Relocated bitwise by the push, the payload pointer is only set by the
+	// consumer once the node has stopped moving.
+	struct FInboxMessage
+	{
+		FQueuedGameplayMessage Message;
+
+		// Payloads that fit are stored here, the others on the heap at Message.Payload
+		bool bInlinePayload = false;
+		alignas(16) uint8 InlinePayload[InlinePayloadSize];
+	};
+
+	static void DestroyMessage(FInboxMessage& Pending);
+
+	TQueue<FInboxMessage, EQueueMode::Mpsc> Messages;
+
+	// Incremented after each push, so the consumer never waits on a message it has been told about
+	FThreadSafeCounter NumPending;
+};
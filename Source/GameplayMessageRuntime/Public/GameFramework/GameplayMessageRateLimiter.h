@@ -0,0 +1,91 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "GameplayTagContainer.h"
+#include "UObject/ObjectKey.h"
+
+class FOutputDevice;
+struct FGameplayMessageRateLimit;
+enum class EGameplayMessageRateLimitWindow : uint8;
+
+/**
+ * Broadcast budgets of one router's rate limited channels, @see UGameplayMessageSettings::RateLimits.
+ *
+ * Windows are fixed (a frame, or a whole second of wall clock time) and a budget is only created by the first
+ * broadcast of its window, so channels without a limit cost a single settings check.
+ */
+class GAMEPLAYMESSAGERUNTIME_API FGameplayMessageRateLimiter
+{
+public:
+	/** @return the limit of Channel, nullptr if it is not rate limited */
+	const FGameplayMessageRateLimit* FindLimit(FGameplayTag Channel);
+
+	/**
+	 * Count a broadcast on Channel against its budget. TargetObject and GridCell are only used by the limits scoped to them.
+	 *
+	 * @return false if the budget of the current window is already spent and the broadcast has to be dropped
+	 */
+	bool TryConsume(const FGameplayMessageRateLimit& Limit, FGameplayTag Channel, FObjectKey TargetObject, int64 GridCell);
+
+	/** Forget the budgets whose window is over and free the memory they used */
+	void Prune();
+
+	/** Forget the budgets whose window is over, at most once per second. Cheap enough to call every tick. */
+	void PruneExpired();
+
+	/** @return true if any budget is kept, expired or not */
+	bool HasBudgets() const { return Budgets.Num() > 0; }
+
+	void Reset();
+
+	/** @return the number of broadcasts dropped per channel */
+	const TMap<FGameplayTag, int64>& GetNumThrottled() const { return NumThrottledByChannel; }
+
+	/** Log the drop counts, most throttled channel first */
+	void DumpThrottled(FOutputDevice& Ar, const TCHAR* RouterName) const;
+
+private:
+	static uint64 GetCurrentWindow(EGameplayMessageRateLimitWindow Window);
+
+	void RemoveExpiredBudgets();
+
+	struct FBudgetKey
+	{
+		FGameplayTag Channel;
+		FObjectKey TargetObject;
+		int64 GridCell = 0;
+
+		bool operator==(const FBudgetKey& Other) const
+		{
+			return Channel == Other.Channel && TargetObject == Other.TargetObject && GridCell == Other.GridCell;
+		}
+
+		friend uint32 GetTypeHash(const FBudgetKey& Key)
+		{
+			return HashCombine(GetTypeHash(Key.Channel), HashCombine(GetTypeHash(Key.TargetObject), GetTypeHash(Key.GridCell)));
+		}
+	};
+
+	struct FBudget
+	{
+		uint64 Window = 0;
+		int32 NumBroadcasts = 0;
+		EGameplayMessageRateLimitWindow WindowType;
+	};
+
+	TMap<FBudgetKey, FBudget> Budgets;
+
+	// Index of the limit of every channel looked up so far, INDEX_NONE for channels without one
+	TMap<FGameplayTag, int32> LimitIndexByChannel;
+
+	// Revision and number of the limits in the settings when LimitIndexByChannel was filled, the cache is dropped
+	// when either changes
+	uint32 CachedLimitsRevision = 0;
+	int32 NumCachedLimits = 0;
+
+	// Time of the next PruneExpired that does anything
+	double NextPruneTime = 0.0;
+
+	TMap<FGameplayTag, int64> NumThrottledByChannel;
+};
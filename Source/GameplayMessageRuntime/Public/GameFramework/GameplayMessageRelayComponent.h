@@ -0,0 +1,136 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Components/ActorComponent.h"
+#include "GameFramework/GameplayMessageCapture.h"
+#include "GameplayTagContainer.h"
+
+#include "GameplayMessageRelayComponent.generated.h"
+
+class APlayerController;
+class UPackageMap;
+class UScriptStruct;
+
+/** One relayed message, its payload already serialized with the receiving connection's package map */
+struct FGameplayMessageRelayEntry
+{
+	const UScriptStruct* StructType = nullptr;
+
+	FGameplayTag Channel;
+
+	EGameplayMessageCaptureRouter Router = EGameplayMessageCaptureRouter::Global;
+
+	// Global router only. A targeted message whose target does not resolve on the client is dropped, not broadcast untargeted
+	TWeakObjectPtr<UObject> TargetObject;
+	bool bHasTarget = false;
+
+	// World router only
+	FVector WorldPosition = FVector::ZeroVector;
+
+	// Payload written by the struct's NetSerialize, or by its property serializer for structs without one
+	TArray<uint8> Payload;
+	int32 PayloadBits = 0;
+};
+
+/**
+ * The messages relayed to one connection during a frame, sent as a single RPC.
+ * Consecutive messages of the same struct type only send their type once, and a payload of the same size as the
+ * previous one is sent as a per-byte delta: one bit for every unchanged byte.
+ */
+USTRUCT()
+struct GAMEPLAYMESSAGERUNTIME_API FGameplayMessageRelayBatch
+{
+	GENERATED_BODY()
+
+	// Upper bounds accepted from the wire
+	static constexpr uint32 MaxEntries = 1024;
+	static constexpr uint32 MaxPayloadBits = 64 * 1024 * 8;
+
+	TArray<FGameplayMessageRelayEntry> Entries;
+
+	// Sum of the payload sizes, used to send large batches early
+	int32 NumPayloadBytes = 0;
+
+	void Reset()
+	{
+		Entries.Reset();
+		NumPayloadBytes = 0;
+	}
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FGameplayMessageRelayBatch> : public TStructOpsTypeTraitsBase2<FGameplayMessageRelayBatch>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
+
+/**
+ * Relays the messages broadcast on the server on UGameplayMessageSettings::ReplicatedChannels to the owning client,
+ * where they are broadcast again through the same router. Add it to the PlayerController class.
+ *
+ * Messages are batched per connection and sent once per frame instead of one RPC each. World messages are only sent
+ * when they are within the client's relevancy bounds, a sphere around its view target containing the listen spheres
+ * registered with the client's UGameplayWorldMessageSubsystem, as reported by the client. Payloads larger than
+ * FGameplayMessageRelayBatch::MaxPayloadBits are not relayed.
+ * Global messages targeting an object that cannot be referenced over the network are not relayed, and neither are
+ * area broadcasts.
+ */
+UCLASS(ClassGroup=Messaging, meta=(BlueprintSpawnableComponent))
+class GAMEPLAYMESSAGERUNTIME_API UGameplayMessageRelayComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UGameplayMessageRelayComponent();
+
+	//~UActorComponent interface
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	//~End of UActorComponent interface
+
+	/** @return true if any server side relay is active, checked by the routers before calling RelayMessage */
+	static bool HasServerRelays() { return ServerRelays.Num() > 0; }
+
+	/** Hand a message broadcast on the server to the relays of World */
+	static void RelayMessage(const UWorld* World, EGameplayMessageCaptureRouter Router, FGameplayTag Channel, const UScriptStruct* StructType, const void* MessageBytes, const UObject* TargetObject, const FVector& WorldPosition);
+
+	/** Send the messages batched so far, done at the end of every frame */
+	void FlushBatch();
+
+protected:
+	UFUNCTION(Client, Reliable)
+	void ClientReceiveMessages(const FGameplayMessageRelayBatch& Batch);
+
+	UFUNCTION(Server, Reliable)
+	void ServerSetRelevancyBounds(FVector Center, float Radius);
+
+private:
+	APlayerController* GetPlayerController() const;
+
+	void EnqueueMessage(EGameplayMessageCaptureRouter Router, FGameplayTag Channel, const UScriptStruct* StructType, const void* MessageBytes, const UObject* TargetObject, const FVector& WorldPosition);
+
+	// Client side: report the bounds of the local listeners when they changed noticeably
+	void UpdateRelevancyBounds(float DeltaTime);
+
+	// Server side messages waiting for the end of the frame
+	FGameplayMessageRelayBatch PendingBatch;
+
+	// Server side: sphere within which world messages are relayed, everything until reported
+	FVector RelevancyCenter = FVector::ZeroVector;
+	float RelevancyRadius = MAX_flt;
+
+	// Client side: last bounds sent to the server
+	FVector ReportedRelevancyCenter = FVector::ZeroVector;
+	float ReportedRelevancyRadius = -1.0f;
+	float TimeUntilRelevancyReport = 0.0f;
+
+	// Relays of remote connections on the server
+	static TArray<UGameplayMessageRelayComponent*> ServerRelays;
+};
@@ -0,0 +1,172 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Engine/DeveloperSettings.h"
+#include "GameplayTagContainer.h"
+#include "UObject/SoftObjectPtr.h"
+
+#include "GameplayMessageSettings.generated.h"
+
+class UWorld;
+
+/** How UGameplayWorldMessageSubsystem indexes its listeners */
+UENUM()
+enum class EGameplayWorldMessageGridMode : uint8
+{
+	// A single grid, listeners are stored in every cell their radius overlaps
+	Uniform,
+
+	// A multi-level grid, each level LevelScale times coarser than the previous one. Listeners are stored in the first
+	// level whose cells are at least as wide as their diameter, so they overlap at most 2x2 cells of it. Broadcasts
+	// look up one cell per level.
+	Hierarchical,
+};
+
+/** Spatial index configuration of a world's UGameplayWorldMessageSubsystem */
+USTRUCT()
+struct GAMEPLAYMESSAGERUNTIME_API FGameplayWorldMessageGridSettings
+{
+	GENERATED_BODY()
+
+	// Width of a cell of the (finest) grid level
+	UPROPERTY(EditAnywhere, Category="Grid", meta=(ClampMin="100.0", ForceUnits="cm"))
+	float CellSize = 1600.0f;
+
+	UPROPERTY(EditAnywhere, Category="Grid")
+	EGameplayWorldMessageGridMode Mode = EGameplayWorldMessageGridMode::Uniform;
+
+	// Number of grid levels in hierarchical mode, listeners too large for the last level overlap more of its cells
+	UPROPERTY(EditAnywhere, Category="Grid", meta=(ClampMin="2", ClampMax="8", EditCondition="Mode == EGameplayWorldMessageGridMode::Hierarchical"))
+	int32 NumLevels = 5;
+
+	// Cell width ratio between two consecutive levels in hierarchical mode
+	UPROPERTY(EditAnywhere, Category="Grid", meta=(ClampMin="2", ClampMax="16", EditCondition="Mode == EGameplayWorldMessageGridMode::Hierarchical"))
+	int32 LevelScale = 4;
+
+	// Partition along Z as well, so broadcasts on one floor of an interior or tall city skip the listeners stacked above
+	// and below. Cell coordinates are packed into 21 bits per axis; cells further than 2^20 cells from the origin alias,
+	// which costs extra distance tests but never drops a message.
+	UPROPERTY(EditAnywhere, Category="Grid")
+	bool bPartitionZ = false;
+
+	// Height of a (finest level) cell when partitioning along Z, 0 uses CellSize
+	UPROPERTY(EditAnywhere, Category="Grid", meta=(ClampMin="0.0", ForceUnits="cm", EditCondition="bPartitionZ"))
+	float CellHeight = 0.0f;
+};
+
+/** Window a rate limited channel's budget is counted over */
+UENUM()
+enum class EGameplayMessageRateLimitWindow : uint8
+{
+	Frame,
+
+	// One second of wall clock time
+	Second,
+};
+
+/** What a rate limited channel keeps separate budgets for */
+UENUM()
+enum class EGameplayMessageRateLimitScope : uint8
+{
+	// A single budget for every broadcast on the channel
+	Channel,
+
+	// A budget per target object of UGameplayMessageSubsystem broadcasts, untargeted broadcasts share one
+	TargetObject,
+
+	// A budget per cell of the finest grid level UGameplayWorldMessageSubsystem broadcasts land in
+	GridCell,
+};
+
+/** Broadcast budget of a channel, @see UGameplayMessageSettings::RateLimits */
+USTRUCT()
+struct GAMEPLAYMESSAGERUNTIME_API FGameplayMessageRateLimit
+{
+	GENERATED_BODY()
+
+	// Channel the limit applies to, child channels included. Each broadcast channel counts its own budget.
+	UPROPERTY(EditAnywhere, Category="Rate Limit")
+	FGameplayTag Channel;
+
+	// Broadcasts dispatched per window, the following ones are dropped until the next window
+	UPROPERTY(EditAnywhere, Category="Rate Limit", meta=(ClampMin="1"))
+	int32 MaxBroadcasts = 1;
+
+	UPROPERTY(EditAnywhere, Category="Rate Limit")
+	EGameplayMessageRateLimitWindow Window = EGameplayMessageRateLimitWindow::Frame;
+
+	UPROPERTY(EditAnywhere, Category="Rate Limit")
+	EGameplayMessageRateLimitScope Scope = EGameplayMessageRateLimitScope::Channel;
+};
+
+/**
+ * Project wide settings for the gameplay message routers
+ */
+UCLASS(config=Game, defaultconfig, meta=(DisplayName="Gameplay Message Router"))
+class GAMEPLAYMESSAGERUNTIME_API UGameplayMessageSettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+
+public:
+	UGameplayMessageSettings();
+
+	/**
+	 * Channels whose queued messages are coalesced ("last value wins"). Messages queued for the same struct type, channel
+	 * and target object within one frame collapse into a single dispatch carrying the last payload.
+	 * Child channels of a listed tag are coalesced as well. Only affects UGameplayMessageSubsystem::QueueMessage.
+	 */
+	UPROPERTY(config, EditAnywhere, Category="Queue")
+	FGameplayTagContainer CoalescedChannels;
+
+	bool ShouldCoalesce(FGameplayTag Channel) const { return !CoalescedChannels.IsEmpty() && Channel.MatchesAny(CoalescedChannels); }
+
+	/**
+	 * Channels relayed from the server to clients by UGameplayMessageRelayComponent, child channels included.
+	 * Messages broadcast on the server through either router are sent to the owning client of every relay component,
+	 * batched once per frame, and broadcast again through the same router on the client.
+	 */
+	UPROPERTY(config, EditAnywhere, Category="Replication")
+	FGameplayTagContainer ReplicatedChannels;
+
+	bool ShouldReplicate(FGameplayTag Channel) const { return !ReplicatedChannels.IsEmpty() && Channel.MatchesAny(ReplicatedChannels); }
+
+	/** Payload bytes after which a relay batch is sent right away instead of waiting for the end of the frame */
+	UPROPERTY(config, EditAnywhere, Category="Replication", meta=(ClampMin="256", Units="Bytes"))
+	int32 RelayMaxBatchBytes = 8192;
+
+	/**
+	 * Broadcast budgets of high frequency channels. Broadcasts over budget are dropped before reaching any listener
+	 * and report FGameplayMessageBroadcastResult::bThrottled. When several limits match a channel the most specific
+	 * tag wins. Drops are counted in "stat GameplayMessages" and listed by GameplayMessages.DumpThrottled.
+	 */
+	UPROPERTY(config, EditAnywhere, Category="Rate Limiting")
+	TArray<FGameplayMessageRateLimit> RateLimits;
+
+	/** Drop the limits the routers resolved per channel, call after changing RateLimits from code */
+	void NotifyRateLimitsChanged() { ++RateLimitsRevision; }
+
+	/** @return a number bumped whenever RateLimits changes */
+	uint32 GetRateLimitsRevision() const { return RateLimitsRevision; }
+
+	/** Spatial index of the world message routers, unless overridden for their world */
+	UPROPERTY(config, EditAnywhere, Category="World")
+	FGameplayWorldMessageGridSettings DefaultWorldGrid;
+
+	/** Per map spatial index settings, e.g. a coarser or hierarchical grid for open worlds */
+	UPROPERTY(config, EditAnywhere, Category="World")
+	TMap<TSoftObjectPtr<UWorld>, FGameplayWorldMessageGridSettings> WorldGridOverrides;
+
+	/** @return the grid settings of World, PIE worlds use the settings of the map they were duplicated from */
+	const FGameplayWorldMessageGridSettings& GetWorldGridSettings(const UWorld* World) const;
+
+	//~UObject interface
+	virtual void PostReloadConfig(FProperty* PropertyThatWasLoaded) override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+	//~End of UObject interface
+
+private:
+	uint32 RateLimitsRevision = 0;
+};
@@ -0,0 +1,78 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "GameplayTagContainer.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+
+class UScriptStruct;
+
+/**
+ * Profiling hooks of the message routers.
+ *
+ * "stat GameplayMessages" shows the per frame counters. Tracing with -trace=cpu,GameplayMessages (or
+ * "Trace.Enable GameplayMessages") adds a CPU scope per broadcast named after its channel and struct, and one per
+ * listener callback named after the channel it registered on. Scope names are only built while the channel is traced.
+ * "GameplayMessages.DumpMemory" logs the memory used by the routers of the current world.
+ */
+UE_TRACE_CHANNEL_EXTERN(GameplayMessagesChannel, GAMEPLAYMESSAGERUNTIME_API);
+
+DECLARE_STATS_GROUP(TEXT("GameplayMessages"), STATGROUP_GameplayMessages, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Broadcast"), STAT_GameplayMessages_Broadcast, STATGROUP_GameplayMessages, GAMEPLAYMESSAGERUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Flush Queue"), STAT_GameplayMessages_FlushQueue, STATGROUP_GameplayMessages, GAMEPLAYMESSAGERUNTIME_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Broadcasts"), STAT_GameplayMessages_Broadcasts, STATGROUP_GameplayMessages, GAMEPLAYMESSAGERUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Listeners Visited"), STAT_GameplayMessages_ListenersVisited, STATGROUP_GameplayMessages, GAMEPLAYMESSAGERUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Listeners Invoked"), STAT_GameplayMessages_ListenersInvoked, STATGROUP_GameplayMessages, GAMEPLAYMESSAGERUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Cancellations"), STAT_GameplayMessages_Cancellations, STATGROUP_GameplayMessages, GAMEPLAYMESSAGERUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Grid Cells Touched"), STAT_GameplayMessages_GridCellsTouched, STATGROUP_GameplayMessages, GAMEPLAYMESSAGERUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Queue Depth"), STAT_GameplayMessages_QueueDepth, STATGROUP_GameplayMessages, GAMEPLAYMESSAGERUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Messages Coalesced"), STAT_GameplayMessages_Coalesced, STATGROUP_GameplayMessages, GAMEPLAYMESSAGERUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Throttled Broadcasts"), STAT_GameplayMessages_ThrottledBroadcasts, STATGROUP_GameplayMessages, GAMEPLAYMESSAGERUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Far Deliveries Skipped"), STAT_GameplayMessages_FarDeliveriesSkipped, STATGROUP_GameplayMessages, GAMEPLAYMESSAGERUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Inbox Messages"), STAT_GameplayMessages_InboxMessages, STATGROUP_GameplayMessages, GAMEPLAYMESSAGERUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Followed Listeners Moved"), STAT_GameplayMessages_FollowedListenersMoved, STATGROUP_GameplayMessages, GAMEPLAYMESSAGERUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Relayed Messages"), STAT_GameplayMessages_RelayedMessages, STATGROUP_GameplayMessages, GAMEPLAYMESSAGERUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Relay Batches"), STAT_GameplayMessages_RelayBatches, STATGROUP_GameplayMessages, GAMEPLAYMESSAGERUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Relay Payload Bytes"), STAT_GameplayMessages_RelayPayloadBytes, STATGROUP_GameplayMessages, GAMEPLAYMESSAGERUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Async Action Pool Hits"), STAT_GameplayMessages_AsyncActionPoolHits, STATGROUP_GameplayMessages, GAMEPLAYMESSAGERUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Async Action Pool Misses"), STAT_GameplayMessages_AsyncActionPoolMisses, STATGROUP_GameplayMessages, GAMEPLAYMESSAGERUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Async Action Registrations Reused"), STAT_GameplayMessages_AsyncActionRegistrationsReused, STATGROUP_GameplayMessages, GAMEPLAYMESSAGERUNTIME_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Async Actions Pooled"), STAT_GameplayMessages_AsyncActionsPooled, STATGROUP_GameplayMessages, GAMEPLAYMESSAGERUNTIME_API);
+
+namespace UE::GameplayMessage::Private
+{
+	/** CPU trace scope on the GameplayMessages channel, named "<Prefix> <Channel> (<Struct>)" */
+	class FMessageTraceScope
+	{
+	public:
+#if CPUPROFILERTRACE_ENABLED
+		FMessageTraceScope(const TCHAR* Prefix, FGameplayTag Channel, const UScriptStruct* StructType)
+		{
+			if (UE_TRACE_CHANNELEXPR_IS_ENABLED(GameplayMessagesChannel))
+			{
+				bTraced = true;
+				FCpuProfilerTrace::OutputBeginDynamicEvent(*FString::Printf(TEXT("%s %s (%s)"), Prefix, *Channel.ToString(), *GetNameSafe(StructType)));
+			}
+		}
+
+		~FMessageTraceScope()
+		{
+			if (bTraced)
+			{
+				FCpuProfilerTrace::OutputEndEvent();
+			}
+		}
+
+	private:
+		bool bTraced = false;
+#else
+		FMessageTraceScope(const TCHAR* Prefix, FGameplayTag Channel, const UScriptStruct* StructType) {}
+#endif
+
+		UE_NONCOPYABLE(FMessageTraceScope);
+	};
+}
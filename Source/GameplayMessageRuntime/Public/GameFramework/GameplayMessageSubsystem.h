@@ -2,14 +2,23 @@
 
 #pragma once
 
+#include "GameFramework/GameplayMessageCallback.h"
+#include "GameFramework/GameplayMessageQueue.h"
+#include "GameFramework/GameplayMessageRateLimiter.h"
 #include "GameFramework/GameplayMessageTypes2.h"
 #include "GameplayTagContainer.h"
 #include "NativeGameplayTags.h"
 #include "Subsystems/GameInstanceSubsystem.h"
+#include "Tasks/Task.h"
+#include "Templates/SharedPointer.h"
+#include "Tickable.h"
+#include "UObject/ObjectKey.h"
 #include "UObject/WeakObjectPtr.h"
 
 #include "GameplayMessageSubsystem.generated.h"
 
+class FGameplayMessageRouter;
+class FOutputDevice;
 class UGameplayMessageSubsystem;
 struct FFrame;
 
@@ -20,7 +29,9 @@ namespace UE::GameplayMessageSubsystem
 	GAMEPLAYMESSAGERUNTIME_API UE_DECLARE_GAMEPLAY_TAG_EXTERN(TAG_DefaultMessageChannel);
 }
 
+class FGameplayMessageReplay;
 class UAsyncAction_ListenForGameplayMessage;
+template <typename FMessageStructType> class TGameplayMessageChannel;
 
 /**
  * An opaque handle that can be used to remove a previously registered message listener
@@ -36,49 +47,438 @@ public:
 
 	void Unregister();
 
-	bool IsValid() const { return ID != 0; }
+	bool IsValid() const { return Generation != 0; }
 
 private:
-	UPROPERTY(Transient)
-	TWeakObjectPtr<UGameplayMessageSubsystem> Subsystem;
+	// Router the listener is registered on, the game instance router or one of its scope routers
+	TWeakPtr<FGameplayMessageRouter> Router;
 
 	UPROPERTY(Transient)
 	const UScriptStruct* StructType;
 
+	// Slot of the listener in the subsystem's listener table
+	UPROPERTY(Transient)
+	int32 SlotIndex = INDEX_NONE;
+
+	// Generation of the slot when this listener was registered, a mismatch means the handle is stale
 	UPROPERTY(Transient)
-	int32 ID = 0;
+	int32 Generation = 0;
 
 	FDelegateHandle StateClearedHandle;
 
-	friend UGameplayMessageSubsystem;
+	friend FGameplayMessageRouter;
 
-	FGameplayMessageListenerHandle(UGameplayMessageSubsystem* InSubsystem, const UScriptStruct* InStructType, int32 InID) : Subsystem(InSubsystem), StructType(InStructType), ID(InID) {}
+	FGameplayMessageListenerHandle(const TSharedRef<FGameplayMessageRouter>& InRouter, const UScriptStruct* InStructType, int32 InSlotIndex, int32 InGeneration) : Router(InRouter), StructType(InStructType), SlotIndex(InSlotIndex), Generation(InGeneration) {}
+};
+
+/**
+ * Key of a scoped router, named by a gameplay tag, an object, or both
+ * @see UGameplayMessageSubsystem::GetScopeRouter
+ */
+struct FGameplayMessageRouterScope
+{
+	FGameplayMessageRouterScope() {}
+	FGameplayMessageRouterScope(FGameplayTag InTag) : Tag(InTag) {}
+	FGameplayMessageRouterScope(const UObject* InObject) : Object(InObject) {}
+	FGameplayMessageRouterScope(FGameplayTag InTag, const UObject* InObject) : Tag(InTag), Object(InObject) {}
+
+	FGameplayTag Tag;
+
+	// Kept as a key so the scope can still be found, and pruned, once the object is gone
+	FObjectKey Object;
+
+	bool HasObject() const { return Object != FObjectKey(); }
+
+	bool operator==(const FGameplayMessageRouterScope& Other) const { return Tag == Other.Tag && Object == Other.Object; }
+	bool operator!=(const FGameplayMessageRouterScope& Other) const { return !(*this == Other); }
+
+	friend uint32 GetTypeHash(const FGameplayMessageRouterScope& Scope)
+	{
+		return HashCombine(GetTypeHash(Scope.Tag), GetTypeHash(Scope.Object));
+	}
 };
 
 /** 
- * Entry information for a single registered listener
+ * Entry information for a single registered listener.
+ * Pointer sized fields come first and the small ones are packed at the end, so the record has no inner padding.
  */
 USTRUCT()
 struct FGameplayMessageListenerData
 {
 	GENERATED_BODY()
 
-	// Callback for when a message has been received
-	TFunction<void(FGameplayTag, const UScriptStruct*, void*)> ReceivedCallback;
-
-	int32 HandleID;
-	EGameplayMessageMatch MatchType;
+	// Callback for when a message has been received, small callables are stored inline
+	FGameplayMessageCallback ReceivedCallback;
 
 	// Adding some logging and extra variables around some potential problems with this
 	TWeakObjectPtr<const UScriptStruct> ListenerStructType = nullptr;
 
+	// Listen Object
+	TWeakObjectPtr<UObject> TargetObject = nullptr;
+
 	// 注册时的Channel
 	FGameplayTag Channel = FGameplayTag::EmptyTag;
 
-	int32 Priority;
+	// EGameplayMessagePriority value, registration clamps custom priorities to this range
+	uint8 Priority = static_cast<uint8>(EGameplayMessagePriority::DEFAULT);
 
-	// Listen Object
-	TWeakObjectPtr<UObject> TargetObject = nullptr;
+	EGameplayMessageMatch MatchType = EGameplayMessageMatch::ExactMatch;
+
+	EGameplayMessageListenerFlags Flags = EGameplayMessageListenerFlags::None;
+};
+
+/**
+ * Listener storage and dispatch of a message router: the game instance router routes through one, and so does each
+ * of its scope routers. The state of the running broadcast (cancel and interrupt flags, continuations, thread-safe
+ * listener calls), the message queues, the inbox and the rate limits belong to the owning UGameplayMessageSubsystem
+ * and are shared by all of its routers, so a listener cancels whichever broadcast is calling it.
+ *
+ * Messages are only queued, and posted from other threads, through the subsystem.
+ * Game thread only, like the subsystem itself.
+ */
+class GAMEPLAYMESSAGERUNTIME_API FGameplayMessageRouter : public TSharedFromThis<FGameplayMessageRouter>
+{
+	friend UGameplayMessageSubsystem;
+
+	template <typename FMessageStructType>
+	friend class TGameplayMessageChannel;
+
+public:
+	explicit FGameplayMessageRouter(UGameplayMessageSubsystem& InOwner);
+	~FGameplayMessageRouter();
+
+	UE_NONCOPYABLE(FGameplayMessageRouter);
+
+	/** @see UGameplayMessageSubsystem::BroadcastMessage */
+	template <typename FMessageStructType>
+	FGameplayMessageBroadcastResult BroadcastMessage(FMessageStructType& Message, FGameplayTag Channel, TWeakObjectPtr<UObject> TargetObject = nullptr)
+	{
+		const UScriptStruct* StructType = TBaseStructure<FMessageStructType>::Get();
+		return BroadcastMessageInternal(Channel, StructType, &Message, TargetObject);
+	}
+
+	/** @see UGameplayMessageSubsystem::BroadcastMessageAsync */
+	template <typename FMessageStructType>
+	UE::Tasks::TTask<FGameplayMessageBroadcastResult> BroadcastMessageAsync(FMessageStructType& Message, FGameplayTag Channel, TWeakObjectPtr<UObject> TargetObject = nullptr)
+	{
+		const UScriptStruct* StructType = TBaseStructure<FMessageStructType>::Get();
+		return BroadcastMessageAsyncInternal(Channel, StructType, &Message, TargetObject);
+	}
+
+	/** @see UGameplayMessageSubsystem::BroadcastSimpleMessage */
+	template <typename FMessageStructType>
+	FGameplayMessageBroadcastResult BroadcastSimpleMessage(FMessageStructType& Message, TWeakObjectPtr<UObject> TargetObject = nullptr)
+	{
+		const UScriptStruct* StructType = TBaseStructure<FMessageStructType>::Get();
+		return BroadcastMessageInternal(UE::GameplayMessageSubsystem::TAG_DefaultMessageChannel, StructType, &Message, TargetObject);
+	}
+
+	/** @see UGameplayMessageSubsystem::AddBroadcastContinuation */
+	bool AddBroadcastContinuation(UE::Tasks::TTask<FGameplayMessageBroadcastResult> Continuation);
+	bool AddBroadcastContinuation(UE::Tasks::FTask Continuation);
+
+	/** @see UGameplayMessageSubsystem::RegisterListener */
+	template <typename FMessageStructType, typename FuncType, typename = typename TEnableIf<TIsInvocable<typename TDecay<FuncType>::Type&, FGameplayTag, const FMessageStructType&>::Value>::Type>
+	FGameplayMessageListenerHandle RegisterListener(FuncType&& Callback, EGameplayMessagePriority Priority = EGameplayMessagePriority::DEFAULT, TWeakObjectPtr<UObject> TargetObject = nullptr)
+	{
+		const UScriptStruct* StructType = TBaseStructure<FMessageStructType>::Get();
+		return RegisterListenerInternal(UE::GameplayMessageSubsystem::TAG_DefaultMessageChannel, UE::GameplayMessage::Private::MakeTypedMessageCallback<FMessageStructType>(Forward<FuncType>(Callback)), StructType, EGameplayMessageMatch::PartialMatch, static_cast<int32>(Priority), TargetObject);
+	}
+
+	template <typename FMessageStructType, typename FuncType, typename = typename TEnableIf<TIsInvocable<typename TDecay<FuncType>::Type&, FGameplayTag, const FMessageStructType&>::Value>::Type>
+	FGameplayMessageListenerHandle RegisterListener(FGameplayTag Channel, FuncType&& Callback, EGameplayMessageMatch MatchType = EGameplayMessageMatch::ExactMatch, EGameplayMessagePriority Priority = EGameplayMessagePriority::DEFAULT, TWeakObjectPtr<UObject> TargetObject = nullptr, EGameplayMessageListenerFlags Flags = EGameplayMessageListenerFlags::None)
+	{
+		const UScriptStruct* StructType = TBaseStructure<FMessageStructType>::Get();
+		return RegisterListenerInternal(Channel, UE::GameplayMessage::Private::MakeTypedMessageCallback<FMessageStructType>(Forward<FuncType>(Callback)), StructType, MatchType, static_cast<int32>(Priority), TargetObject, Flags);
+	}
+
+	template <typename FMessageStructType, typename TOwner = UObject>
+	FGameplayMessageListenerHandle RegisterListener(FGameplayTag Channel, TOwner* Object, void(TOwner::* Function)(FGameplayTag, const FMessageStructType&))
+	{
+		const UScriptStruct* StructType = TBaseStructure<FMessageStructType>::Get();
+		return RegisterListenerInternal(Channel, UE::GameplayMessage::Private::MakeWeakMemberMessageCallback<FMessageStructType>(Object, Function), StructType, EGameplayMessageMatch::ExactMatch);
+	}
+
+	template <typename FMessageStructType>
+	FGameplayMessageListenerHandle RegisterListener(FGameplayTag Channel, FGameplayMessageListenerParams<FMessageStructType>& Params)
+	{
+		FGameplayMessageListenerHandle Handle;
+
+		// Register to receive any future messages broadcast on this channel
+		if (Params.HasMessageReceivedCallback())
+		{
+			const UScriptStruct* StructType = TBaseStructure<FMessageStructType>::Get();
+			Handle = RegisterListenerInternal(Channel, Params.TakeMessageReceivedCallback(), StructType, Params.MatchType, static_cast<int32>(Params.Priority), Params.TargetObject, Params.Flags);
+		}
+
+		return Handle;
+	}
+
+	/** @see UGameplayMessageSubsystem::UnregisterListener */
+	void UnregisterListener(FGameplayMessageListenerHandle Handle);
+
+	/** @see UGameplayMessageSubsystem::RegisterListeners */
+	template <typename FMessageStructType>
+	TArray<FGameplayMessageListenerHandle> RegisterListeners(FGameplayTag Channel, TArrayView<FGameplayMessageListenerParams<FMessageStructType>> Params)
+	{
+		TArray<FGameplayMessageListenerHandle> Handles;
+		Handles.Reserve(Params.Num());
+
+		const UScriptStruct* StructType = TBaseStructure<FMessageStructType>::Get();
+		ReserveListeners(Params.Num());
+		BeginListenerBatch();
+		for (FGameplayMessageListenerParams<FMessageStructType>& ListenerParams : Params)
+		{
+			FGameplayMessageListenerHandle& Handle = Handles.AddDefaulted_GetRef();
+			if (ListenerParams.HasMessageReceivedCallback())
+			{
+				Handle = RegisterListenerInternal(Channel, ListenerParams.TakeMessageReceivedCallback(), StructType, ListenerParams.MatchType, static_cast<int32>(ListenerParams.Priority), ListenerParams.TargetObject, ListenerParams.Flags);
+			}
+		}
+		EndListenerBatch();
+
+		return Handles;
+	}
+
+	/** @see UGameplayMessageSubsystem::UnregisterListeners */
+	void UnregisterListeners(TConstArrayView<FGameplayMessageListenerHandle> Handles);
+
+	/** Allocate the storage of NumListeners more listeners ahead of a mass registration */
+	void ReserveListeners(int32 NumListeners);
+
+	/** Mark the running broadcast, whichever router it is running on, as cancelled. @see UGameplayMessageSubsystem::CancelMessage */
+	void CancelMessage(bool bCancel = true, bool bInterrupt = true);
+
+	/** @see UGameplayMessageSubsystem::GetScopeRouter */
+	FGameplayMessageRouter& GetScopeRouter(const FGameplayMessageRouterScope& Scope, bool bInForwardToParent = false);
+
+	/** @return the router of a scope, nullptr if it has not been created */
+	FGameplayMessageRouter* FindScopeRouter(const FGameplayMessageRouterScope& Scope) const;
+
+	/** @see UGameplayMessageSubsystem::DestroyScopeRouter */
+	void DestroyScopeRouter(const FGameplayMessageRouterScope& Scope);
+
+	/** @return the router this scope router belongs to, nullptr if this is not a scope router or its scope has been destroyed */
+	FGameplayMessageRouter* GetParentRouter() const { return Parent; }
+
+	bool IsScopeRouter() const { return bIsScopeRouter; }
+
+	/** @return the subsystem owning this router, along with the queues, inbox and rate limits it shares with the other routers */
+	UGameplayMessageSubsystem& GetOwner() const { return Owner; }
+
+	/** @see UGameplayMessageSubsystem::CompactListenerStorage */
+	void CompactListenerStorage();
+
+	/** Log the memory used by this router and its scope routers, per struct type and per channel */
+	void DumpMemory(FOutputDevice& Ar) const;
+
+private:
+	struct FChannelListenerBucket;
+
+	// Buckets gathered for an untargeted broadcast on a fixed channel through one router, owned by a TGameplayMessageChannel
+	struct FChannelRoutingCache
+	{
+		TWeakPtr<const FGameplayMessageRouter> Router;
+		uint32 Revision = 0;
+		TArray<const FChannelListenerBucket*, TInlineAllocator<8>> Buckets;
+
+		// Broadcasts iterating Buckets, which is only gathered again once none is
+		int32 NumBroadcasts = 0;
+	};
+
+	// Internal helper for broadcasting a message. Typed channels pass their routing cache, scope routers forwarding a
+	// message to their parent set bForwarded since it has already been counted against the rate limits.
+	FGameplayMessageBroadcastResult BroadcastMessageInternal(FGameplayTag Channel, const UScriptStruct* StructType, void* MessageBytes, TWeakObjectPtr<UObject> TargetObject = nullptr, FChannelRoutingCache* RoutingCache = nullptr, bool bForwarded = false);
+
+	// Internal helper for broadcasting a message that waits for the continuations of its listeners
+	UE::Tasks::TTask<FGameplayMessageBroadcastResult> BroadcastMessageAsyncInternal(FGameplayTag Channel, const UScriptStruct* StructType, void* MessageBytes, TWeakObjectPtr<UObject> TargetObject);
+
+	// Internal helper for registering a message listener
+	FGameplayMessageListenerHandle RegisterListenerInternal(
+		FGameplayTag Channel, 
+		FGameplayMessageCallback&& Callback,
+		const UScriptStruct* StructType,
+		EGameplayMessageMatch MatchType,
+		int32 Priority = static_cast<int32>(EGameplayMessagePriority::DEFAULT),
+		TWeakObjectPtr<UObject> TargetObject = nullptr,
+		EGameplayMessageListenerFlags Flags = EGameplayMessageListenerFlags::None);
+	
+	void UnregisterListenerInternal(int32 SlotIndex, int32 Generation);
+
+	// Subsystem sharing its broadcast context, queues and rate limits with this router
+	UGameplayMessageSubsystem& Owner;
+
+	// A registered listener. Slots are recycled, the generation tells a live listener apart from stale references to the slot.
+	struct FListenerSlot
+	{
+		FGameplayMessageListenerData Listener;
+
+		// Key of the struct list the listener is indexed under, kept raw since ListenerStructType may go stale
+		const UScriptStruct* StructType = nullptr;
+
+		// Key of the target object index the listener lives in, null for untargeted listeners
+		FObjectKey TargetKey;
+
+		// Sequence number of the registration, breaks priority ties in registration order
+		int32 Sequence = 0;
+
+		// Bumped every time the slot is released, never 0 for a slot in use
+		int32 Generation = 1;
+
+		bool bInUse = false;
+
+		// False while the registration is still pending, such a slot has no bucket entry to account for
+		bool bIndexed = false;
+	};
+
+	// Sparse table of listener slots. Slots live in fixed size pages so their address never changes,
+	// which lets new listeners be allocated while a broadcast is running callbacks from other slots.
+	struct FListenerSlotTable
+	{
+		static constexpr int32 SlotsPerPage = 256;
+
+		TArray<TUniquePtr<FListenerSlot[]>> Pages;
+		TArray<int32> FreeSlots;
+		int32 NumSlots = 0;
+
+		bool IsValidIndex(int32 Index) const { return Index >= 0 && Index < NumSlots; }
+		FListenerSlot& operator[](int32 Index) { return Pages[Index / SlotsPerPage][Index % SlotsPerPage]; }
+		const FListenerSlot& operator[](int32 Index) const { return Pages[Index / SlotsPerPage][Index % SlotsPerPage]; }
+
+		int32 Allocate();
+		void Free(int32 Index);
+
+		// Make sure NumToAllocate more slots can be allocated without adding pages
+		void Reserve(int32 NumToAllocate);
+		void Reset();
+
+		SIZE_T GetAllocatedSize() const;
+	};
+
+	// Reference to a listener slot from the dispatch order. Priority and sequence are copied in so buckets can be
+	// merged without touching the slot table.
+	struct FChannelListenerEntry
+	{
+		int32 SlotIndex = INDEX_NONE;
+		int32 Generation = 0;
+		int32 Priority = 0;
+		int32 Sequence = 0;
+
+		bool operator<(const FChannelListenerEntry& Other) const
+		{
+			return Priority < Other.Priority || (Priority == Other.Priority && Sequence < Other.Sequence);
+		}
+	};
+
+	// Listeners registered on the same channel with the same match rule, in dispatch order.
+	// Unregistering leaves a stale entry behind (detected through the generation) that is compacted away later.
+	struct FChannelListenerBucket
+	{
+		TArray<FChannelListenerEntry> Entries;
+		int32 NumStale = 0;
+	};
+
+	// Listener buckets indexed by the channel they registered on
+	struct FChannelListenerIndex
+	{
+		// Exact match listeners, only visited when the broadcast channel is the bucket tag
+		TMap<FGameplayTag, FChannelListenerBucket> ExactListeners;
+
+		// Partial match listeners, visited for the broadcast channel and each of its parents
+		TMap<FGameplayTag, FChannelListenerBucket> PartialListeners;
+
+		TMap<FGameplayTag, FChannelListenerBucket>& GetBuckets(EGameplayMessageMatch MatchType)
+		{
+			return MatchType == EGameplayMessageMatch::ExactMatch ? ExactListeners : PartialListeners;
+		}
+
+		bool IsEmpty() const { return ExactListeners.Num() == 0 && PartialListeners.Num() == 0; }
+	};
+
+	// List of all entries for a given struct type. Object-scoped listeners are split out per target object,
+	// so a targeted broadcast only visits that object's listeners and the untargeted ones.
+	struct FChannelListenerList
+	{
+		FChannelListenerIndex UntargetedListeners;
+		TMap<FObjectKey, FChannelListenerIndex> TargetedListeners;
+
+		int32 NumListeners = 0;
+	};
+
+	// Bumped whenever a bucket or struct list is added or removed, which is what invalidates routing caches.
+	// Adding a listener to an existing bucket does not, buckets are read live.
+	uint32 ListenerIndexRevision = 1;
+
+	// Collect every bucket that can match a broadcast on Channel for TargetObject, in no particular order
+	static void GatherMatchingBuckets(const FChannelListenerList& List, FGameplayTag Channel, const UObject* TargetObject, TArray<const FChannelListenerBucket*, TInlineAllocator<8>>& OutBuckets);
+
+	// Unregister the listeners whose target object has been garbage collected, and destroy the scopes of such objects
+	void PruneDeadTargetListeners();
+
+	// Insert a registered slot into its bucket, only valid while no broadcast is iterating the index.
+	// Appending skips the priority search, returns false if that left the bucket out of order.
+	bool AddListenerToIndex(int32 SlotIndex, bool bAppend = false);
+
+	// Registrations made between these are indexed together when the outermost batch ends
+	void BeginListenerBatch();
+	void EndListenerBatch();
+
+	// Number of batches open. While non-zero, registered slots wait in BatchedListeners as (slot index, generation).
+	int32 ListenerBatchDepth = 0;
+	TArray<TPair<int32, int32>> BatchedListeners;
+
+	// Destroy the listener of an unregistered slot and recycle it, only valid while no broadcast is iterating the index
+	void ReleaseListenerSlot(int32 SlotIndex);
+
+	// Apply the listener changes recorded while broadcasting, called when the outermost broadcast returns
+	void ApplyPendingListenerChanges();
+
+	// Number of broadcasts of this router currently on the stack. Buckets are iterated in place, so while this is non-zero
+	// bucket insertions and slot releases are recorded in PendingListenerChanges instead of being applied.
+	int32 BroadcastDepth = 0;
+
+	// Last registration sequence number handed out
+	int32 LastSequence = 0;
+
+	struct FPendingListenerChange
+	{
+		int32 SlotIndex = INDEX_NONE;
+
+		// Registration: the generation the slot had when registered, skipped if it was unregistered in the meantime
+		int32 Generation = 0;
+
+		bool bRegister = false;
+	};
+
+	// Changes made from inside listener callbacks, applied in order. Reset (not freed) after each flush.
+	TArray<FPendingListenerChange> PendingListenerChanges;
+
+	FListenerSlotTable ListenerSlots;
+
+	TMap<const UScriptStruct*, FChannelListenerList> ListenerMap;
+
+	// Struct types of ListenerMap a broadcast of the key type is delivered to: the type itself and its parents.
+	// Built on the first broadcast of a type, dropped whenever a struct type gains its first or loses its last listener.
+	TMap<FObjectKey, TArray<const UScriptStruct*, TInlineAllocator<4>>> CompatibleStructTypes;
+
+	// Listener struct types compatible with a broadcast of StructType, most derived first
+	TConstArrayView<const UScriptStruct*> GetCompatibleStructTypes(const UScriptStruct* StructType);
+
+	// Detach a scope router from this one and unregister its listeners if it is broadcasting, along with its own scope
+	// routers. Its storage goes away with the last reference, which a running broadcast of the scope holds.
+	static void DestroyScopeRouterInternal(FGameplayMessageRouter& ScopeRouter);
+
+	// Name used by DumpMemory, the owner's path followed by the scope keys
+	FString GetDebugName() const;
+
+	// Scope routers created by GetScopeRouter. Handles and routing caches only keep weak references to them.
+	TMap<FGameplayMessageRouterScope, TSharedPtr<FGameplayMessageRouter>> ScopeRouters;
+
+	// Set on scope routers only, the parent owns its scope routers and clears this when it destroys them
+	FGameplayMessageRouter* Parent = nullptr;
+	FGameplayMessageRouterScope ScopeKey;
+	bool bIsScopeRouter = false;
+	bool bForwardToParent = false;
 };
 
 /**
@@ -92,18 +492,31 @@ struct FGameplayMessageListenerData
  * or directly from anything that has a route to a world:
  *    UGameplayMessageSubsystem::Get(WorldContextObject)
  *
+ * Listeners registered for a struct type also receive the messages broadcast with any of its child struct types.
+ *
+ * Systems with many listeners on a shared channel can register them on a scope router instead, see GetScopeRouter,
+ * so a broadcast only visits the listeners of that scope.
+ *
  * Note that call order when there are multiple listeners for the same channel is
  * not guaranteed and can change over time!
  */
 UCLASS()
-class GAMEPLAYMESSAGERUNTIME_API UGameplayMessageSubsystem : public UGameInstanceSubsystem
+class GAMEPLAYMESSAGERUNTIME_API UGameplayMessageSubsystem : public UGameInstanceSubsystem, public FTickableGameObject
 {
 	GENERATED_BODY()
 
 	friend UAsyncAction_ListenForGameplayMessage;
+	friend FGameplayMessageReplay;
+	friend FGameplayMessageRouter;
+	friend class UGameplayMessageRelayComponent;
+
+	template <typename FMessageStructType>
+	friend class TGameplayMessageChannel;
 
 public:
 
+	UGameplayMessageSubsystem();
+
 	/**
 	 * @return the message router for the game instance associated with the world of the specified object
 	 */
@@ -115,9 +528,18 @@ public:
 	static bool HasInstance(const UObject* WorldContextObject);
 
 	//~USubsystem interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
 	virtual void Deinitialize() override;
 	//~End of USubsystem interface
 
+	//~FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override;
+	virtual bool IsTickableWhenPaused() const override { return true; }
+	virtual TStatId GetStatId() const override;
+	//~End of FTickableGameObject interface
+
 	/**
 	 * Broadcast a message on the specified channel
 	 *
@@ -131,6 +553,80 @@ public:
 		return BroadcastMessageInternal(Channel, StructType, &Message, TargetObject);
 	}
 
+	/**
+	 * Broadcast a message whose listeners may finish reacting to it later, e.g. after an asset load or a save game write.
+	 * Listeners are called right away as with BroadcastMessage and hand their pending work over with AddBroadcastContinuation.
+	 *
+	 * The returned task completes once every continuation has, with their cancel and interrupt flags merged into the
+	 * result of the dispatch. It completes on a worker thread when there are continuations, game thread code should poll
+	 * IsCompleted() or launch its follow up work with the task as a prerequisite rather than wait for it.
+	 *
+	 * @param Message			The message to send (must be the same type of UScriptStruct expected by the listeners for this channel, otherwise an error will be logged)
+	 * @param Channel			The message channel to broadcast on
+	 */
+	template <typename FMessageStructType>
+	UE::Tasks::TTask<FGameplayMessageBroadcastResult> BroadcastMessageAsync(FMessageStructType& Message, FGameplayTag Channel, TWeakObjectPtr<UObject> TargetObject = nullptr)
+	{
+		const UScriptStruct* StructType = TBaseStructure<FMessageStructType>::Get();
+		return BroadcastMessageAsyncInternal(Channel, StructType, &Message, TargetObject);
+	}
+
+	/**
+	 * Make the async broadcast calling the current listener wait for Continuation. The continuation's bCancelled and
+	 * bInterrupted are merged into the broadcast result, it cannot stop listeners of the broadcast anymore.
+	 *
+	 * @return false if the current broadcast is not an async one, the continuation then runs unobserved
+	 */
+	bool AddBroadcastContinuation(UE::Tasks::TTask<FGameplayMessageBroadcastResult> Continuation);
+	bool AddBroadcastContinuation(UE::Tasks::FTask Continuation);
+
+	/**
+	 * Queue a message to be broadcast on the specified channel during the next router tick.
+	 * The message is copied, so it does not need to outlive this call. Queued messages are dispatched together,
+	 * grouped by struct type and channel; the order between different groups is not preserved.
+	 * On channels listed in UGameplayMessageSettings::CoalescedChannels, messages queued for the same channel and
+	 * TargetObject within a frame are merged and only the last payload is dispatched.
+	 *
+	 * @param Message			The message to send (must be the same type of UScriptStruct expected by the listeners for this channel, otherwise an error will be logged)
+	 * @param Channel			The message channel to broadcast on
+	 * @param OnComplete		Optional callback receiving the broadcast result once the message has been dispatched
+	 */
+	template <typename FMessageStructType>
+	void QueueMessage(const FMessageStructType& Message, FGameplayTag Channel, TWeakObjectPtr<UObject> TargetObject = nullptr, FGameplayMessageQueuedCallback&& OnComplete = nullptr)
+	{
+		const UScriptStruct* StructType = TBaseStructure<FMessageStructType>::Get();
+		QueueMessageInternal(Channel, StructType, &Message, TargetObject, MoveTemp(OnComplete));
+	}
+
+	/**
+	 * Dispatch every queued message right away instead of waiting for the next tick.
+	 * Messages queued by listeners while flushing are kept for the following flush.
+	 */
+	void FlushQueuedMessages();
+
+	/**
+	 * Post a message from any thread, to be broadcast on the game thread during the next router tick.
+	 * The message is copied on the calling thread and pushed onto a lock-free inbox; no lock is taken and no task is
+	 * created. Messages posted by one thread are broadcast in the order they were posted, there is no ordering
+	 * guarantee between threads nor relative to messages queued on the game thread with QueueMessage.
+	 * The router must outlive the call, which is the caller's responsibility when posting from worker threads.
+	 *
+	 * @param Message			The message to send, copied (must be safe to copy off the game thread)
+	 * @param Channel			The message channel to broadcast on
+	 */
+	template <typename FMessageStructType>
+	void BroadcastMessageFromAnyThread(const FMessageStructType& Message, FGameplayTag Channel, TWeakObjectPtr<UObject> TargetObject = nullptr)
+	{
+		const UScriptStruct* StructType = TBaseStructure<FMessageStructType>::Get();
+		Inbox.Enqueue(StructType, &Message, Channel, TargetObject, FVector::ZeroVector);
+	}
+
+	/** @return running counters of the message queue, including how many queued messages were coalesced */
+	const FGameplayMessageQueueStats& GetQueueStats() const { return QueueStats; }
+
+	/** @return the broadcast budgets of the rate limited channels, and how many broadcasts each one dropped */
+	const FGameplayMessageRateLimiter& GetRateLimiter() const { return RateLimiter; }
+
 	/**
 	 * Broadcast a message
 	 *
@@ -150,17 +646,12 @@ public:
 	 *
 	 * @return a handle that can be used to unregister this listener (either by calling Unregister() on the handle or calling UnregisterListener on the router)
 	 */
-	template <typename FMessageStructType>
-	FGameplayMessageListenerHandle RegisterListener(TFunction<void(FGameplayTag, const FMessageStructType&)>&& Callback, EGameplayMessagePriority Priority = EGameplayMessagePriority::DEFAULT, TWeakObjectPtr<UObject> TargetObject = nullptr)
+	template <typename FMessageStructType, typename FuncType, typename = typename TEnableIf<TIsInvocable<typename TDecay<FuncType>::Type&, FGameplayTag, const FMessageStructType&>::Value>::Type>
+	FGameplayMessageListenerHandle RegisterListener(FuncType&& Callback, EGameplayMessagePriority Priority = EGameplayMessagePriority::DEFAULT, TWeakObjectPtr<UObject> TargetObject = nullptr)
 	{
-		auto ThunkCallback = [InnerCallback = MoveTemp(Callback)](FGameplayTag ActualTag, const UScriptStruct* SenderStructType, const void* SenderPayload)
-		{
-			InnerCallback(ActualTag, *reinterpret_cast<const FMessageStructType*>(SenderPayload));
-		};
-
 		const UScriptStruct* StructType = TBaseStructure<FMessageStructType>::Get();
 		
-		return RegisterListenerInternal(UE::GameplayMessageSubsystem::TAG_DefaultMessageChannel, ThunkCallback, StructType, EGameplayMessageMatch::PartialMatch, static_cast<int32>(Priority), TargetObject);
+		return RegisterListenerInternal(UE::GameplayMessageSubsystem::TAG_DefaultMessageChannel, UE::GameplayMessage::Private::MakeTypedMessageCallback<FMessageStructType>(Forward<FuncType>(Callback)), StructType, EGameplayMessageMatch::PartialMatch, static_cast<int32>(Priority), TargetObject);
 	}
 
 	/**
@@ -168,20 +659,16 @@ public:
 	 *
 	 * @param Channel			The message channel to listen to
 	 * @param Callback			Function to call with the message when someone broadcasts it (must be the same type of UScriptStruct provided by broadcasters for this channel, otherwise an error will be logged)
+	 * @param Flags				Behavior flags, EGameplayMessageListenerFlags::ThreadSafe lets the callback run on a worker thread
 	 *
 	 * @return a handle that can be used to unregister this listener (either by calling Unregister() on the handle or calling UnregisterListener on the router)
 	 */
-	template <typename FMessageStructType>
-	FGameplayMessageListenerHandle RegisterListener(FGameplayTag Channel, TFunction<void(FGameplayTag, const FMessageStructType&)>&& Callback, EGameplayMessageMatch MatchType = EGameplayMessageMatch::ExactMatch, EGameplayMessagePriority Priority = EGameplayMessagePriority::DEFAULT, TWeakObjectPtr<UObject> TargetObject = nullptr)
+	template <typename FMessageStructType, typename FuncType, typename = typename TEnableIf<TIsInvocable<typename TDecay<FuncType>::Type&, FGameplayTag, const FMessageStructType&>::Value>::Type>
+	FGameplayMessageListenerHandle RegisterListener(FGameplayTag Channel, FuncType&& Callback, EGameplayMessageMatch MatchType = EGameplayMessageMatch::ExactMatch, EGameplayMessagePriority Priority = EGameplayMessagePriority::DEFAULT, TWeakObjectPtr<UObject> TargetObject = nullptr, EGameplayMessageListenerFlags Flags = EGameplayMessageListenerFlags::None)
 	{
-		auto ThunkCallback = [InnerCallback = MoveTemp(Callback)](FGameplayTag ActualTag, const UScriptStruct* SenderStructType, void* SenderPayload)
-		{
-			InnerCallback(ActualTag, *reinterpret_cast<const FMessageStructType*>(SenderPayload));
-		};
-
 		const UScriptStruct* StructType = TBaseStructure<FMessageStructType>::Get();
 		
-		return RegisterListenerInternal(Channel, ThunkCallback, StructType, MatchType, static_cast<int32>(Priority), TargetObject);
+		return RegisterListenerInternal(Channel, UE::GameplayMessage::Private::MakeTypedMessageCallback<FMessageStructType>(Forward<FuncType>(Callback)), StructType, MatchType, static_cast<int32>(Priority), TargetObject, Flags);
 	}
 
 	/**
@@ -197,15 +684,9 @@ public:
 	template <typename FMessageStructType, typename TOwner = UObject>
 	FGameplayMessageListenerHandle RegisterListener(FGameplayTag Channel, TOwner* Object, void(TOwner::* Function)(FGameplayTag, const FMessageStructType&))
 	{
-		TWeakObjectPtr<TOwner> WeakObject(Object);
-		return RegisterListener<FMessageStructType>(Channel,
-													[WeakObject, Function](FGameplayTag Channel, FMessageStructType& Payload)
-													{
-														if (TOwner* StrongObject = WeakObject.Get())
-														{
-															(StrongObject->*Function)(Channel, Payload);
-														}
-													});
+		const UScriptStruct* StructType = TBaseStructure<FMessageStructType>::Get();
+
+		return RegisterListenerInternal(Channel, UE::GameplayMessage::Private::MakeWeakMemberMessageCallback<FMessageStructType>(Object, Function), StructType, EGameplayMessageMatch::ExactMatch);
 	}
 
 	/**
@@ -213,7 +694,7 @@ public:
 	 * The stateful part of this logic should probably be separated out to a separate system
 	 *
 	 * @param Channel			The message channel to listen to
-	 * @param Params			Structure containing details for advanced behavior
+	 * @param Params			Structure containing details for advanced behavior, the callback is moved out of it
 	 *
 	 * @return a handle that can be used to unregister this listener (either by calling Unregister() on the handle or calling UnregisterListener on the router)
 	 */
@@ -223,15 +704,10 @@ public:
 		FGameplayMessageListenerHandle Handle;
 
 		// Register to receive any future messages broadcast on this channel
-		if (Params.OnMessageReceivedCallback)
+		if (Params.HasMessageReceivedCallback())
 		{
-			auto ThunkCallback = [InnerCallback = Params.OnMessageReceivedCallback](FGameplayTag ActualTag, const UScriptStruct* SenderStructType, void* SenderPayload)
-			{
-				InnerCallback(ActualTag, *reinterpret_cast<const FMessageStructType*>(SenderPayload));
-			};
-
 			const UScriptStruct* StructType = TBaseStructure<FMessageStructType>::Get();
-			Handle = RegisterListenerInternal(Channel, ThunkCallback, StructType, Params.MatchType, static_cast<int32>(Params.Priority), Params.TargetObject);
+			Handle = RegisterListenerInternal(Channel, Params.TakeMessageReceivedCallback(), StructType, Params.MatchType, static_cast<int32>(Params.Priority), Params.TargetObject, Params.Flags);
 		}
 
 		return Handle;
@@ -244,6 +720,48 @@ public:
 	 */
 	void UnregisterListener(FGameplayMessageListenerHandle Handle);
 
+	/**
+	 * Register many listeners on one channel at once, e.g. for the actors of a streamed in level.
+	 * The listeners are appended to their buckets and every bucket left out of order is sorted once at the end,
+	 * instead of inserting each listener at its priority.
+	 *
+	 * @param Channel			The message channel to listen to
+	 * @param Params			Details of each listener, the callbacks are moved out of it
+	 *
+	 * @return a handle per entry of Params, in the same order. Entries without a callback get an invalid handle.
+	 */
+	template <typename FMessageStructType>
+	TArray<FGameplayMessageListenerHandle> RegisterListeners(FGameplayTag Channel, TArrayView<FGameplayMessageListenerParams<FMessageStructType>> Params)
+	{
+		TArray<FGameplayMessageListenerHandle> Handles;
+		Handles.Reserve(Params.Num());
+
+		const UScriptStruct* StructType = TBaseStructure<FMessageStructType>::Get();
+		ReserveListeners(Params.Num());
+		BeginListenerBatch();
+		for (FGameplayMessageListenerParams<FMessageStructType>& ListenerParams : Params)
+		{
+			FGameplayMessageListenerHandle& Handle = Handles.AddDefaulted_GetRef();
+			if (ListenerParams.HasMessageReceivedCallback())
+			{
+				Handle = RegisterListenerInternal(Channel, ListenerParams.TakeMessageReceivedCallback(), StructType, ListenerParams.MatchType, static_cast<int32>(ListenerParams.Priority), ListenerParams.TargetObject, ListenerParams.Flags);
+			}
+		}
+		EndListenerBatch();
+
+		return Handles;
+	}
+
+	/**
+	 * Remove many listeners at once, e.g. on level unload. Invalid and stale handles are skipped.
+	 *
+	 * @param Handles	Handles returned by RegisterListener or RegisterListeners
+	 */
+	void UnregisterListeners(TConstArrayView<FGameplayMessageListenerHandle> Handles);
+
+	/** Allocate the storage of NumListeners more listeners ahead of a mass registration */
+	void ReserveListeners(int32 NumListeners);
+
 	/**
 	 * Mark current message context as cancelled
 	 * @param WorldContext Context to get GameplayMessageSubsystem
@@ -261,6 +779,40 @@ public:
 	UFUNCTION(BlueprintCallable, Category=Messaging)
 	void CancelMessage(bool bCancel = true, bool bInterrupt = true);
 
+	/**
+	 * Get the router of a scope, created on first use. It has the same listener and broadcast API as this router but
+	 * only dispatches to the listeners registered on it, so a broadcast meant for one actor, team or match does not
+	 * visit the listeners of every other one. Scope routers are owned by this router, object scopes are destroyed
+	 * along with their listeners once the object has been garbage collected. They share the broadcast context of this
+	 * subsystem, CancelMessage and CancelCurrentMessage reach a broadcast running on a scope router too.
+	 *
+	 * @param Scope					Tag and/or object naming the scope
+	 * @param bInForwardToParent	If true, messages broadcast on the scope router are then broadcast on this router too,
+	 *								unless a scope listener interrupted them. Only used when the scope router is created.
+	 */
+	FGameplayMessageRouter& GetScopeRouter(const FGameplayMessageRouterScope& Scope, bool bInForwardToParent = false) { return Router->GetScopeRouter(Scope, bInForwardToParent); }
+
+	/** @return the router of a scope, nullptr if it has not been created */
+	FGameplayMessageRouter* FindScopeRouter(const FGameplayMessageRouterScope& Scope) const { return Router->FindScopeRouter(Scope); }
+
+	/**
+	 * Unregister every listener of a scope in one call and destroy its router, along with its own scope routers.
+	 * Handles of its listeners are left stale and unregistering them does nothing.
+	 */
+	void DestroyScopeRouter(const FGameplayMessageRouterScope& Scope) { Router->DestroyScopeRouter(Scope); }
+
+	/** @return the listener storage and dispatch of this subsystem, the root of its scope routers */
+	FGameplayMessageRouter& GetRouter() const { return *Router; }
+
+	/**
+	 * Release the memory left behind by listeners that are gone: sparse listener maps are compacted and bucket slack
+	 * is freed. Done after every garbage collection, does nothing while a broadcast is running.
+	 */
+	void CompactListenerStorage();
+
+	/** Log the memory used by this router and its scope routers, per struct type and per channel. @see GameplayMessages.DumpMemory */
+	void DumpMemory(FOutputDevice& Ar) const { Router->DumpMemory(Ar); }
+
 protected:
 	/**
 	 * Broadcast a message on the specified channel
@@ -301,31 +853,86 @@ protected:
 	DECLARE_FUNCTION(execK2_BroadcastSimpleObjectMessage);
 
 private:
-	// Internal helper for broadcasting a message
-	FGameplayMessageBroadcastResult BroadcastMessageInternal(FGameplayTag Channel, const UScriptStruct* StructType, void* MessageBytes, TWeakObjectPtr<UObject> TargetObject = nullptr);
+	// Internal helper for broadcasting a message. Typed channels pass their routing cache.
+	FGameplayMessageBroadcastResult BroadcastMessageInternal(FGameplayTag Channel, const UScriptStruct* StructType, void* MessageBytes, TWeakObjectPtr<UObject> TargetObject = nullptr, FGameplayMessageRouter::FChannelRoutingCache* RoutingCache = nullptr)
+	{
+		return Router->BroadcastMessageInternal(Channel, StructType, MessageBytes, TargetObject, RoutingCache);
+	}
+
+	// Internal helper for broadcasting a message that waits for the continuations of its listeners
+	UE::Tasks::TTask<FGameplayMessageBroadcastResult> BroadcastMessageAsyncInternal(FGameplayTag Channel, const UScriptStruct* StructType, void* MessageBytes, TWeakObjectPtr<UObject> TargetObject)
+	{
+		return Router->BroadcastMessageAsyncInternal(Channel, StructType, MessageBytes, TargetObject);
+	}
+
+	// Internal helper for queueing a message for the next flush
+	void QueueMessageInternal(FGameplayTag Channel, const UScriptStruct* StructType, const void* MessageBytes, TWeakObjectPtr<UObject> TargetObject, FGameplayMessageQueuedCallback&& OnComplete);
 
 	// Internal helper for registering a message listener
 	FGameplayMessageListenerHandle RegisterListenerInternal(
 		FGameplayTag Channel, 
-		TFunction<void(FGameplayTag, const UScriptStruct*, void*)>&& Callback,
+		FGameplayMessageCallback&& Callback,
 		const UScriptStruct* StructType,
 		EGameplayMessageMatch MatchType,
 		int32 Priority = static_cast<int32>(EGameplayMessagePriority::DEFAULT),
-		TWeakObjectPtr<UObject> TargetObject = nullptr);
-	
-	void UnregisterListenerInternal(const UScriptStruct* StructType, int32 HandleID);
+		TWeakObjectPtr<UObject> TargetObject = nullptr,
+		EGameplayMessageListenerFlags Flags = EGameplayMessageListenerFlags::None)
+	{
+		return Router->RegisterListenerInternal(Channel, MoveTemp(Callback), StructType, MatchType, Priority, TargetObject, Flags);
+	}
+
+	// Run the thread-safe listener calls recorded from FirstCall onward, then drop them
+	void DispatchParallelListenerCalls(int32 FirstCall);
+
+	// Unregister the listeners whose target object has been garbage collected, on this router and its scopes
+	void PruneDeadTargetListeners();
 
-	// Message execute context, reset for each message broadcast
+	// Listener storage of this subsystem, which owns the scope routers. Replaced on Deinitialize so outstanding handles go stale.
+	TSharedPtr<FGameplayMessageRouter> Router;
+
+	// Message execute context of the running broadcast, on any of the routers. Each broadcast starts from a clean one and
+	// restores the enclosing broadcast's context when it returns, so nested broadcasts from listeners do not cancel or
+	// interrupt their caller.
 	FGameplayMessageBroadcastResult BroadcastResultCache;
 
-private:
-	// List of all entries for a given channel
-	struct FChannelListenerList
+	// Continuations collected for the running broadcast, nullptr unless it is an async one
+	TArray<UE::Tasks::TTask<FGameplayMessageBroadcastResult>>* BroadcastContinuations = nullptr;
+
+	// Continuation list of the next broadcast, taken (and cleared) as soon as that broadcast starts
+	TArray<UE::Tasks::TTask<FGameplayMessageBroadcastResult>>* NextBroadcastContinuations = nullptr;
+
+	// Double buffered so messages queued by listeners during a flush wait for the next one
+	FGameplayMessageQueue MessageQueues[2];
+	int32 ActiveQueueIndex = 0;
+	bool bFlushingQueue = false;
+
+	FGameplayMessageQueueStats QueueStats;
+
+	// Budgets of the channels listed in UGameplayMessageSettings::RateLimits, shared by the scope routers
+	FGameplayMessageRateLimiter RateLimiter;
+
+	// Messages posted with BroadcastMessageFromAnyThread, drained at the start of each tick
+	FGameplayMessageInbox Inbox;
+
+	// A thread-safe listener matched by a broadcast, run once the ordered listeners are done
+	struct FParallelListenerCall
 	{
-		TArray<FGameplayMessageListenerData> Listeners;
-		int32 HandleID = 0;
+		// Router the listener slot belongs to, kept alive by the broadcast that recorded the call
+		FGameplayMessageRouter* Router = nullptr;
+		int32 SlotIndex = INDEX_NONE;
+		int32 Generation = 0;
+		FGameplayTag Channel;
+		const UScriptStruct* StructType = nullptr;
+		void* MessageBytes = nullptr;
 	};
 
-private:
-	TMap<const UScriptStruct*, FChannelListenerList> ListenerMap;
+	// Stack of pending thread-safe calls, every broadcast only dispatches (and pops) the calls it pushed.
+	// While flushing the queue the calls of the whole batch are dispatched together, payloads outlive the batch there.
+	TArray<FParallelListenerCall> ParallelListenerCalls;
+
+	// Set by the flush for the next broadcast only, tells it to leave its thread-safe calls for the batch
+	bool bBatchParallelListenerCalls = false;
+
+	// True while thread-safe listeners run, listener changes and cancellation are rejected
+	bool bDispatchingParallelListeners = false;
 };
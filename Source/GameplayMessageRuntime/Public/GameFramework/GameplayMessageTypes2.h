@@ -2,12 +2,14 @@
 
 #pragma once
 
+#include "GameFramework/GameplayMessageCallback.h"
 #include "GameplayTagContainer.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
 
 #include "GameplayMessageTypes2.generated.h"
 
 class UGameplayMessageRouter;
+class USceneComponent;
 
 // Match rule for message listeners
 UENUM(BlueprintType)
@@ -22,6 +24,20 @@ enum class EGameplayMessageMatch : uint8
 	PartialMatch
 };
 
+// Optional behavior flags for message listeners
+UENUM(meta=(Bitflags, UseEnumValuesAsMaskValuesInEditor="true"))
+enum class EGameplayMessageListenerFlags : uint8
+{
+	None = 0,
+
+	// The callback only reads the payload and touches thread-safe state, so it can run on a task graph worker.
+	// Such listeners are dispatched after every ordered listener of the broadcast, in parallel and in no particular order.
+	// They are skipped if an ordered listener interrupted the broadcast, and they can neither cancel nor interrupt it,
+	// register or unregister listeners, nor broadcast or queue messages (post them with BroadcastMessageFromAnyThread instead).
+	ThreadSafe = 1 << 0,
+};
+ENUM_CLASS_FLAGS(EGameplayMessageListenerFlags);
+
 /**
  * Struct used to specify advanced behavior when registering a listener for gameplay messages
  */
@@ -33,23 +49,44 @@ struct FGameplayMessageListenerParams
 
 	/** If bound this callback will trigger when a message is broadcast on the specified channel. */
 	TFunction<void(FGameplayTag, const FMessageStructType&)> OnMessageReceivedCallback;
+
+	/** Set by SetMessageReceivedCallback, registered instead of OnMessageReceivedCallback when bound */
+	FGameplayMessageCallback ReceivedCallback;
 	
 	TWeakObjectPtr<UObject> TargetObject;
 
 	EGameplayMessagePriority Priority;
 
-	/** Helper to bind weak member function to OnMessageReceivedCallback */
+	/** Behavior flags, see EGameplayMessageListenerFlags::ThreadSafe */
+	EGameplayMessageListenerFlags Flags = EGameplayMessageListenerFlags::None;
+
+	/** Bind a callable taking the message, stored inline when small enough so the listener calls it with a single indirection */
+	template<typename FuncType>
+	void SetMessageReceivedCallback(FuncType&& Func)
+	{
+		ReceivedCallback = UE::GameplayMessage::Private::MakeTypedMessageCallback<FMessageStructType>(Forward<FuncType>(Func));
+	}
+
+	/** Helper to bind weak member function to the received callback */
 	template<typename TOwner = UObject>
 	void SetMessageReceivedCallback(TOwner* Object, void(TOwner::* Function)(FGameplayTag, const FMessageStructType&))
 	{
-		TWeakObjectPtr<TOwner> WeakObject(Object);
-		OnMessageReceivedCallback = [WeakObject, Function](FGameplayTag Channel, const FMessageStructType& Payload)
+		ReceivedCallback = UE::GameplayMessage::Private::MakeWeakMemberMessageCallback<FMessageStructType>(Object, Function);
+	}
+
+	bool HasMessageReceivedCallback() const
+	{
+		return ReceivedCallback || OnMessageReceivedCallback;
+	}
+
+	/** The callback a registration stores, moved out of these params */
+	FGameplayMessageCallback TakeMessageReceivedCallback()
+	{
+		if (ReceivedCallback)
 		{
-			if (TOwner* StrongObject = WeakObject.Get())
-			{
-				(StrongObject->*Function)(Channel, Payload);
-			}
-		};
+			return MoveTemp(ReceivedCallback);
+		}
+		return UE::GameplayMessage::Private::MakeTypedMessageCallback<FMessageStructType>(MoveTemp(OnMessageReceivedCallback));
 	}
 };
 
@@ -78,11 +115,15 @@ public:
 	// Message interrupted state, reset for each message broadcast. If true means the reset listener should be interrupted.
 	UPROPERTY(BlueprintReadOnly)
 	bool bInterrupted = false;
+	// True if the message went over its channel's rate limit and was dropped without reaching any listener.
+	UPROPERTY(BlueprintReadOnly)
+	bool bThrottled = false;
 
 	void Reset()
 	{
 		bCancelled = false;
 		bInterrupted = false;
+		bThrottled = false;
 	}
 	
 };
@@ -98,6 +139,9 @@ struct FGameplayWorldMessageListenerParams
 
 	/** If bound this callback will trigger when a message is broadcast on the specified channel. */
 	TFunction<void(FGameplayTag, const FMessageStructType&)> OnMessageReceivedCallback;
+
+	/** Set by SetMessageReceivedCallback, registered instead of OnMessageReceivedCallback when bound */
+	FGameplayMessageCallback ReceivedCallback;
 	
 	/** The center position for listening to spatial messages */
 	FVector ListenPosition = FVector::ZeroVector;
@@ -108,17 +152,45 @@ struct FGameplayWorldMessageListenerParams
 	/** Priority of the listener */
 	EGameplayMessagePriority Priority = EGameplayMessagePriority::DEFAULT;
 
-	/** Helper to bind weak member function to OnMessageReceivedCallback */
+	/**
+	 * Distance LOD: messages broadcast between InnerRadius and ListenRadius are the far tier, of which only one in
+	 * FarDeliveryInterval is delivered. A negative InnerRadius delivers every message within ListenRadius.
+	 */
+	float InnerRadius = -1.0f;
+	int32 FarDeliveryInterval = 1;
+
+	/** If set the listen position follows this component instead of staying at ListenPosition */
+	TWeakObjectPtr<const USceneComponent> FollowComponent;
+
+	/** Distance the followed component has to move before the listener is relocated */
+	float FollowMoveThreshold = 50.0f;
+
+	/** Bind a callable taking the message, stored inline when small enough so the listener calls it with a single indirection */
+	template<typename FuncType>
+	void SetMessageReceivedCallback(FuncType&& Func)
+	{
+		ReceivedCallback = UE::GameplayMessage::Private::MakeTypedMessageCallback<FMessageStructType>(Forward<FuncType>(Func));
+	}
+
+	/** Helper to bind weak member function to the received callback */
 	template<typename TOwner = UObject>
 	void SetMessageReceivedCallback(TOwner* Object, void(TOwner::* Function)(FGameplayTag, const FMessageStructType&))
 	{
-		TWeakObjectPtr<TOwner> WeakObject(Object);
-		OnMessageReceivedCallback = [WeakObject, Function](FGameplayTag Channel, const FMessageStructType& Payload)
+		ReceivedCallback = UE::GameplayMessage::Private::MakeWeakMemberMessageCallback<FMessageStructType>(Object, Function);
+	}
+
+	bool HasMessageReceivedCallback() const
+	{
+		return ReceivedCallback || OnMessageReceivedCallback;
+	}
+
+	/** The callback a registration stores, moved out of these params */
+	FGameplayMessageCallback TakeMessageReceivedCallback()
+	{
+		if (ReceivedCallback)
 		{
-			if (TOwner* StrongObject = WeakObject.Get())
-			{
-				(StrongObject->*Function)(Channel, Payload);
-			}
-		};
+			return MoveTemp(ReceivedCallback);
+		}
+		return UE::GameplayMessage::Private::MakeTypedMessageCallback<FMessageStructType>(MoveTemp(OnMessageReceivedCallback));
 	}
 };
\ No newline at end of file
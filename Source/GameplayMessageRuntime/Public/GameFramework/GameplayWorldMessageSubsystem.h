@@ -2,15 +2,23 @@
 
 #pragma once
 
+#include "GameFramework/GameplayMessageCallback.h"
+#include "GameFramework/GameplayMessageQueue.h"
+#include "GameFramework/GameplayMessageRateLimiter.h"
+#include "GameFramework/GameplayMessageSettings.h"
 #include "GameFramework/GameplayMessageTypes2.h"
 #include "GameplayTagContainer.h"
 #include "NativeGameplayTags.h"
 #include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
 #include "UObject/WeakObjectPtr.h"
 
 #include "GameplayWorldMessageSubsystem.generated.h"
 
+class AActor;
+class FOutputDevice;
 class UGameplayWorldMessageSubsystem;
+class USceneComponent;
 struct FFrame;
 
 GAMEPLAYMESSAGERUNTIME_API DECLARE_LOG_CATEGORY_EXTERN(LogGameplayWorldMessageSubsystem, Log, All);
@@ -19,15 +27,44 @@ namespace UE::GameplayWorldMessageSubsystem
 {
 	GAMEPLAYMESSAGERUNTIME_API UE_DECLARE_GAMEPLAY_TAG_EXTERN(TAG_DefaultMessageChannel);
 	
-	// Grid size constant - each grid cell is 16m x 16m
+	// Default grid cell size - each grid cell is 16m x 16m. Routers use the cell size of their world's grid settings.
 	constexpr float GRID_SIZE = 1600.0f; // 16m * 100 (UE units)
 	
 	// Helper functions for grid coordinate conversion
-	GAMEPLAYMESSAGERUNTIME_API int64 GetGridID(const FVector& WorldPosition);
-	GAMEPLAYMESSAGERUNTIME_API FVector GetGridCenter(int64 GridID);
-	GAMEPLAYMESSAGERUNTIME_API TArray<int64> GetGridsInRadius(const FVector& Center, float Radius);
+	GAMEPLAYMESSAGERUNTIME_API int64 GetGridID(const FVector& WorldPosition, float CellSize = GRID_SIZE);
+	GAMEPLAYMESSAGERUNTIME_API FVector GetGridCenter(int64 GridID, float CellSize = GRID_SIZE);
+	GAMEPLAYMESSAGERUNTIME_API TArray<int64> GetGridsInRadius(const FVector& Center, float Radius, float CellSize = GRID_SIZE);
+
+	// 3D variants, X/Y/Z cell coordinates are packed into 21 bits each
+	GAMEPLAYMESSAGERUNTIME_API int64 GetGridID3D(const FVector& WorldPosition, float CellSize, float CellHeight);
+	GAMEPLAYMESSAGERUNTIME_API FVector GetGridCenter3D(int64 GridID, float CellSize, float CellHeight);
+	GAMEPLAYMESSAGERUNTIME_API TArray<int64> GetGridsInSphere(const FVector& Center, float Radius, float CellSize, float CellHeight);
+
+	// Inclusive range of cells of one grid level covered by a listener, planar levels keep Z at 0
+	struct FGridCellRect
+	{
+		int32 MinX = 0;
+		int32 MinY = 0;
+		int32 MinZ = 0;
+		int32 MaxX = -1;
+		int32 MaxY = -1;
+		int32 MaxZ = -1;
+
+		bool Contains(int32 X, int32 Y, int32 Z) const
+		{
+			return X >= MinX && X <= MaxX && Y >= MinY && Y <= MaxY && Z >= MinZ && Z <= MaxZ;
+		}
+
+		bool operator==(const FGridCellRect& Other) const
+		{
+			return MinX == Other.MinX && MinY == Other.MinY && MinZ == Other.MinZ && MaxX == Other.MaxX && MaxY == Other.MaxY && MaxZ == Other.MaxZ;
+		}
+
+		bool operator!=(const FGridCellRect& Other) const { return !(*this == Other); }
+	};
 }
 
+class FGameplayMessageReplay;
 class UAsyncAction_ListenForGameplayWorldMessage;
 
 /**
@@ -64,30 +101,53 @@ private:
 };
 
 /** 
- * Entry information for a single registered spatial listener
+ * Entry information for a single registered spatial listener.
+ * Fields are ordered so the ones read by every dispatch share the first cache line with the callback's storage.
  */
 USTRUCT()
 struct FGameplayWorldMessageListenerData
 {
 	GENERATED_BODY()
 
-	// Callback for when a message has been received
-	TFunction<void(FGameplayTag, const UScriptStruct*, void*)> ReceivedCallback;
-
-	int32 HandleID;
-	EGameplayMessageMatch MatchType;
-
 	// Adding some logging and extra variables around some potential problems with this
 	TWeakObjectPtr<const UScriptStruct> ListenerStructType = nullptr;
 
+	// Key of the listener in the router's count of listeners per struct type, kept raw since ListenerStructType may go stale
+	const UScriptStruct* StructTypeKey = nullptr;
+
 	// 注册时的Channel
 	FGameplayTag Channel = FGameplayTag::EmptyTag;
 
-	int32 Priority;
+	int32 HandleID = 0;
+
+	// EGameplayMessagePriority value, registration clamps custom priorities to this range
+	uint8 Priority = static_cast<uint8>(EGameplayMessagePriority::DEFAULT);
+
+	EGameplayMessageMatch MatchType = EGameplayMessageMatch::ExactMatch;
+
+	// Set when the listener is unregistered during a broadcast, the entry is removed once the broadcast unwinds
+	bool bPendingRemoval = false;
+
+	// Grid level the listener is stored in, picked from its radius
+	uint8 GridLevel = 0;
+
+	// Callback for when a message has been received
+	FGameplayMessageCallback ReceivedCallback;
 
 	// Spatial listening parameters
 	FVector ListenPosition = FVector::ZeroVector;
 	float ListenRadius = 0.0f;
+
+	// Delivery LOD: broadcasts further than the inner radius only reach the listener once every FarDeliveryInterval
+	// messages. A negative inner radius delivers everything up to ListenRadius.
+	float InnerRadiusSquared = -1.0f;
+	uint16 FarDeliveryInterval = 1;
+
+	// Far tier messages left to skip before the next one is delivered
+	uint16 NumFarMessagesToSkip = 0;
+
+	// Cells of GridLevel the listener is stored in
+	UE::GameplayWorldMessageSubsystem::FGridCellRect CellRect;
 };
 
 /**
@@ -97,21 +157,27 @@ struct FGameplayWorldMessageListenerData
  *
  * Messages are broadcast at specific world coordinates and listeners can register to
  * receive messages within a specified radius from their listening position.
+ * Listeners can also set an inner radius, past which they only receive one in every few
+ * messages (see FGameplayWorldMessageListenerParams::FarDeliveryInterval).
  *
  * You can get to the message router from the world:
  *    UWorld::GetSubsystem<UGameplayWorldMessageSubsystem>(World)
  * or directly from anything that has a route to a world:
  *    UGameplayWorldMessageSubsystem::Get(WorldContextObject)
  *
+ * Listeners registered for a struct type also receive the messages broadcast with any of its child struct types.
+ *
  * Note that call order when there are multiple listeners for the same channel is
  * not guaranteed and can change over time!
  */
 UCLASS()
-class GAMEPLAYMESSAGERUNTIME_API UGameplayWorldMessageSubsystem : public UWorldSubsystem
+class GAMEPLAYMESSAGERUNTIME_API UGameplayWorldMessageSubsystem : public UTickableWorldSubsystem
 {
 	GENERATED_BODY()
 
 	friend UAsyncAction_ListenForGameplayWorldMessage;
+	friend FGameplayMessageReplay;
+	friend class UGameplayMessageRelayComponent;
 
 public:
 
@@ -126,9 +192,15 @@ public:
 	static bool HasInstance(const UObject* WorldContextObject);
 
 	//~USubsystem interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
 	virtual void Deinitialize() override;
 	//~End of USubsystem interface
 
+	//~UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	//~End of UTickableWorldSubsystem interface
+
 	/**
 	 * Broadcast a spatial message at the specified world position
 	 *
@@ -156,34 +228,102 @@ public:
 		return BroadcastMessageInternal(UE::GameplayWorldMessageSubsystem::TAG_DefaultMessageChannel, StructType, &Message, WorldPosition);
 	}
 
+	/**
+	 * Broadcast a spatial message to every listener whose listen sphere overlaps a sphere, instead of a single point.
+	 * Each listener receives the message once, even if it is stored in several of the cells the area covers,
+	 * and listeners are called in priority order.
+	 *
+	 * @param Message			The message to send (must be the same type of UScriptStruct expected by the listeners for this channel, otherwise an error will be logged)
+	 * @param Channel			The message channel to broadcast on
+	 * @param Area				The sphere to broadcast in
+	 */
+	template <typename FMessageStructType>
+	FGameplayMessageBroadcastResult BroadcastMessageInArea(FMessageStructType& Message, FGameplayTag Channel, const FSphere& Area)
+	{
+		const UScriptStruct* StructType = TBaseStructure<FMessageStructType>::Get();
+		return BroadcastMessageInAreaInternal(Channel, StructType, &Message, FBroadcastArea(Area));
+	}
+
+	/**
+	 * Broadcast a spatial message to every listener whose listen sphere overlaps a box, @see BroadcastMessageInArea
+	 *
+	 * @param Message			The message to send (must be the same type of UScriptStruct expected by the listeners for this channel, otherwise an error will be logged)
+	 * @param Channel			The message channel to broadcast on
+	 * @param Area				The axis aligned box to broadcast in
+	 */
+	template <typename FMessageStructType>
+	FGameplayMessageBroadcastResult BroadcastMessageInArea(FMessageStructType& Message, FGameplayTag Channel, const FBox& Area)
+	{
+		const UScriptStruct* StructType = TBaseStructure<FMessageStructType>::Get();
+		return BroadcastMessageInAreaInternal(Channel, StructType, &Message, FBroadcastArea(Area));
+	}
+
+	/**
+	 * Queue a spatial message to be broadcast at the specified world position during the next world tick.
+	 * The message is copied, so it does not need to outlive this call. Queued messages are dispatched together,
+	 * grouped by struct type and channel; the order between different groups is not preserved.
+	 *
+	 * @param Message			The message to send (must be the same type of UScriptStruct expected by the listeners for this channel, otherwise an error will be logged)
+	 * @param Channel			The message channel to broadcast on
+	 * @param WorldPosition		The world position where the message is broadcast
+	 * @param OnComplete		Optional callback receiving the broadcast result once the message has been dispatched
+	 */
+	template <typename FMessageStructType>
+	void QueueMessage(const FMessageStructType& Message, FGameplayTag Channel, const FVector& WorldPosition, FGameplayMessageQueuedCallback&& OnComplete = nullptr)
+	{
+		const UScriptStruct* StructType = TBaseStructure<FMessageStructType>::Get();
+		QueueMessageInternal(Channel, StructType, &Message, WorldPosition, MoveTemp(OnComplete));
+	}
+
+	/**
+	 * Post a spatial message from any thread, to be broadcast on the game thread during the next world tick.
+	 * The message is copied on the calling thread and pushed onto a lock-free inbox; no lock is taken and no task is
+	 * created. Messages posted by one thread are broadcast in the order they were posted, there is no ordering
+	 * guarantee between threads nor relative to messages queued on the game thread with QueueMessage.
+	 * The router must outlive the call, which is the caller's responsibility when posting from worker threads.
+	 *
+	 * @param Message			The message to send, copied (must be safe to copy off the game thread)
+	 * @param Channel			The message channel to broadcast on
+	 * @param WorldPosition		The world position where the message is broadcast
+	 */
+	template <typename FMessageStructType>
+	void BroadcastMessageFromAnyThread(const FMessageStructType& Message, FGameplayTag Channel, const FVector& WorldPosition)
+	{
+		const UScriptStruct* StructType = TBaseStructure<FMessageStructType>::Get();
+		Inbox.Enqueue(StructType, &Message, Channel, nullptr, WorldPosition);
+	}
+
+	/**
+	 * Dispatch every queued spatial message right away instead of waiting for the next tick.
+	 * Messages queued by listeners while flushing are kept for the following flush.
+	 */
+	void FlushQueuedMessages();
+
 	/**
 	 * Register to receive spatial messages within a specified radius
 	 *
-	 * @param Callback			Function to call with the message when someone broadcasts it (must be the same type of UScriptStruct provided by broadcasters for this channel, otherwise an error will be logged)
+	 * @param Callback			Function to call with the message when someone broadcasts it (must be the same type of UScriptStruct provided by broadcasters for this channel, otherwise an error will be logged).
+	 *							May take a trailing float, the squared distance from the listen position to the broadcast.
 	 * @param ListenPosition	The world position to listen from
 	 * @param ListenRadius		The radius within which to receive messages
 	 * @param Priority			Priority of the listener
 	 *
 	 * @return a handle that can be used to unregister this listener (either by calling Unregister() on the handle or calling UnregisterListener on the router)
 	 */
-	template <typename FMessageStructType>
-	FGameplayWorldMessageListenerHandle RegisterListener(TFunction<void(FGameplayTag, const FMessageStructType&)>&& Callback, const FVector& ListenPosition, float ListenRadius, EGameplayMessagePriority Priority = EGameplayMessagePriority::DEFAULT)
+	template <typename FMessageStructType, typename FuncType, typename = typename TEnableIf<TIsInvocable<typename TDecay<FuncType>::Type&, FGameplayTag, const FMessageStructType&>::Value || TIsInvocable<typename TDecay<FuncType>::Type&, FGameplayTag, const FMessageStructType&, float>::Value>::Type>
+	FGameplayWorldMessageListenerHandle RegisterListener(FuncType&& Callback, const FVector& ListenPosition, float ListenRadius, EGameplayMessagePriority Priority = EGameplayMessagePriority::DEFAULT)
 	{
-		auto ThunkCallback = [InnerCallback = MoveTemp(Callback)](FGameplayTag ActualTag, const UScriptStruct* SenderStructType, const void* SenderPayload)
-		{
-			InnerCallback(ActualTag, *reinterpret_cast<const FMessageStructType*>(SenderPayload));
-		};
-
 		const UScriptStruct* StructType = TBaseStructure<FMessageStructType>::Get();
 		
-		return RegisterListenerInternal(UE::GameplayWorldMessageSubsystem::TAG_DefaultMessageChannel, ThunkCallback, StructType, EGameplayMessageMatch::PartialMatch, static_cast<int32>(Priority), ListenPosition, ListenRadius);
+		return RegisterListenerInternal(UE::GameplayWorldMessageSubsystem::TAG_DefaultMessageChannel, MakeSpatialMessageCallback<FMessageStructType>(Forward<FuncType>(Callback)), StructType, EGameplayMessageMatch::PartialMatch, static_cast<int32>(Priority), ListenPosition, ListenRadius);
 	}
 
 	/**
 	 * Register to receive spatial messages on a specified channel within a specified radius
 	 *
 	 * @param Channel			The message channel to listen to
-	 * @param Callback			Function to call with the message when someone broadcasts it (must be the same type of UScriptStruct provided by broadcasters for this channel, otherwise an error will be logged)
+	 * @param Callback			Function to call with the message when someone broadcasts it (must be the same type of UScriptStruct provided by broadcasters for this channel, otherwise an error will be logged).
+	 *							May take a trailing float, the squared distance from the listen position to the broadcast.
 	 * @param ListenPosition	The world position to listen from
 	 * @param ListenRadius		The radius within which to receive messages
 	 * @param MatchType			How to match the channel tags
@@ -191,17 +331,12 @@ public:
 	 *
 	 * @return a handle that can be used to unregister this listener (either by calling Unregister() on the handle or calling UnregisterListener on the router)
 	 */
-	template <typename FMessageStructType>
-	FGameplayWorldMessageListenerHandle RegisterListener(FGameplayTag Channel, TFunction<void(FGameplayTag, const FMessageStructType&)>&& Callback, const FVector& ListenPosition, float ListenRadius, EGameplayMessageMatch MatchType = EGameplayMessageMatch::ExactMatch, EGameplayMessagePriority Priority = EGameplayMessagePriority::DEFAULT)
+	template <typename FMessageStructType, typename FuncType, typename = typename TEnableIf<TIsInvocable<typename TDecay<FuncType>::Type&, FGameplayTag, const FMessageStructType&>::Value || TIsInvocable<typename TDecay<FuncType>::Type&, FGameplayTag, const FMessageStructType&, float>::Value>::Type>
+	FGameplayWorldMessageListenerHandle RegisterListener(FGameplayTag Channel, FuncType&& Callback, const FVector& ListenPosition, float ListenRadius, EGameplayMessageMatch MatchType = EGameplayMessageMatch::ExactMatch, EGameplayMessagePriority Priority = EGameplayMessagePriority::DEFAULT)
 	{
-		auto ThunkCallback = [InnerCallback = MoveTemp(Callback)](FGameplayTag ActualTag, const UScriptStruct* SenderStructType, void* SenderPayload)
-		{
-			InnerCallback(ActualTag, *reinterpret_cast<const FMessageStructType*>(SenderPayload));
-		};
-
 		const UScriptStruct* StructType = TBaseStructure<FMessageStructType>::Get();
 		
-		return RegisterListenerInternal(Channel, ThunkCallback, StructType, MatchType, static_cast<int32>(Priority), ListenPosition, ListenRadius);
+		return RegisterListenerInternal(Channel, MakeSpatialMessageCallback<FMessageStructType>(Forward<FuncType>(Callback)), StructType, MatchType, static_cast<int32>(Priority), ListenPosition, ListenRadius);
 	}
 
 	/**
@@ -219,22 +354,16 @@ public:
 	template <typename FMessageStructType, typename TOwner = UObject>
 	FGameplayWorldMessageListenerHandle RegisterListener(FGameplayTag Channel, TOwner* Object, void(TOwner::* Function)(FGameplayTag, const FMessageStructType&), const FVector& ListenPosition, float ListenRadius)
 	{
-		TWeakObjectPtr<TOwner> WeakObject(Object);
-		return RegisterListener<FMessageStructType>(Channel,
-													[WeakObject, Function](FGameplayTag Channel, FMessageStructType& Payload)
-													{
-														if (TOwner* StrongObject = WeakObject.Get())
-														{
-															(StrongObject->*Function)(Channel, Payload);
-														}
-													}, ListenPosition, ListenRadius);
+		const UScriptStruct* StructType = TBaseStructure<FMessageStructType>::Get();
+
+		return RegisterListenerInternal(Channel, UE::GameplayMessage::Private::MakeWeakMemberMessageCallback<FMessageStructType>(Object, Function), StructType, EGameplayMessageMatch::ExactMatch, static_cast<int32>(EGameplayMessagePriority::DEFAULT), ListenPosition, ListenRadius);
 	}
 
 	/**
 	 * Register to receive spatial messages on a specified channel with extra parameters to support advanced behavior
 	 *
 	 * @param Channel			The message channel to listen to
-	 * @param Params			Structure containing details for advanced spatial behavior
+	 * @param Params			Structure containing details for advanced spatial behavior, the callback is moved out of it
 	 *
 	 * @return a handle that can be used to unregister this listener (either by calling Unregister() on the handle or calling UnregisterListener on the router)
 	 */
@@ -244,20 +373,61 @@ public:
 		FGameplayWorldMessageListenerHandle Handle;
 
 		// Register to receive any future messages broadcast on this channel
-		if (Params.OnMessageReceivedCallback)
+		if (Params.HasMessageReceivedCallback())
 		{
-			auto ThunkCallback = [InnerCallback = Params.OnMessageReceivedCallback](FGameplayTag ActualTag, const UScriptStruct* SenderStructType, void* SenderPayload)
-			{
-				InnerCallback(ActualTag, *reinterpret_cast<const FMessageStructType*>(SenderPayload));
-			};
-
 			const UScriptStruct* StructType = TBaseStructure<FMessageStructType>::Get();
-			Handle = RegisterListenerInternal(Channel, ThunkCallback, StructType, Params.MatchType, static_cast<int32>(Params.Priority), Params.ListenPosition, Params.ListenRadius);
+			Handle = RegisterListenerInternal(Channel, Params.TakeMessageReceivedCallback(), StructType, Params.MatchType, static_cast<int32>(Params.Priority), Params.ListenPosition, Params.ListenRadius, Params.InnerRadius, Params.FarDeliveryInterval);
+
+			if (!Params.FollowComponent.IsExplicitlyNull())
+			{
+				FollowComponentFromParams(Handle, Params.FollowComponent, Params.FollowMoveThreshold);
+			}
 		}
 
 		return Handle;
 	}
 
+	/**
+	 * Register many spatial listeners on one channel at once, e.g. for the actors of a streamed in level.
+	 * The listeners are appended to their cells and every cell left out of order is sorted once at the end,
+	 * instead of inserting each listener at its priority.
+	 *
+	 * @param Channel			The message channel to listen to
+	 * @param Params			Details of each listener, the callbacks are moved out of it
+	 *
+	 * @return a handle per entry of Params, in the same order. Entries without a callback get an invalid handle.
+	 */
+	template <typename FMessageStructType>
+	TArray<FGameplayWorldMessageListenerHandle> RegisterListeners(FGameplayTag Channel, TArrayView<FGameplayWorldMessageListenerParams<FMessageStructType>> Params)
+	{
+		TArray<FGameplayWorldMessageListenerHandle> Handles;
+		Handles.Reserve(Params.Num());
+
+		const UScriptStruct* StructType = TBaseStructure<FMessageStructType>::Get();
+		ReserveListeners(Params.Num());
+		BeginListenerBatch();
+		for (FGameplayWorldMessageListenerParams<FMessageStructType>& ListenerParams : Params)
+		{
+			FGameplayWorldMessageListenerHandle& Handle = Handles.AddDefaulted_GetRef();
+			if (ListenerParams.HasMessageReceivedCallback())
+			{
+				Handle = RegisterListenerInternal(Channel, ListenerParams.TakeMessageReceivedCallback(), StructType, ListenerParams.MatchType, static_cast<int32>(ListenerParams.Priority), ListenerParams.ListenPosition, ListenerParams.ListenRadius, ListenerParams.InnerRadius, ListenerParams.FarDeliveryInterval);
+			}
+		}
+		EndListenerBatch();
+
+		// Following moves the listener right away, which needs its cells sorted
+		for (int32 Index = 0; Index < Params.Num(); ++Index)
+		{
+			if (Handles[Index].IsValid() && !Params[Index].FollowComponent.IsExplicitlyNull())
+			{
+				FollowComponentFromParams(Handles[Index], Params[Index].FollowComponent, Params[Index].FollowMoveThreshold);
+			}
+		}
+
+		return Handles;
+	}
+
 	/**
 	 * Remove a message listener previously registered by RegisterListener
 	 *
@@ -265,6 +435,17 @@ public:
 	 */
 	void UnregisterListener(FGameplayWorldMessageListenerHandle Handle);
 
+	/**
+	 * Remove many listeners at once, e.g. on level unload. Each cell they were stored in is compacted in a single
+	 * pass. Invalid and unknown handles are skipped.
+	 *
+	 * @param Handles	Handles returned by RegisterListener or RegisterListeners
+	 */
+	void UnregisterListeners(TConstArrayView<FGameplayWorldMessageListenerHandle> Handles);
+
+	/** Allocate the storage of NumListeners more listeners ahead of a mass registration */
+	void ReserveListeners(int32 NumListeners);
+
 	/**
 	 * Update the listening location for a previously registered listener
 	 * This efficiently moves the listener to the new grid cells based on the new position and radius
@@ -277,6 +458,38 @@ public:
 	 */
 	bool UpdateRegisterListenerLocation(FGameplayWorldMessageListenerHandle Handle, const FVector& NewListenPosition, float NewListenRadius = -1.0f);
 
+	/**
+	 * Update the listening location of many listeners at once, keeping their radius.
+	 * Listeners that stay within the same cells only have their position updated, the cell changes of
+	 * the others are grouped and applied cell by cell.
+	 *
+	 * @param Handles			Handles returned by RegisterListener
+	 * @param NewListenPositions	New world position of each handle, same length as Handles
+	 *
+	 * @return the number of listeners that were updated, invalid handles are skipped
+	 */
+	int32 UpdateRegisterListenerLocations(TConstArrayView<FGameplayWorldMessageListenerHandle> Handles, TConstArrayView<FVector> NewListenPositions);
+
+	/**
+	 * Make a listener follow a component instead of being moved with UpdateRegisterListenerLocation.
+	 * Followed listeners are checked once per tick and only relocated, in a single batch, once their component has
+	 * moved more than MoveThreshold since the last relocation. Broadcasts in between use the last relocated position.
+	 * Listeners whose component is destroyed stay where it was last seen.
+	 *
+	 * @param Handle			The handle returned by RegisterListener
+	 * @param Component			The component to follow, nullptr to stop following
+	 * @param MoveThreshold		Distance the component has to move before the listener is relocated
+	 *
+	 * @return true if the listener is now following Component (or stopped following for a null Component)
+	 */
+	bool SetListenerFollowComponent(FGameplayWorldMessageListenerHandle Handle, const USceneComponent* Component, float MoveThreshold = 50.0f);
+
+	/** Make a listener follow the root component of Actor, @see SetListenerFollowComponent */
+	bool SetListenerFollowActor(FGameplayWorldMessageListenerHandle Handle, const AActor* Actor, float MoveThreshold = 50.0f);
+
+	/** Relocate the followed listeners whose component moved past their threshold, done at the start of every tick */
+	void UpdateFollowedListeners();
+
 	/**
 	 * Mark current message context as cancelled
 	 * @param WorldContext Context to get GameplayWorldMessageSubsystem
@@ -294,6 +507,40 @@ public:
 	UFUNCTION(BlueprintCallable, Category=Messaging)
 	void CancelMessage(bool bCancel = true, bool bInterrupt = true);
 
+	/**
+	 * @return the squared distance between the listener currently being called and the message, measured to the closest
+	 * point of the area for area broadcasts. Only meaningful from inside a listener callback.
+	 */
+	UFUNCTION(BlueprintPure, Category=Messaging)
+	float GetCurrentListenerDistanceSquared() const { return CurrentListenerDistanceSquared; }
+
+	/**
+	 * Rebuild the spatial index with new settings, every registered listener is kept.
+	 * Routers pick up their world's settings (UGameplayMessageSettings::GetWorldGridSettings) when initialized.
+	 * Cannot be called from a listener callback.
+	 */
+	void SetGridSettings(const FGameplayWorldMessageGridSettings& InGridSettings);
+
+	const FGameplayWorldMessageGridSettings& GetGridSettings() const { return GridSettings; }
+
+	/** @return the broadcast budgets of the rate limited channels, and how many broadcasts each one dropped */
+	const FGameplayMessageRateLimiter& GetRateLimiter() const { return RateLimiter; }
+
+	/**
+	 * @return the radius around Center of a sphere containing the listen spheres of every registered listener, 0 if
+	 * there are none. Walks every listener.
+	 */
+	float GetListenBoundRadius(const FVector& Center) const;
+
+	/**
+	 * Release the memory left behind by listeners that are gone: sparse cell and handle maps are compacted and the
+	 * slack of the cells is freed. Done after every garbage collection, does nothing while a broadcast is running.
+	 */
+	void CompactListenerStorage();
+
+	/** Log the memory used by this router per struct type, per channel and per grid level. @see GameplayMessages.DumpMemory */
+	void DumpMemory(FOutputDevice& Ar) const;
+
 protected:
 	/**
 	 * Broadcast a spatial message at the specified world position
@@ -316,41 +563,312 @@ protected:
 	FGameplayMessageBroadcastResult K2_BroadcastSimpleMessage(UPARAM(ref) int32& Message, FVector WorldPosition);
 	DECLARE_FUNCTION(execK2_BroadcastSimpleMessage);
 
+	/**
+	 * Broadcast a spatial message to every listener whose listen sphere overlaps a sphere
+	 *
+	 * @param Channel			The message channel to broadcast on
+	 * @param Message			The message to send (must be the same type of UScriptStruct expected by the listeners for this channel, otherwise an error will be logged)
+	 * @param Center			Center of the sphere
+	 * @param Radius			Radius of the sphere
+	 */
+	UFUNCTION(BlueprintCallable, CustomThunk, Category=Messaging, meta=(CustomStructureParam="Message", AllowAbstract="false", DisplayName="Broadcast World Message In Sphere"))
+	FGameplayMessageBroadcastResult K2_BroadcastMessageInSphere(FGameplayTag Channel, UPARAM(ref) int32& Message, FVector Center, float Radius);
+	DECLARE_FUNCTION(execK2_BroadcastMessageInSphere);
+
+	/**
+	 * Broadcast a spatial message to every listener whose listen sphere overlaps an axis aligned box
+	 *
+	 * @param Channel			The message channel to broadcast on
+	 * @param Message			The message to send (must be the same type of UScriptStruct expected by the listeners for this channel, otherwise an error will be logged)
+	 * @param Center			Center of the box
+	 * @param Extent			Half size of the box
+	 */
+	UFUNCTION(BlueprintCallable, CustomThunk, Category=Messaging, meta=(CustomStructureParam="Message", AllowAbstract="false", DisplayName="Broadcast World Message In Box"))
+	FGameplayMessageBroadcastResult K2_BroadcastMessageInBox(FGameplayTag Channel, UPARAM(ref) int32& Message, FVector Center, FVector Extent);
+	DECLARE_FUNCTION(execK2_BroadcastMessageInBox);
+
 private:
 	// Internal helper for broadcasting a spatial message
 	FGameplayMessageBroadcastResult BroadcastMessageInternal(FGameplayTag Channel, const UScriptStruct* StructType, void* MessageBytes, const FVector& WorldPosition);
 
+	// Sphere or box an area message is broadcast in
+	struct FBroadcastArea
+	{
+		explicit FBroadcastArea(const FSphere& Sphere)
+			: Bounds(Sphere.Center - FVector(Sphere.W), Sphere.Center + FVector(Sphere.W)), SphereCenter(Sphere.Center), SphereRadius(Sphere.W)
+		{
+		}
+
+		explicit FBroadcastArea(const FBox& Box)
+			: Bounds(Box)
+		{
+		}
+
+		// Squared distance from ListenPosition to the closest point of the area, 0 inside it.
+		// A listen sphere overlaps the area if this is within its squared radius.
+		double GetDistanceSquared(const FVector& ListenPosition) const;
+
+		FBox Bounds;
+
+		// Sphere areas only, boxes leave the radius negative
+		FVector SphereCenter = FVector::ZeroVector;
+		double SphereRadius = -1.0;
+	};
+
+	// Internal helper for broadcasting a spatial message to an area
+	FGameplayMessageBroadcastResult BroadcastMessageInAreaInternal(FGameplayTag Channel, const UScriptStruct* StructType, void* MessageBytes, const FBroadcastArea& Area);
+
+	// Count a broadcast against its channel's rate limit, returns true if it has to be dropped
+	bool IsThrottled(FGameplayTag Channel, const FVector& WorldPosition);
+
+	// Type, channel and delivery LOD checks shared by point and area broadcasts, returns true if the listener's callback was called
+	bool DispatchToListener(int32 ListenerIndex, FGameplayTag Channel, const UScriptStruct* StructType, TConstArrayView<const UScriptStruct*> ListenerStructTypes, void* MessageBytes, float DistanceSquared);
+
+	// Squared distance between the listener being called and the broadcast, @see GetCurrentListenerDistanceSquared
+	float CurrentListenerDistanceSquared = 0.0f;
+
+	// Internal helper for queueing a spatial message for the next flush
+	void QueueMessageInternal(FGameplayTag Channel, const UScriptStruct* StructType, const void* MessageBytes, const FVector& WorldPosition, FGameplayMessageQueuedCallback&& OnComplete);
+
 	// Internal helper for registering a spatial message listener
 	FGameplayWorldMessageListenerHandle RegisterListenerInternal(
 		FGameplayTag Channel, 
-		TFunction<void(FGameplayTag, const UScriptStruct*, void*)>&& Callback,
+		FGameplayMessageCallback&& Callback,
 		const UScriptStruct* StructType,
 		EGameplayMessageMatch MatchType,
 		int32 Priority = static_cast<int32>(EGameplayMessagePriority::DEFAULT),
 		const FVector& ListenPosition = FVector::ZeroVector,
-		float ListenRadius = 0.0f);
+		float ListenRadius = 0.0f,
+		float InnerRadius = -1.0f,
+		int32 FarDeliveryInterval = 1);
+
+	// Typed callback of a spatial listener, callables taking a trailing float also receive the squared distance to the broadcast
+	template <typename FMessageStructType, typename FuncType>
+	FGameplayMessageCallback MakeSpatialMessageCallback(FuncType&& Func)
+	{
+		if constexpr (TIsInvocable<typename TDecay<FuncType>::Type&, FGameplayTag, const FMessageStructType&, float>::Value)
+		{
+			return FGameplayMessageCallback([this, InnerCallback = Forward<FuncType>(Func)](FGameplayTag ActualTag, const UScriptStruct* SenderStructType, void* SenderPayload)
+			{
+				InnerCallback(ActualTag, *static_cast<const FMessageStructType*>(SenderPayload), CurrentListenerDistanceSquared);
+			});
+		}
+		else
+		{
+			return UE::GameplayMessage::Private::MakeTypedMessageCallback<FMessageStructType>(Forward<FuncType>(Func));
+		}
+	}
 	
 	void UnregisterListenerInternal(const UScriptStruct* StructType, int32 HandleID);
 
-	// Message execute context, reset for each message broadcast
+	// Out of line so the listener params template does not need the component type
+	void FollowComponentFromParams(FGameplayWorldMessageListenerHandle Handle, const TWeakObjectPtr<const USceneComponent>& Component, float MoveThreshold);
+
+	// Grid mutations, only valid while no broadcast is iterating a cell
+	void AddListenerToGrids(FGameplayWorldMessageListenerData&& ListenerData);
+	void RemoveListenerFromGrids(int32 HandleID);
+	bool RelocateListenerInGrids(int32 HandleID, const FVector& NewListenPosition, float NewListenRadius);
+
+	// Apply the listener changes recorded while broadcasting, called when the outermost broadcast returns
+	void ApplyPendingListenerChanges();
+
+	// Registrations made between these are appended to their cells, the cells are sorted when the outermost batch ends
+	void BeginListenerBatch();
+	void EndListenerBatch();
+
+	// Number of batches open
+	int32 ListenerBatchDepth = 0;
+
+	// (level, cell) of the cells a batch appended to out of priority order, may contain duplicates
+	TArray<TPair<int32, int64>> UnsortedCells;
+
+	// Message execute context of the running broadcast. Each broadcast starts from a clean one and restores the enclosing
+	// broadcast's context when it returns, so nested broadcasts from listeners do not cancel or interrupt their caller.
 	FGameplayMessageBroadcastResult BroadcastResultCache;
 
+	// Number of broadcasts currently on the stack. Cells are iterated in place, so while this is non-zero
+	// registrations, moves and removals are recorded in PendingListenerChanges instead of touching the grid.
+	int32 BroadcastDepth = 0;
+
+	enum class EPendingListenerChange : uint8
+	{
+		Register,
+		Unregister,
+		Relocate,
+	};
+
+	struct FPendingListenerChange
+	{
+		EPendingListenerChange Type = EPendingListenerChange::Register;
+		int32 HandleID = 0;
+
+		// Register: the entry to insert once the broadcast unwinds
+		TOptional<FGameplayWorldMessageListenerData> Listener;
+
+		// Relocate: the requested position and radius (negative radius keeps the current one)
+		FVector ListenPosition = FVector::ZeroVector;
+		float ListenRadius = -1.0f;
+	};
+
+	// Changes made from inside listener callbacks, applied in order. Reset (not freed) after each flush.
+	TArray<FPendingListenerChange> PendingListenerChanges;
+
+	// Double buffered so messages queued by listeners during a flush wait for the next one
+	FGameplayMessageQueue MessageQueues[2];
+	int32 ActiveQueueIndex = 0;
+	bool bFlushingQueue = false;
+
+	// Messages posted with BroadcastMessageFromAnyThread, drained at the start of each tick
+	FGameplayMessageInbox Inbox;
+
+	// Budgets of the channels listed in UGameplayMessageSettings::RateLimits
+	FGameplayMessageRateLimiter RateLimiter;
+
+	struct FFollowedListener
+	{
+		TWeakObjectPtr<const USceneComponent> Component;
+
+		// Component location the listener was last relocated to
+		FVector LastLocation = FVector::ZeroVector;
+
+		float MoveThresholdSquared = 0.0f;
+	};
+
+	// Listeners following a component, keyed by HandleID
+	TMap<int32, FFollowedListener> FollowedListeners;
+
+	// Number of listeners in the grids per struct type
+	TMap<const UScriptStruct*, int32> NumListenersByStructType;
+
+	// Struct types with listeners a broadcast of the key type is delivered to: the type itself and its parents.
+	// Built on the first broadcast of a type, dropped whenever a struct type gains its first or loses its last listener.
+	TMap<FObjectKey, TArray<const UScriptStruct*, TInlineAllocator<4>>> CompatibleStructTypes;
+
+	// Listener struct types compatible with a broadcast of StructType, most derived first
+	TConstArrayView<const UScriptStruct*> GetCompatibleStructTypes(const UScriptStruct* StructType);
+
+	// Listeners already gathered by the area broadcast being collected, indexed like ListenerPool. Always clear in between.
+	TBitArray<> AreaGatheredListeners;
+
+	// Reused by UpdateFollowedListeners to batch the moves of a tick
+	TArray<FGameplayWorldMessageListenerHandle> FollowedHandlesScratch;
+	TArray<FVector> FollowedLocationsScratch;
+
 private:
-	// Grid-based listener storage for spatial queries
+	// Compact reference from a grid cell to a listener stored in ListenerPool
+	struct FGridListenerEntry
+	{
+		int32 ListenerIndex = INDEX_NONE;
+
+		// Copy of the listener's priority, keeps cell ordering local to the cell
+		int32 Priority = 0;
+	};
+
+	// Grid-based listener storage for spatial queries.
+	// The arrays after Listeners run parallel to it, so a broadcast culls a whole cell by distance and struct type
+	// without reading the listener records, only the survivors are looked up in ListenerPool.
 	struct FGridListenerList
 	{
-		TArray<FGameplayWorldMessageListenerData> Listeners;
-		int32 HandleID = 0;
+		TArray<FGridListenerEntry> Listeners;
+
+		// Listen positions relative to Origin, float precision is plenty within a few cells
+		TArray<float> PositionX;
+		TArray<float> PositionY;
+		TArray<float> PositionZ;
+		TArray<float> RadiusSquared;
+
+		// Struct type of each listener, compared by address
+		TArray<const UScriptStruct*> StructTypes;
+
+		// Reference point of the relative positions, the position of the first listener inserted in the cell
+		FVector Origin = FVector::ZeroVector;
+
+		int32 Num() const { return Listeners.Num(); }
+
+		// Index of the listener's entry, INDEX_NONE if the listener is not in the cell
+		int32 FindEntry(int32 ListenerIndex, int32 Priority) const;
+
+		void InsertEntry(int32 EntryIndex, int32 ListenerIndex, const FGameplayWorldMessageListenerData& Listener);
+		void SetEntryLocation(int32 EntryIndex, const FVector& Position, float Radius);
+		void RemoveEntry(int32 EntryIndex);
+
+		// Remove every entry whose listener index passes Predicate in a single pass, keeping the order
+		template <typename PredicateType>
+		void RemoveEntries(PredicateType Predicate);
+
+		// Restore priority order after entries were appended, stable so equal priorities stay in insertion order
+		void SortEntries();
+
+		// Free the slack left behind by removed entries
+		void Shrink();
+
+		SIZE_T GetAllocatedSize() const;
+
+		// Bytes taken by one entry across the parallel arrays
+		static constexpr SIZE_T EntrySize = sizeof(FGridListenerEntry) + 4 * sizeof(float) + sizeof(const UScriptStruct*);
+
+		// Append the indices of the entries of one of ListenerStructTypes whose listen sphere contains Position, in priority order,
+		// along with their squared distance to Position
+		void CullEntries(const FVector& Position, TConstArrayView<const UScriptStruct*> ListenerStructTypes, TArray<int32, TInlineAllocator<256>>& OutEntries, TArray<float, TInlineAllocator<256>>& OutDistancesSquared) const;
 	};
 
-	// Map from GridID to listeners in that grid
-	TMap<int64, FGridListenerList> GridListenerMap;
-	
-	// Direct mapping from HandleID to spatial info for efficient cleanup
-	struct FListenerSpatialInfo
+	// Insert into a cell keeping it sorted by priority (stable for equal priorities)
+	static void InsertGridEntry(FGridListenerList& GridList, int32 ListenerIndex, const FGameplayWorldMessageListenerData& Listener);
+
+	// Copy the listener's position and radius into every cell it is stored in
+	void RefreshGridEntries(int32 ListenerIndex);
+
+	// One resolution of the spatial index
+	struct FGridLevel
 	{
-		FVector ListenPosition = FVector::ZeroVector;
-		float ListenRadius = 0.0f;
+		float CellSize = UE::GameplayWorldMessageSubsystem::GRID_SIZE;
+
+		// Cell height when partitioning along Z, 0 for a planar level
+		float CellHeight = 0.0f;
+
+		// Largest listen radius stored in this level, larger listeners go to a coarser level
+		float MaxListenRadius = MAX_flt;
+
+		// Map from GridID to listeners in that grid
+		TMap<int64, FGridListenerList> Cells;
 	};
-	TMap<int32, FListenerSpatialInfo> HandleToSpatialMap;
+
+	// Remove from a cell, dropping the cell once it is empty. Returns false if the listener was not in the cell.
+	static bool RemoveGridEntry(FGridLevel& Level, int64 GridID, int32 ListenerIndex, int32 Priority);
+
+	// Level a listener of the given radius is stored in
+	int32 SelectGridLevel(float ListenRadius) const;
+
+	// Cell of Level containing Position
+	static int64 GetCellID(const FGridLevel& Level, const FVector& Position);
+
+	// Inverse of PackCellID
+	static void UnpackCellID(const FGridLevel& Level, int64 GridID, int32& OutX, int32& OutY, int32& OutZ);
+
+	// Cells of Level overlapping Bounds
+	static UE::GameplayWorldMessageSubsystem::FGridCellRect GetAreaCellRect(const FGridLevel& Level, const FBox& Bounds);
+
+	// Cells of Level a listener at Position with Radius is stored in, never empty
+	static UE::GameplayWorldMessageSubsystem::FGridCellRect GetListenerCellRect(const FGridLevel& Level, const FVector& Position, float Radius);
+
+	// Grid id of the cell at integer coordinates X/Y/Z of Level
+	static int64 PackCellID(const FGridLevel& Level, int32 X, int32 Y, int32 Z);
+
+	// Move a listener to NewRect of NewLevel, calling OnCellChange(Level, GridID, bInsert) for each cell it leaves or enters
+	template <typename FuncType>
+	void DiffListenerCells(FGameplayWorldMessageListenerData& Listener, int32 NewLevel, const UE::GameplayWorldMessageSubsystem::FGridCellRect& NewRect, FuncType&& OnCellChange);
+
+	// Build the levels from GridSettings and re-insert every listener
+	void RebuildGridLevels();
+
+	FGameplayWorldMessageGridSettings GridSettings;
+
+	// Finest level first. A uniform grid has a single level.
+	TArray<FGridLevel, TInlineAllocator<1>> GridLevels;
+
+	// Every registered listener is stored exactly once, however many cells it covers
+	TSparseArray<FGameplayWorldMessageListenerData> ListenerPool;
+
+	// Direct mapping from HandleID to ListenerPool index
+	TMap<int32, int32> HandleToListenerIndex;
 };